@@ -16,25 +16,32 @@ else {
 }
 SOURCES += "sources/core/REArchive.cpp"
 SOURCES += "sources/core/REAudioEngine.cpp"
+SOURCES += "sources/core/REAudioEngineStats.cpp"
 SOURCES += "sources/core/REAudioExportEngine.cpp"
+SOURCES += "sources/core/REAudioMeter.cpp"
 SOURCES += "sources/core/REAudioSettings.cpp"
 SOURCES += "sources/core/REBar.cpp"
 SOURCES += "sources/core/REBarMetrics.cpp"
 SOURCES += "sources/core/REBeat.cpp"
 SOURCES += "sources/core/REBend.cpp"
 SOURCES += "sources/core/REChord.cpp"
+SOURCES += "sources/core/REChordAnalyzer.cpp"
 SOURCES += "sources/core/REChordDiagram.cpp"
 SOURCES += "sources/core/REChordFormula.cpp"
 SOURCES += "sources/core/REChordFormulaCollection.cpp"
 SOURCES += "sources/core/REChordName.cpp"
+SOURCES += "sources/core/REChunkedArchive.cpp"
 SOURCES += "sources/core/REClip.cpp"
+SOURCES += "sources/core/RECompression.cpp"
 SOURCES += "sources/core/RECursor.cpp"
+SOURCES += "sources/core/REDisplayList.cpp"
 SOURCES += "sources/core/REException.cpp"
 SOURCES += "sources/core/REFrame.cpp"
 SOURCES += "sources/core/REFunctions.cpp"
 SOURCES += "sources/core/REGrip.cpp"
 SOURCES += "sources/core/REGripCollection.cpp"
 SOURCES += "sources/core/REInputStream.cpp"
+SOURCES += "sources/core/REJsonStreamReader.cpp"
 SOURCES += "sources/core/RELayout.cpp"
 SOURCES += "sources/core/RELocator.cpp"
 SOURCES += "sources/core/RELogger.cpp"
@@ -49,16 +56,21 @@ SOURCES += "sources/core/REMusicalFont.cpp"
 SOURCES += "sources/core/REMusicDevice.cpp"
 SOURCES += "sources/core/REMusicRack.cpp"
 SOURCES += "sources/core/RENote.cpp"
+SOURCES += "sources/core/RENoteSelection.cpp"
+SOURCES += "sources/core/RENoteStateTable.cpp"
 SOURCES += "sources/core/REObject.cpp"
 SOURCES += "sources/core/REOutputStream.cpp"
 SOURCES += "sources/core/REPage.cpp"
 SOURCES += "sources/core/REPainter.cpp"
+SOURCES += "sources/core/REPatternIndex.cpp"
 SOURCES += "sources/core/REPhrase.cpp"
 SOURCES += "sources/core/REPitch.cpp"
 SOURCES += "sources/core/REPitchClass.cpp"
 SOURCES += "sources/core/REPlaylistBar.cpp"
 SOURCES += "sources/core/REPlaylistCompiler.cpp"
+SOURCES += "sources/core/REPlaylistIndex.cpp"
 SOURCES += "sources/core/REPython.cpp"
+SOURCES += "sources/core/RERecordingPainter.cpp"
 SOURCES += "sources/core/RESamplePlayer.cpp"
 SOURCES += "sources/core/REScore.cpp"
 SOURCES += "sources/core/REScoreController.cpp"
@@ -99,7 +111,9 @@ SOURCES += "sources/core/REWavFileWriter.cpp"
 SOURCES += "sources/core/REWriteChunkToFile.cpp"
 HEADERS += "sources/core/REArchive.h"
 HEADERS += "sources/core/REAudioEngine.h"
+HEADERS += "sources/core/REAudioEngineStats.h"
 HEADERS += "sources/core/REAudioExportEngine.h"
+HEADERS += "sources/core/REAudioMeter.h"
 HEADERS += "sources/core/REAudioSettings.h"
 HEADERS += "sources/core/REBar.h"
 HEADERS += "sources/core/REBarMetrics.h"
@@ -107,18 +121,23 @@ HEADERS += "sources/core/REBeat.h"
 HEADERS += "sources/core/REBend.h"
 HEADERS += "sources/core/REBezierPath.h"
 HEADERS += "sources/core/REChord.h"
+HEADERS += "sources/core/REChordAnalyzer.h"
 HEADERS += "sources/core/REChordDiagram.h"
 HEADERS += "sources/core/REChordFormula.h"
 HEADERS += "sources/core/REChordFormulaCollection.h"
 HEADERS += "sources/core/REChordName.h"
+HEADERS += "sources/core/REChunkedArchive.h"
 HEADERS += "sources/core/REClip.h"
+HEADERS += "sources/core/RECompression.h"
 HEADERS += "sources/core/RECursor.h"
+HEADERS += "sources/core/REDisplayList.h"
 HEADERS += "sources/core/REException.h"
 HEADERS += "sources/core/REFrame.h"
 HEADERS += "sources/core/REFunctions.h"
 HEADERS += "sources/core/REGrip.h"
 HEADERS += "sources/core/REGripCollection.h"
 HEADERS += "sources/core/REInputStream.h"
+HEADERS += "sources/core/REJsonStreamReader.h"
 HEADERS += "sources/core/RELayout.h"
 HEADERS += "sources/core/RELocator.h"
 HEADERS += "sources/core/RELogger.h"
@@ -133,16 +152,21 @@ HEADERS += "sources/core/REMusicalFont.h"
 HEADERS += "sources/core/REMusicDevice.h"
 HEADERS += "sources/core/REMusicRack.h"
 HEADERS += "sources/core/RENote.h"
+HEADERS += "sources/core/RENoteSelection.h"
+HEADERS += "sources/core/RENoteStateTable.h"
 HEADERS += "sources/core/REObject.h"
 HEADERS += "sources/core/REOutputStream.h"
 HEADERS += "sources/core/REPage.h"
 HEADERS += "sources/core/REPainter.h"
+HEADERS += "sources/core/REPatternIndex.h"
 HEADERS += "sources/core/REPhrase.h"
 HEADERS += "sources/core/REPitch.h"
 HEADERS += "sources/core/REPitchClass.h"
 HEADERS += "sources/core/REPlaylistBar.h"
 HEADERS += "sources/core/REPlaylistCompiler.h"
+HEADERS += "sources/core/REPlaylistIndex.h"
 HEADERS += "sources/core/REPython.h"
+HEADERS += "sources/core/RERecordingPainter.h"
 HEADERS += "sources/core/RESampleGenerator.h"
 HEADERS += "sources/core/RESamplePlayer.h"
 HEADERS += "sources/core/REScore.h"
@@ -188,8 +212,10 @@ SOURCES += "sources/plugins/guitarpro/REGuitarProWriter.cpp"
 HEADERS += "sources/plugins/guitarpro/REGuitarProParser.h"
 HEADERS += "sources/plugins/guitarpro/REGuitarProWriter.h"
 SOURCES += "sources/qt/main.cpp"
+SOURCES += "sources/qt/REAudioStatsDialog.cpp"
 SOURCES += "sources/qt/REBendDialog.cpp"
 SOURCES += "sources/qt/REBezierPath_qt.cpp"
+SOURCES += "sources/qt/REChordFormulaCollection_qt.cpp"
 SOURCES += "sources/qt/REClefDialog.cpp"
 SOURCES += "sources/qt/REClefPreview.cpp"
 SOURCES += "sources/qt/RECreateTrackDialog.cpp"
@@ -201,9 +227,11 @@ SOURCES += "sources/qt/REGraphicsFrameItem.cpp"
 SOURCES += "sources/qt/REGraphicsPageItem.cpp"
 SOURCES += "sources/qt/REGraphicsSliceItem.cpp"
 SOURCES += "sources/qt/REGraphicsSystemItem.cpp"
+SOURCES += "sources/qt/REGripCollection_qt.cpp"
 SOURCES += "sources/qt/REJackAudioEngine.cpp"
 SOURCES += "sources/qt/REKeySignatureDialog.cpp"
 SOURCES += "sources/qt/REKeySignaturePreview.cpp"
+SOURCES += "sources/qt/RELevelMeterWidget.cpp"
 SOURCES += "sources/qt/REMainWindow.cpp"
 SOURCES += "sources/qt/REMixerHeaderWidget.cpp"
 SOURCES += "sources/qt/REMixerRowWidget.cpp"
@@ -241,6 +269,7 @@ SOURCES += "sources/qt/RETransportWidget.cpp"
 SOURCES += "sources/qt/RETuningDialog.cpp"
 SOURCES += "sources/qt/REUndoCommand.cpp"
 SOURCES += "sources/qt/REXmlParser_qt.cpp"
+HEADERS += "sources/qt/REAudioStatsDialog.h"
 HEADERS += "sources/qt/REBendDialog.h"
 HEADERS += "sources/qt/REClefDialog.h"
 HEADERS += "sources/qt/REClefPreview.h"
@@ -255,6 +284,7 @@ HEADERS += "sources/qt/REGraphicsSystemItem.h"
 HEADERS += "sources/qt/REJackAudioEngine.h"
 HEADERS += "sources/qt/REKeySignatureDialog.h"
 HEADERS += "sources/qt/REKeySignaturePreview.h"
+HEADERS += "sources/qt/RELevelMeterWidget.h"
 HEADERS += "sources/qt/REMainWindow.h"
 HEADERS += "sources/qt/REMixerHeaderWidget.h"
 HEADERS += "sources/qt/REMixerRowWidget.h"
@@ -288,6 +318,7 @@ HEADERS += "sources/qt/RETrackListView.h"
 HEADERS += "sources/qt/RETransportWidget.h"
 HEADERS += "sources/qt/RETuningDialog.h"
 HEADERS += "sources/qt/REUndoCommand.h"
+FORMS += "sources/qt/REAudioStatsDialog.ui"
 FORMS += "sources/qt/REBendDialog.ui"
 FORMS += "sources/qt/REClefDialog.ui"
 FORMS += "sources/qt/RECreateTrackDialog.ui"
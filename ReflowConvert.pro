@@ -0,0 +1,258 @@
+QT += core gui xml
+CONFIG += c++11 console
+CONFIG -= app_bundle
+TARGET = reflow-convert
+TEMPLATE = app
+RESOURCES += Reflow.qrc
+DEFINES += REFLOW_QT
+DEFINES += REFLOW_NO_ICLOUD
+DEFINES += REFLOW_NO_FAVORITES
+DEFINES += REFLOW_NO_PYTHON
+DEFINES += BOOST_MEM_FN_ENABLE_STDCALL
+CONFIG(debug, debug|release) {
+DEFINES += REFLOW_VERBOSE
+}
+else {
+}
+SOURCES += "sources/convert/REBatchConverter.cpp"
+SOURCES += "sources/convert/REBatchConverter_qt.cpp"
+SOURCES += "sources/convert/main.cpp"
+HEADERS += "sources/convert/REBatchConverter.h"
+SOURCES += "sources/core/REArchive.cpp"
+SOURCES += "sources/core/REAudioEngine.cpp"
+SOURCES += "sources/core/REAudioEngineStats.cpp"
+SOURCES += "sources/core/REAudioExportEngine.cpp"
+SOURCES += "sources/core/REAudioMeter.cpp"
+SOURCES += "sources/core/REAudioSettings.cpp"
+SOURCES += "sources/core/REBar.cpp"
+SOURCES += "sources/core/REBarMetrics.cpp"
+SOURCES += "sources/core/REBeat.cpp"
+SOURCES += "sources/core/REBend.cpp"
+SOURCES += "sources/core/REChord.cpp"
+SOURCES += "sources/core/REChordAnalyzer.cpp"
+SOURCES += "sources/core/REChordDiagram.cpp"
+SOURCES += "sources/core/REChordFormula.cpp"
+SOURCES += "sources/core/REChordFormulaCollection.cpp"
+SOURCES += "sources/core/REChordName.cpp"
+SOURCES += "sources/core/REChunkedArchive.cpp"
+SOURCES += "sources/core/REClip.cpp"
+SOURCES += "sources/core/RECompression.cpp"
+SOURCES += "sources/core/RECursor.cpp"
+SOURCES += "sources/core/REDisplayList.cpp"
+SOURCES += "sources/core/REException.cpp"
+SOURCES += "sources/core/REFrame.cpp"
+SOURCES += "sources/core/REFunctions.cpp"
+SOURCES += "sources/core/REGrip.cpp"
+SOURCES += "sources/core/REGripCollection.cpp"
+SOURCES += "sources/core/REInputStream.cpp"
+SOURCES += "sources/core/REJsonStreamReader.cpp"
+SOURCES += "sources/core/RELayout.cpp"
+SOURCES += "sources/core/RELocator.cpp"
+SOURCES += "sources/core/RELogger.cpp"
+SOURCES += "sources/core/REManipulator.cpp"
+SOURCES += "sources/core/REMidiClip.cpp"
+SOURCES += "sources/core/REMidiEngine.cpp"
+SOURCES += "sources/core/REMidiFile.cpp"
+SOURCES += "sources/core/REMonophonicSynthVoice.cpp"
+SOURCES += "sources/core/REMonoSample.cpp"
+SOURCES += "sources/core/REMultivoiceIterator.cpp"
+SOURCES += "sources/core/REMusicalFont.cpp"
+SOURCES += "sources/core/REMusicDevice.cpp"
+SOURCES += "sources/core/REMusicRack.cpp"
+SOURCES += "sources/core/RENote.cpp"
+SOURCES += "sources/core/RENoteSelection.cpp"
+SOURCES += "sources/core/RENoteStateTable.cpp"
+SOURCES += "sources/core/REObject.cpp"
+SOURCES += "sources/core/REOutputStream.cpp"
+SOURCES += "sources/core/REPage.cpp"
+SOURCES += "sources/core/REPainter.cpp"
+SOURCES += "sources/core/REPatternIndex.cpp"
+SOURCES += "sources/core/REPhrase.cpp"
+SOURCES += "sources/core/REPitch.cpp"
+SOURCES += "sources/core/REPitchClass.cpp"
+SOURCES += "sources/core/REPlaylistBar.cpp"
+SOURCES += "sources/core/REPlaylistCompiler.cpp"
+SOURCES += "sources/core/REPlaylistIndex.cpp"
+SOURCES += "sources/core/REPython.cpp"
+SOURCES += "sources/core/RERecordingPainter.cpp"
+SOURCES += "sources/core/RESamplePlayer.cpp"
+SOURCES += "sources/core/REScore.cpp"
+SOURCES += "sources/core/REScoreController.cpp"
+SOURCES += "sources/core/REScoreNode.cpp"
+SOURCES += "sources/core/REScoreRoot.cpp"
+SOURCES += "sources/core/REScoreSettings.cpp"
+SOURCES += "sources/core/RESequencer.cpp"
+SOURCES += "sources/core/RESF2Generator.cpp"
+SOURCES += "sources/core/RESF2GeneratorPlayer.cpp"
+SOURCES += "sources/core/RESF2Patch.cpp"
+SOURCES += "sources/core/RESlice.cpp"
+SOURCES += "sources/core/RESlur.cpp"
+SOURCES += "sources/core/RESong.cpp"
+SOURCES += "sources/core/RESongController.cpp"
+SOURCES += "sources/core/RESongError.cpp"
+SOURCES += "sources/core/RESoundFont.cpp"
+SOURCES += "sources/core/RESoundFontManager.cpp"
+SOURCES += "sources/core/RESpecialCharacters.cpp"
+SOURCES += "sources/core/REStaff.cpp"
+SOURCES += "sources/core/REStandardNotationCompiler.cpp"
+SOURCES += "sources/core/REStandardStaff.cpp"
+SOURCES += "sources/core/REStyle.cpp"
+SOURCES += "sources/core/RESVGParser.cpp"
+SOURCES += "sources/core/RESymbol.cpp"
+SOURCES += "sources/core/RESystem.cpp"
+SOURCES += "sources/core/RETablatureStaff.cpp"
+SOURCES += "sources/core/RETable.cpp"
+SOURCES += "sources/core/RETickRangeModifier.cpp"
+SOURCES += "sources/core/RETimeline.cpp"
+SOURCES += "sources/core/RETimer.cpp"
+SOURCES += "sources/core/RETool.cpp"
+SOURCES += "sources/core/RETrack.cpp"
+SOURCES += "sources/core/RETrackSet.cpp"
+SOURCES += "sources/core/RETypes.cpp"
+SOURCES += "sources/core/REViewport.cpp"
+SOURCES += "sources/core/REVoice.cpp"
+SOURCES += "sources/core/REWavFileWriter.cpp"
+SOURCES += "sources/core/REWriteChunkToFile.cpp"
+HEADERS += "sources/core/REArchive.h"
+HEADERS += "sources/core/REAudioEngine.h"
+HEADERS += "sources/core/REAudioEngineStats.h"
+HEADERS += "sources/core/REAudioExportEngine.h"
+HEADERS += "sources/core/REAudioMeter.h"
+HEADERS += "sources/core/REAudioSettings.h"
+HEADERS += "sources/core/REBar.h"
+HEADERS += "sources/core/REBarMetrics.h"
+HEADERS += "sources/core/REBeat.h"
+HEADERS += "sources/core/REBend.h"
+HEADERS += "sources/core/REBezierPath.h"
+HEADERS += "sources/core/REChord.h"
+HEADERS += "sources/core/REChordAnalyzer.h"
+HEADERS += "sources/core/REChordDiagram.h"
+HEADERS += "sources/core/REChordFormula.h"
+HEADERS += "sources/core/REChordFormulaCollection.h"
+HEADERS += "sources/core/REChordName.h"
+HEADERS += "sources/core/REChunkedArchive.h"
+HEADERS += "sources/core/REClip.h"
+HEADERS += "sources/core/RECompression.h"
+HEADERS += "sources/core/RECursor.h"
+HEADERS += "sources/core/REDisplayList.h"
+HEADERS += "sources/core/REException.h"
+HEADERS += "sources/core/REFrame.h"
+HEADERS += "sources/core/REFunctions.h"
+HEADERS += "sources/core/REGrip.h"
+HEADERS += "sources/core/REGripCollection.h"
+HEADERS += "sources/core/REInputStream.h"
+HEADERS += "sources/core/REJsonStreamReader.h"
+HEADERS += "sources/core/RELayout.h"
+HEADERS += "sources/core/RELocator.h"
+HEADERS += "sources/core/RELogger.h"
+HEADERS += "sources/core/REManipulator.h"
+HEADERS += "sources/core/REMidiClip.h"
+HEADERS += "sources/core/REMidiEngine.h"
+HEADERS += "sources/core/REMidiFile.h"
+HEADERS += "sources/core/REMonophonicSynthVoice.h"
+HEADERS += "sources/core/REMonoSample.h"
+HEADERS += "sources/core/REMultivoiceIterator.h"
+HEADERS += "sources/core/REMusicalFont.h"
+HEADERS += "sources/core/REMusicDevice.h"
+HEADERS += "sources/core/REMusicRack.h"
+HEADERS += "sources/core/RENote.h"
+HEADERS += "sources/core/RENoteSelection.h"
+HEADERS += "sources/core/RENoteStateTable.h"
+HEADERS += "sources/core/REObject.h"
+HEADERS += "sources/core/REOutputStream.h"
+HEADERS += "sources/core/REPage.h"
+HEADERS += "sources/core/REPainter.h"
+HEADERS += "sources/core/REPatternIndex.h"
+HEADERS += "sources/core/REPhrase.h"
+HEADERS += "sources/core/REPitch.h"
+HEADERS += "sources/core/REPitchClass.h"
+HEADERS += "sources/core/REPlaylistBar.h"
+HEADERS += "sources/core/REPlaylistCompiler.h"
+HEADERS += "sources/core/REPlaylistIndex.h"
+HEADERS += "sources/core/REPython.h"
+HEADERS += "sources/core/RERecordingPainter.h"
+HEADERS += "sources/core/RESampleGenerator.h"
+HEADERS += "sources/core/RESamplePlayer.h"
+HEADERS += "sources/core/REScore.h"
+HEADERS += "sources/core/REScoreController.h"
+HEADERS += "sources/core/REScoreNode.h"
+HEADERS += "sources/core/REScoreRoot.h"
+HEADERS += "sources/core/REScoreSettings.h"
+HEADERS += "sources/core/RESequencer.h"
+HEADERS += "sources/core/RESF2Generator.h"
+HEADERS += "sources/core/RESF2GeneratorPlayer.h"
+HEADERS += "sources/core/RESF2Patch.h"
+HEADERS += "sources/core/RESlice.h"
+HEADERS += "sources/core/RESlur.h"
+HEADERS += "sources/core/RESong.h"
+HEADERS += "sources/core/RESongController.h"
+HEADERS += "sources/core/RESongError.h"
+HEADERS += "sources/core/RESoundFont.h"
+HEADERS += "sources/core/RESoundFontManager.h"
+HEADERS += "sources/core/RESpecialCharacters.h"
+HEADERS += "sources/core/REStaff.h"
+HEADERS += "sources/core/REStandardNotationCompiler.h"
+HEADERS += "sources/core/REStandardStaff.h"
+HEADERS += "sources/core/REStyle.h"
+HEADERS += "sources/core/RESVGParser.h"
+HEADERS += "sources/core/RESymbol.h"
+HEADERS += "sources/core/RESystem.h"
+HEADERS += "sources/core/RETablatureStaff.h"
+HEADERS += "sources/core/RETable.h"
+HEADERS += "sources/core/RETickRangeModifier.h"
+HEADERS += "sources/core/RETimeline.h"
+HEADERS += "sources/core/RETimer.h"
+HEADERS += "sources/core/RETool.h"
+HEADERS += "sources/core/RETrack.h"
+HEADERS += "sources/core/RETrackSet.h"
+HEADERS += "sources/core/RETypes.h"
+HEADERS += "sources/core/REViewport.h"
+HEADERS += "sources/core/REVoice.h"
+HEADERS += "sources/core/REWavFileWriter.h"
+HEADERS += "sources/core/REWriteChunkToFile.h"
+HEADERS += "sources/core/REXMLParser.h"
+SOURCES += "sources/plugins/guitarpro/REGuitarProParser.cpp"
+SOURCES += "sources/plugins/guitarpro/REGuitarProWriter.cpp"
+HEADERS += "sources/plugins/guitarpro/REGuitarProParser.h"
+HEADERS += "sources/plugins/guitarpro/REGuitarProWriter.h"
+SOURCES += "sources/qt/REBezierPath_qt.cpp"
+SOURCES += "sources/qt/REChordFormulaCollection_qt.cpp"
+SOURCES += "sources/qt/REFunctions_qt.cpp"
+SOURCES += "sources/qt/REGripCollection_qt.cpp"
+SOURCES += "sources/qt/REMusicalFont_qt.cpp"
+SOURCES += "sources/qt/REPainter_qt.cpp"
+SOURCES += "sources/qt/RERtAudioEngine.cpp"
+SOURCES += "sources/qt/RESoundFontManager_qt.cpp"
+SOURCES += "sources/qt/REXmlParser_qt.cpp"
+HEADERS += "sources/qt/RERtAudioEngine.h"
+SOURCES += "depends/rtaudio/RtAudio.cpp"
+HEADERS += "depends/rtaudio/RtAudio.h"
+INCLUDEPATH += "depends/rapidjson/include"
+INCLUDEPATH += "depends/rtaudio"
+INCLUDEPATH += "sources/convert"
+INCLUDEPATH += "sources/core"
+INCLUDEPATH += "sources/plugins/guitarpro"
+INCLUDEPATH += "sources/qt"
+INCLUDEPATH += "depends"
+win32 {
+    INCLUDEPATH += "$$(BOOST_HOME)"
+    INCLUDEPATH += "$$(JACK_HOME)\includes"
+    DEFINES += BOOST_MEM_FN_ENABLE_STDCALL
+    DEFINES += __WINDOWS_DS__
+    QMAKE_LIBDIR += "$$(JACK_HOME)\lib"
+    LIBS += dsound.lib ole32.lib libjack.lib
+    RC_FILE = Reflow.rc
+}
+macx {
+  INCLUDEPATH += /opt/Boost
+  INCLUDEPATH += /usr/local/include
+  DEFINES += __MACOSX_CORE__
+  DEFINES += MACOSX
+  LIBS += -lpthread -L/usr/local/lib -ljack -framework CoreAudio -framework CoreFoundation
+}
+linux-clang {
+    DEFINES += LINUX __LINUX_PULSE__
+    QMAKE_CXXFLAGS += -std=c++11
+    LIBS += -lpulse -lpulse-simple -ljack -lpthread -lrt
+}
+
@@ -0,0 +1,478 @@
+#include "REBenchmark.h"
+
+#include "RESong.h"
+#include "RETrack.h"
+#include "REVoice.h"
+#include "REPhrase.h"
+#include "REChord.h"
+#include "RENote.h"
+#include "REStandardNotationCompiler.h"
+#include "REScore.h"
+#include "REScoreSettings.h"
+#include "RESystem.h"
+#include "RELayout.h"
+#include "REDisplayList.h"
+#include "RERecordingPainter.h"
+#include "RESequencer.h"
+#include "REAudioExportEngine.h"
+#include "REMidiFile.h"
+#include "REInputStream.h"
+#include "REOutputStream.h"
+#include "REGuitarProParser.h"
+#include "REChunkedArchive.h"
+#include "REPatternIndex.h"
+#include "REChordAnalyzer.h"
+#include "REChordFormulaCollection.h"
+#include "RETimer.h"
+#include "REFunctions.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+bool ReadFileContents(const std::string& filename, std::string* contents)
+{
+    FILE* file = fopen(filename.c_str(), "rb");
+    if(file == NULL) return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    contents->resize(size > 0 ? size : 0);
+    bool ok = (size <= 0 || 1 == fread(&(*contents)[0], size, 1, file));
+    fclose(file);
+    return ok;
+}
+
+bool HasExtension(const std::string& filename, const char* ext)
+{
+    std::string lower = filename;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    size_t len = strlen(ext);
+    return lower.size() >= len && 0 == lower.compare(lower.size() - len, len, ext);
+}
+
+// First notes of the first voice that has enough of them, as a search pattern
+REPatternIndex::EventVector FirstPatternOfSong(const RESong* song, unsigned int length)
+{
+    for(int trackIndex=0; trackIndex < (int)song->TrackCount(); ++trackIndex)
+    {
+        const REVoice* voice = song->Track(trackIndex)->Voice(0);
+        REConstChordVector chords;
+        for(unsigned int barIndex=0; barIndex < voice->PhraseCount() && chords.size() < 4 * length; ++barIndex)
+        {
+            for(const REChord* chord : voice->Phrase(barIndex)->Chords()) {
+                chords.push_back(chord);
+            }
+        }
+
+        REPatternIndex::EventVector pattern;
+        REPatternIndex::EventsOfChords(chords, &pattern);
+        if(pattern.size() >= length) {
+            pattern.resize(length);
+            return pattern;
+        }
+    }
+    return REPatternIndex::EventVector();
+}
+
+// Copy of the song with every chord stacked in seconds and thirds, which is the worst case of the
+// standard notation compiler: notes share lines, need accidentals and are displaced
+RESong* CreateNotationHeavySong(const RESong* song)
+{
+    RESong* dense = song->Clone();
+    for(RETrack* track : dense->Tracks())
+    {
+        if(track->IsDrums()) continue;
+
+        for(REVoice* voice : track->Voices()) {
+            for(REPhrase* phrase : voice->Phrases()) {
+                for(REChord* chord : phrase->Chords())
+                {
+                    RENoteVector notes = chord->Notes();
+                    for(const RENote* base : notes)
+                    {
+                        for(int interval : {2, 4})
+                        {
+                            int midi = base->Pitch().midi + interval;
+                            if(midi > 127 || chord->NoteWithMidi(midi) != NULL) continue;
+
+                            // Tablature pitches are recalculated from the fret on refresh
+                            RENote* note = new RENote;
+                            note->SetString(base->String());
+                            note->SetFret(base->Fret() + interval);
+                            note->SetPitchFromMIDI(midi);
+                            chord->InsertNote(note, chord->NoteCount());
+                        }
+                    }
+                }
+            }
+        }
+    }
+    dense->Refresh(true);
+    return dense;
+}
+
+RESong* ParseSong(const std::string& filename, const std::string& bytes, std::string* error)
+{
+    RESong* song = new RESong;
+    try
+    {
+        if(HasExtension(filename, ".gp3") || HasExtension(filename, ".gp4") || HasExtension(filename, ".gp5"))
+        {
+            REBufferInputStream decoder(bytes.data(), bytes.size());
+            decoder.SetVersion(REFLOW_IO_VERSION);
+            REGuitarProParser parser;
+            if(!parser.Parse(&decoder, song)) {
+                *error = "Guitar Pro parser failed";
+            }
+        }
+        else if(HasExtension(filename, ".flow") && REChunkedArchive::IsChunkedArchive(bytes.data(), bytes.size()))
+        {
+            REConstBufferInputStream decoder(bytes.data(), bytes.size());
+            REChunkedArchive archive;
+            if(!archive.Read(decoder, *song)) {
+                *error = archive.Error();
+            }
+        }
+        else if(HasExtension(filename, ".flow"))
+        {
+            REBufferInputStream decoder(bytes.data(), bytes.size());
+            decoder.SetVersion(REFLOW_IO_VERSION);
+            decoder.SetSubType(REFLOW_IO_GENERIC);
+
+            std::string header = decoder.ReadBytes(4);
+            uint32_t version = decoder.ReadUInt32();
+            if(header != "FLOW") {
+                *error = "Not a valid Reflow file";
+            }
+            else if(version > REFLOW_IO_VERSION) {
+                *error = "File was created with a more recent file version";
+            }
+            else {
+                decoder.SetSubType(REFLOW_IO_REFLOW2);
+                decoder.SetVersion(version);
+                song->DecodeFrom(decoder);
+            }
+        }
+        else if(HasExtension(filename, ".mid") || HasExtension(filename, ".midi"))
+        {
+            REConstBufferInputStream stream(bytes.data(), bytes.size());
+            REMidiFile midiFile;
+            midiFile.Load(stream, REMidiFileLoadOptions());
+            if(midiFile.IsOK()) {
+                delete song;
+                song = midiFile.ImportSong();
+            }
+            else {
+                *error = midiFile.Error();
+            }
+        }
+        else {
+            *error = "Unsupported file type";
+        }
+    }
+    catch(std::exception& e) {
+        *error = e.what();
+    }
+
+    if(!error->empty()) {
+        delete song;
+        return nullptr;
+    }
+
+    // Guitar Pro and MIDI files come without parts
+    if(song->ScoreCount() == 0) {
+        for(unsigned int i=0; i<song->TrackCount(); ++i) {
+            song->CreatePart(i);
+        }
+    }
+    return song;
+}
+
+void WriteMeasureJson(REJsonWriter& writer, const REBenchmark::Measure& measure)
+{
+    writer.String(measure.name.c_str());
+    writer.StartObject();
+    writer.String("min_ms"); writer.Double(measure.Min());
+    writer.String("mean_ms"); writer.Double(measure.Mean());
+    writer.String("max_ms"); writer.Double(measure.Max());
+    writer.String("samples"); writer.Int((int)measure.samples.size());
+    if(measure.drawCalls) {
+        writer.String("draw_calls"); writer.Uint((unsigned)measure.drawCalls);
+    }
+    writer.EndObject();
+}
+
+}
+
+#pragma mark - REBenchmark::Measure
+
+double REBenchmark::Measure::Min() const
+{
+    return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+}
+
+double REBenchmark::Measure::Max() const
+{
+    return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+}
+
+double REBenchmark::Measure::Mean() const
+{
+    return samples.empty() ? 0.0 : std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+#pragma mark - REBenchmark
+
+REBenchmark::REBenchmark()
+    : _iterations(5), _audioRenderEnabled(false)
+{
+    _layoutIdentifiers = {"flex", "fix", "horiz"};
+}
+
+RESong* REBenchmark::LoadSong(const std::string& filename, std::string* error)
+{
+    std::string bytes;
+    if(!ReadFileContents(filename, &bytes)) {
+        *error = "Failed to read file";
+        return nullptr;
+    }
+    return ParseSong(filename, bytes, error);
+}
+
+REBenchmark::Measure& REBenchmark::_Time(FileResult& result, const std::string& name, const std::function<void()>& operation)
+{
+    result.measures.push_back(Measure());
+    Measure& measure = result.measures.back();
+    measure.name = name;
+
+    for(int i=0; i<_iterations; ++i)
+    {
+        RETimer timer;
+        timer.Start();
+        operation();
+        timer.Stop();
+        measure.samples.push_back(timer.DeltaTimeInMilliseconds());
+    }
+    return measure;
+}
+
+bool REBenchmark::RunFile(const std::string& filename)
+{
+    _results.push_back(FileResult());
+    FileResult& result = _results.back();
+    result.path = filename;
+
+    std::string bytes;
+    if(!ReadFileContents(filename, &bytes)) {
+        result.error = "Failed to read file";
+        return false;
+    }
+
+    // Parse: every iteration decodes the in-memory file into a fresh song
+    RESong* song = nullptr;
+    _Time(result, "parse", [&]() {
+        delete song;
+        song = ParseSong(filename, bytes, &result.error);
+    });
+    if(song == nullptr) {
+        return false;
+    }
+
+    result.barCount = song->BarCount();
+    result.trackCount = song->TrackCount();
+
+    // MIDI: decoding and quantization alone, with parallel tracks and on a single thread
+    if(HasExtension(filename, ".mid") || HasExtension(filename, ".midi"))
+    {
+        for(int threadCount : {0, 1})
+        {
+            REMidiFileLoadOptions options;
+            options.threadCount = threadCount;
+            _Time(result, threadCount == 1 ? "midi_load.serial" : "midi_load", [&]() {
+                REConstBufferInputStream stream(bytes.data(), bytes.size());
+                REMidiFile midiFile;
+                midiFile.Load(stream, options);
+            });
+        }
+    }
+
+    // Chunked .flow encoding and decoding, tracks in parallel and on a single thread
+    for(int threadCount : {0, 1})
+    {
+        REChunkedArchive archive;
+        archive.SetThreadCount(threadCount);
+        std::string suffix = (threadCount == 1 ? ".serial" : "");
+
+        std::string encoded;
+        _Time(result, "flow_encode" + suffix, [&]() {
+            archive.Encode(*song, &encoded);
+        });
+        _Time(result, "flow_decode" + suffix, [&]() {
+            REConstBufferInputStream stream(encoded.data(), encoded.size());
+            RESong decoded;
+            archive.Read(stream, decoded);
+        });
+    }
+
+    // Phrases refreshed on all cores and on a single thread
+    for(int threadCount : {1, 0})
+    {
+        song->SetRefreshThreadCount(threadCount);
+        _Time(result, threadCount == 1 ? "song_refresh.serial" : "song_refresh", [&]() {
+            song->Refresh(true);
+        });
+    }
+
+    // Standard notation on the dense copy: a full refresh, then the notation compiler alone
+    RESong* dense = CreateNotationHeavySong(song);
+    for(int threadCount : {1, 0})
+    {
+        dense->SetRefreshThreadCount(threadCount);
+        _Time(result, threadCount == 1 ? "song_refresh.dense.serial" : "song_refresh.dense", [&]() {
+            dense->Refresh(true);
+        });
+    }
+    _Time(result, "notation_compile.dense", [&]() {
+        for(RETrack* track : dense->Tracks())
+        {
+            if(track->IsDrums()) continue;
+            for(REVoice* voice : track->Voices()) {
+                for(REPhrase* phrase : voice->Phrases())
+                {
+                    REStandardNotationCompiler notation;
+                    notation.InitializeWithPhrase(phrase, false);
+                    for(REChord* chord : phrase->Chords()) {
+                        notation.ProcessChord(chord);
+                    }
+                }
+            }
+        }
+    });
+    delete dense;
+
+    // Layout and drawing, once per layout type, on the first score of the song
+    const REScoreSettings* songSettings = song->Score(0);
+    for(const std::string& identifier : _layoutIdentifiers)
+    {
+        RELayout* layout = RELayout::CreateLayoutWithIdentifier(identifier);
+        if(layout == nullptr || songSettings == nullptr) {
+            delete layout;
+            continue;
+        }
+
+        REScoreSettings settings(*songSettings);
+        settings.SetLayout(layout);
+
+        REScore score(song);
+        score.Rebuild(settings);
+
+        _Time(result, "score_refresh." + identifier, [&]() {
+            score.Refresh();
+        });
+
+        // Drawing is recorded into a display list, so rasterization is left out of the timing
+        REDisplayList displayList;
+        Measure& drawMeasure = _Time(result, "system_draw." + identifier, [&]() {
+            displayList.Clear();
+            RERecordingPainter painter(&displayList);
+            for(const RESystem* system : score.Systems()) {
+                system->Draw(painter);
+            }
+        });
+        drawMeasure.drawCalls = displayList.DrawCommandCount();
+
+        _Time(result, "display_list_replay." + identifier, [&]() {
+            REPainter painter;
+            displayList.Replay(painter);
+        });
+    }
+
+    // Pattern index over all voices, then a search for the opening notes of the song
+    REPatternIndex patternIndex;
+    _Time(result, "pattern_index_build", [&]() {
+        patternIndex.Build(song);
+    });
+
+    REPatternIndex::EventVector pattern = FirstPatternOfSong(song, 6);
+    if(!pattern.empty())
+    {
+        REPatternIndex::MatchVector matches;
+        _Time(result, "pattern_search", [&]() {
+            matches.clear();
+            patternIndex.FindMatches(pattern, REPatternIndex::MatchRhythm, &matches);
+        });
+    }
+
+    // Chord name suggestions over the whole song, from scratch and then with every bar up to date
+    const REChordFormulaCollection* chordFormulas = REChordFormulaCollection::BuiltinCollection();
+    _Time(result, "chord_analysis", [&]() {
+        REChordAnalyzer analyzer(chordFormulas);
+        analyzer.Update(song);
+    });
+
+    REChordAnalyzer chordAnalyzer(chordFormulas);
+    chordAnalyzer.Update(song);
+    _Time(result, "chord_analysis.update", [&]() {
+        chordAnalyzer.Update(song);
+    });
+
+    _Time(result, "sequencer_build", [&]() {
+        RESequencer sequencer;
+        sequencer.Build(song, nullptr);
+    });
+
+    if(_audioRenderEnabled)
+    {
+        std::string wavFilename = filename + ".bench.wav";
+        _Time(result, "audio_render", [&]() {
+            REAudioExportEngine engine(wavFilename);
+            engine.Initialize();
+            engine.ExportSong(song);
+            engine.Shutdown();
+        });
+        remove(wavFilename.c_str());
+    }
+
+    delete song;
+    return true;
+}
+
+void REBenchmark::WriteJson(REJsonWriter& writer) const
+{
+    writer.StartObject();
+
+    writer.String("version"); writer.String(REFLOW_CURRENT_VERSION);
+    writer.String("iterations"); writer.Int(_iterations);
+
+    writer.String("files");
+    writer.StartArray();
+    for(const FileResult& result : _results)
+    {
+        writer.StartObject();
+        writer.String("path"); writer.String(result.path.c_str());
+        if(!result.error.empty()) {
+            writer.String("error"); writer.String(result.error.c_str());
+        }
+        writer.String("bars"); writer.Int(result.barCount);
+        writer.String("tracks"); writer.Int(result.trackCount);
+
+        writer.String("measures");
+        writer.StartObject();
+        for(const Measure& measure : result.measures) {
+            WriteMeasureJson(writer, measure);
+        }
+        writer.EndObject();
+
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.EndObject();
+}
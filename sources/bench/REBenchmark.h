@@ -0,0 +1,68 @@
+#ifndef REBENCHMARK_H
+#define REBENCHMARK_H
+
+#include "RETypes.h"
+
+#include <functional>
+
+/** REBenchmark class.
+ *  Runs the headless pipeline (parse, song refresh, score layout, drawing, sequencer, audio render)
+ *  over a set of files and collects timings that can be written out as JSON.
+ */
+class REBenchmark
+{
+public:
+    struct Measure
+    {
+        std::string name;
+        std::vector<double> samples;     // milliseconds
+        unsigned long drawCalls;
+
+        Measure() : drawCalls(0) {}
+
+        double Min() const;
+        double Max() const;
+        double Mean() const;
+    };
+
+    struct FileResult
+    {
+        std::string path;
+        std::string error;
+        int barCount;
+        int trackCount;
+        std::vector<Measure> measures;
+
+        FileResult() : barCount(0), trackCount(0) {}
+    };
+
+public:
+    REBenchmark();
+
+    void SetIterations(int n) {_iterations = std::max(1, n);}
+    int Iterations() const {return _iterations;}
+
+    void SetAudioRenderEnabled(bool enabled) {_audioRenderEnabled = enabled;}
+    bool IsAudioRenderEnabled() const {return _audioRenderEnabled;}
+
+    void SetLayoutIdentifiers(const std::vector<std::string>& identifiers) {_layoutIdentifiers = identifiers;}
+
+    bool RunFile(const std::string& filename);
+
+    const std::vector<FileResult>& Results() const {return _results;}
+    void WriteJson(REJsonWriter& writer) const;
+
+public:
+    static RESong* LoadSong(const std::string& filename, std::string* error);
+
+private:
+    Measure& _Time(FileResult& result, const std::string& name, const std::function<void()>& operation);
+
+private:
+    int _iterations;
+    bool _audioRenderEnabled;
+    std::vector<std::string> _layoutIdentifiers;
+    std::vector<FileResult> _results;
+};
+
+#endif // REBENCHMARK_H
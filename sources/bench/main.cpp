@@ -0,0 +1,116 @@
+#include "REBenchmark.h"
+
+#include <REOutputStream.h>
+#include <RESoundFontManager.h>
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFile>
+#include <QStringList>
+
+#include <cstdio>
+
+static QStringList CollectCorpus(const QStringList& paths)
+{
+    QStringList filters;
+    filters << "*.flow" << "*.gp3" << "*.gp4" << "*.gp5" << "*.mid" << "*.midi";
+
+    QStringList files;
+    for(const QString& path : paths)
+    {
+        QFileInfo info(path);
+        if(info.isDir())
+        {
+            QStringList dirFiles;
+            QDirIterator it(path, filters, QDir::Files, QDirIterator::Subdirectories);
+            while(it.hasNext()) {
+                dirFiles << it.next();
+            }
+            dirFiles.sort();
+            files << dirFiles;
+        }
+        else if(info.isFile()) {
+            files << path;
+        }
+        else {
+            fprintf(stderr, "[Reflow] Skipping %s: not found\n", qPrintable(path));
+        }
+    }
+    return files;
+}
+
+int main(int argc, char *argv[])
+{
+    // Fonts are needed to measure text during layout, but no window is ever created
+    QGuiApplication a(argc, argv);
+    a.setApplicationName("reflow-bench");
+    a.setApplicationVersion(REFLOW_CURRENT_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless parse, layout, drawing and playback benchmark over a corpus of scores.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("paths", "Score files or directories (.flow, .gp3, .gp4, .gp5, .mid)", "paths...");
+
+    QCommandLineOption iterationsOption(QStringList() << "n" << "iterations", "Number of runs per measure.", "count", "5");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Write JSON results to file instead of stdout.", "file");
+    QCommandLineOption layoutsOption("layouts", "Comma separated layout identifiers (flex, fix, horiz, manual).", "list", "flex,fix,horiz");
+    QCommandLineOption audioOption("audio", "Also time offline audio rendering with this SoundFont.", "sf2");
+    parser.addOption(iterationsOption);
+    parser.addOption(outputOption);
+    parser.addOption(layoutsOption);
+    parser.addOption(audioOption);
+    parser.process(a);
+
+    QStringList files = CollectCorpus(parser.positionalArguments());
+    if(files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    REBenchmark benchmark;
+    benchmark.SetIterations(parser.value(iterationsOption).toInt());
+
+    std::vector<std::string> layouts;
+    for(const QString& identifier : parser.value(layoutsOption).split(',', QString::SkipEmptyParts)) {
+        layouts.push_back(identifier.trimmed().toStdString());
+    }
+    benchmark.SetLayoutIdentifiers(layouts);
+
+    if(parser.isSet(audioOption)) {
+        RESoundFontManager::Instance().SetDefaultSoundFontPath(parser.value(audioOption).toStdString());
+        benchmark.SetAudioRenderEnabled(true);
+    }
+
+    int failures = 0;
+    for(const QString& file : files)
+    {
+        fprintf(stderr, "[Reflow] Benchmarking %s\n", qPrintable(file));
+        if(!benchmark.RunFile(file.toStdString())) {
+            fprintf(stderr, "[Reflow] Failed: %s\n", benchmark.Results().back().error.c_str());
+            ++failures;
+        }
+    }
+
+    REBufferOutputStream buffer;
+    REJsonOutputBuffer json(buffer);
+    REJsonWriter writer(json);
+    benchmark.WriteJson(writer);
+    json.Flush();
+    buffer.Put('\n');
+
+    if(parser.isSet(outputOption))
+    {
+        QFile output(parser.value(outputOption));
+        if(!output.open(QFile::WriteOnly)) {
+            fprintf(stderr, "[Reflow] Failed to write %s\n", qPrintable(output.fileName()));
+            return 1;
+        }
+        output.write(buffer.Data(), buffer.Size());
+    }
+    else {
+        fwrite(buffer.Data(), buffer.Size(), 1, stdout);
+    }
+
+    return (failures == 0 ? 0 : 2);
+}
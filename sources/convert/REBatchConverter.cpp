@@ -0,0 +1,501 @@
+#include "REBatchConverter.h"
+
+#include "RESong.h"
+#include "REInputStream.h"
+#include "REOutputStream.h"
+#include "REGuitarProParser.h"
+#include "REGuitarProWriter.h"
+#include "REChunkedArchive.h"
+#include "REMidiFile.h"
+#include "RESequencer.h"
+#include "REAudioExportEngine.h"
+#include "RETimer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// Rough peak memory of a song per byte of its source file, which is far more compact than the decoded song
+const unsigned long kSongBytesPerSourceByte = 64;
+
+std::string LowercaseExtension(const std::string& filename)
+{
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of("/\\");
+    if(dot == std::string::npos || (slash != std::string::npos && dot < slash)) return "";
+
+    std::string ext = filename.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
+
+unsigned long FileSize(const std::string& filename)
+{
+    FILE* file = fopen(filename.c_str(), "rb");
+    if(file == NULL) return 0;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return (size > 0 ? (unsigned long)size : 0);
+}
+
+}
+
+#pragma mark - REBatchConverter::Job
+
+bool REBatchConverter::Job::IsOK() const
+{
+    return error.empty() && std::all_of(outputs.begin(), outputs.end(), [](const Output& output) {return output.IsOK();});
+}
+
+double REBatchConverter::Job::TotalTime() const
+{
+    double total = parseTime + refreshTime;
+    for(const Output& output : outputs) {
+        total += output.time;
+    }
+    return total;
+}
+
+#pragma mark - REBatchConverter
+
+REBatchConverter::REBatchConverter()
+: _threadCount(0), _workerCount(0), _verbose(false), _nextJob(0), _elapsedTime(0), _memoryLimit(0), _memoryInUse(0)
+{
+}
+
+bool REBatchConverter::FormatWithName(const std::string& name, Format* format)
+{
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if(lower == "flow") *format = FlowFormat;
+    else if(lower == "gp5") *format = GuitarPro5Format;
+    else if(lower == "mid" || lower == "midi") *format = MidiFormat;
+    else if(lower == "wav") *format = WaveFormat;
+    else if(lower == "json") *format = JsonFormat;
+    else if(lower == "pdf") *format = PdfFormat;
+    else return false;
+    return true;
+}
+
+const char* REBatchConverter::NameOfFormat(Format format)
+{
+    switch(format)
+    {
+        case FlowFormat: return "flow";
+        case GuitarPro5Format: return "gp5";
+        case MidiFormat: return "mid";
+        case WaveFormat: return "wav";
+        case JsonFormat: return "json";
+        case PdfFormat: return "pdf";
+    }
+    return "";
+}
+
+bool REBatchConverter::IsSupportedSource(const std::string& filename)
+{
+    std::string ext = LowercaseExtension(filename);
+    return ext == "flow" || ext == "gp3" || ext == "gp4" || ext == "gp5" || ext == "mid" || ext == "midi" || ext == "json";
+}
+
+void REBatchConverter::AddJob(const std::string& source, const std::vector<std::string>& destinations)
+{
+    Job job;
+    job.source = source;
+
+    unsigned long songEstimate = FileSize(source) * kSongBytesPerSourceByte;
+    job.memoryEstimate = songEstimate;
+
+    for(const std::string& destination : destinations)
+    {
+        Output output;
+        output.destination = destination;
+        if(!FormatWithName(LowercaseExtension(destination), &output.format)) {
+            output.error = "Unsupported destination format";
+        }
+        else if(destination == source) {
+            output.error = "Destination is the source file";
+        }
+
+        // Score layout roughly doubles the song, MIDI clips of the sequencer take about half of it
+        if(output.format == PdfFormat) job.memoryEstimate += songEstimate;
+        if(output.format == MidiFormat || output.format == WaveFormat) job.memoryEstimate += songEstimate / 2;
+
+        job.outputs.push_back(output);
+    }
+    _jobs.push_back(job);
+}
+
+int REBatchConverter::Run()
+{
+    int threadCount = _threadCount;
+    if(threadCount == 0) {
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, std::max(1, (int)_jobs.size()));
+    _workerCount = threadCount;
+
+    RETimer timer;
+    timer.Start();
+
+    _nextJob = 0;
+    _memoryInUse = 0;
+    std::vector<std::thread> workers;
+    for(int i=1; i<threadCount; ++i) {
+        workers.push_back(std::thread(&REBatchConverter::_RunWorker, this));
+    }
+    _RunWorker();
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+
+    timer.Stop();
+    _elapsedTime = timer.DeltaTimeInMilliseconds();
+
+    return std::count_if(_jobs.begin(), _jobs.end(), [](const Job& job) {return !job.IsOK();});
+}
+
+void REBatchConverter::_AcquireMemory(unsigned long bytes)
+{
+    if(_memoryLimit == 0) return;
+
+    // A job larger than the whole budget still runs, but alone
+    std::unique_lock<std::mutex> lock(_memoryMutex);
+    _memoryAvailable.wait(lock, [&]() {
+        return _memoryInUse == 0 || _memoryInUse + bytes <= _memoryLimit;
+    });
+    _memoryInUse += bytes;
+}
+
+void REBatchConverter::_ReleaseMemory(unsigned long bytes)
+{
+    if(_memoryLimit == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(_memoryMutex);
+        _memoryInUse -= bytes;
+    }
+    _memoryAvailable.notify_all();
+}
+
+void REBatchConverter::_RunWorker()
+{
+    // Parsers keep state while reading a file: one per worker, reused from one job to the next
+    REGuitarProParser parser;
+    parser.SetSongRefreshEnabled(false);
+
+    for(size_t idx = _nextJob++; idx < _jobs.size(); idx = _nextJob++)
+    {
+        Job& job = _jobs[idx];
+        _AcquireMemory(job.memoryEstimate);
+        _Convert(parser, job);
+        _ReleaseMemory(job.memoryEstimate);
+
+        if(_verbose || !job.IsOK())
+        {
+            std::lock_guard<std::mutex> lock(_logMutex);
+            if(!job.error.empty()) {
+                fprintf(stderr, "[Reflow] Failed to load %s: %s\n", job.source.c_str(), job.error.c_str());
+                continue;
+            }
+            if(_verbose) {
+                fprintf(stderr, "[Reflow] %s (parse %.2f ms, refresh %.2f ms)\n", job.source.c_str(), job.parseTime, job.refreshTime);
+            }
+            for(const Output& output : job.outputs)
+            {
+                if(!output.IsOK()) {
+                    fprintf(stderr, "[Reflow] Failed to convert %s to %s: %s\n", job.source.c_str(), output.destination.c_str(), output.error.c_str());
+                }
+                else if(_verbose) {
+                    fprintf(stderr, "[Reflow]   -> %s (%.2f ms)\n", output.destination.c_str(), output.time);
+                }
+            }
+        }
+    }
+}
+
+void REBatchConverter::_Convert(REGuitarProParser& parser, Job& job)
+{
+    RETimer timer;
+
+    timer.Start();
+    RESong* song = _Load(parser, job);
+    timer.Stop();
+    job.parseTime = timer.DeltaTimeInMilliseconds();
+    if(song == NULL) return;
+
+    // Refresh
+    timer.Start();
+    if(song->ScoreCount() == 0) {
+        for(unsigned int i=0; i<song->TrackCount(); ++i) {
+            song->CreatePart(i);
+        }
+    }
+    song->Refresh(true);
+    timer.Stop();
+    job.refreshTime = timer.DeltaTimeInMilliseconds();
+
+    for(Output& output : job.outputs)
+    {
+        if(!output.IsOK()) continue;
+
+        timer.Start();
+        _Write(*song, output);
+        timer.Stop();
+        output.time = timer.DeltaTimeInMilliseconds();
+    }
+
+    delete song;
+}
+
+RESong* REBatchConverter::_Load(REGuitarProParser& parser, Job& job)
+{
+    std::string ext = LowercaseExtension(job.source);
+
+    // Parse straight from the mapped file
+    REMappedFileInputStream decoder;
+    if(!decoder.Open(job.source)) {
+        job.error = "Failed to open file";
+        return NULL;
+    }
+    decoder.SetVersion(REFLOW_IO_VERSION);
+    job.bytesRead = decoder.Size();
+
+    // Workers already run one per core: refresh and decode on this thread
+    RESong* song = new RESong;
+    song->SetRefreshThreadCount(1);
+    try
+    {
+        if(ext == "gp3" || ext == "gp4" || ext == "gp5")
+        {
+            if(!parser.Parse(&decoder, song)) {
+                job.error = parser.Error();
+            }
+        }
+        else if(ext == "flow" && REChunkedArchive::IsChunkedArchive(decoder.Data(), decoder.Size()))
+        {
+            REChunkedArchive archive;
+            archive.SetThreadCount(1);
+            if(!archive.Read(decoder, *song)) {
+                job.error = archive.Error();
+            }
+        }
+        else if(ext == "flow")
+        {
+            decoder.SetSubType(REFLOW_IO_GENERIC);
+            std::string header = decoder.ReadBytes(4);
+            uint32_t version = decoder.ReadUInt32();
+            if(header != "FLOW") {
+                job.error = "Not a valid Reflow file";
+            }
+            else if(version > REFLOW_IO_VERSION) {
+                job.error = "File was created with a more recent file version";
+            }
+            else {
+                decoder.SetSubType(REFLOW_IO_REFLOW2);
+                decoder.SetVersion(version);
+                song->DecodeFrom(decoder);
+            }
+        }
+        else if(ext == "mid" || ext == "midi")
+        {
+            // Files are already converted in parallel, tracks of a file are decoded on the worker thread
+            REMidiFileLoadOptions options;
+            options.threadCount = 1;
+
+            REMidiFile midiFile;
+            midiFile.Load(decoder, options);
+            if(midiFile.IsOK()) {
+                delete song;
+                song = midiFile.ImportSong();
+            }
+            else {
+                job.error = midiFile.Error();
+            }
+        }
+        else if(ext == "json")
+        {
+            // Bars and tracks are decoded one at a time, straight from the mapped file
+            if(!song->ReadJson(decoder, REFLOW_IO_VERSION)) {
+                job.error = "Not a valid JSON song";
+            }
+        }
+        else {
+            job.error = "Unsupported file type";
+        }
+    }
+    catch(std::exception& e) {
+        job.error = e.what();
+    }
+
+    if(!job.error.empty()) {
+        delete song;
+        return NULL;
+    }
+    return song;
+}
+
+void REBatchConverter::_Write(const RESong& song, Output& output)
+{
+    bool written = false;
+    switch(output.format)
+    {
+        case FlowFormat:
+            written = _WriteFlow(song, output);
+            break;
+
+        case GuitarPro5Format:
+        {
+            REGuitarProWriter writer;
+            written = writer.ExportSongToFile(&song, output.destination);
+            break;
+        }
+
+        case MidiFormat:
+        {
+            RESequencer sequencer;
+            sequencer.SetExportThreadCount(1);
+            sequencer.Build(&song, nullptr);
+            written = sequencer.ExportMidiToFile(output.destination);
+            break;
+        }
+
+        case WaveFormat:
+        {
+            REAudioExportEngine engine(output.destination);
+            engine.Initialize();
+            written = engine.ExportSong(&song);
+            engine.Shutdown();
+            break;
+        }
+
+        case JsonFormat:
+            written = _WriteJson(song, output);
+            break;
+
+        case PdfFormat:
+            written = _WritePdf(song, output);
+            break;
+    }
+
+    if(!written) {
+        if(output.error.empty()) output.error = "Failed to write destination";
+        return;
+    }
+    output.bytesWritten = FileSize(output.destination);
+}
+
+bool REBatchConverter::_WriteFlow(const RESong& song, Output& output)
+{
+    // Workers already run one per core: encode the chunks on this thread
+    REChunkedArchive archive;
+    archive.SetThreadCount(1);
+    if(!archive.Write(song, output.destination)) {
+        output.error = archive.Error();
+        return false;
+    }
+    return true;
+}
+
+bool REBatchConverter::_WriteJson(const RESong& song, Output& output)
+{
+    REBufferOutputStream buffer;
+    song.WriteJson(buffer, REFLOW_IO_VERSION);
+
+    FILE* file = fopen(output.destination.c_str(), "wb");
+    if(file == NULL) {
+        output.error = "Failed to open destination for writing";
+        return false;
+    }
+    bool written = (buffer.Size() == 0 || 1 == fwrite(buffer.Data(), buffer.Size(), 1, file));
+    fclose(file);
+    return written;
+}
+
+void REBatchConverter::WriteJson(REJsonWriter& writer) const
+{
+    writer.StartObject();
+
+    writer.String("version"); writer.String(REFLOW_CURRENT_VERSION);
+    writer.String("threads"); writer.Int(_workerCount);
+    writer.String("memory_limit"); writer.Uint64(_memoryLimit);
+    writer.String("elapsed_ms"); writer.Double(_elapsedTime);
+
+    writer.String("files");
+    writer.StartArray();
+    for(const Job& job : _jobs)
+    {
+        writer.StartObject();
+        writer.String("source"); writer.String(job.source.c_str());
+        if(!job.error.empty()) {
+            writer.String("error"); writer.String(job.error.c_str());
+        }
+        writer.String("bytes_read"); writer.Uint((unsigned int)job.bytesRead);
+        writer.String("memory_estimate"); writer.Uint64(job.memoryEstimate);
+        writer.String("parse_ms"); writer.Double(job.parseTime);
+        writer.String("refresh_ms"); writer.Double(job.refreshTime);
+
+        writer.String("outputs");
+        writer.StartArray();
+        for(const Output& output : job.outputs)
+        {
+            writer.StartObject();
+            writer.String("format"); writer.String(NameOfFormat(output.format));
+            writer.String("destination"); writer.String(output.destination.c_str());
+            if(!output.IsOK()) {
+                writer.String("error"); writer.String(output.error.c_str());
+            }
+            writer.String("bytes_written"); writer.Uint((unsigned int)output.bytesWritten);
+            writer.String("ms"); writer.Double(output.time);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.EndObject();
+}
+
+void REBatchConverter::PrintSummary(FILE* file) const
+{
+    int failures = 0;
+    double parseTime = 0, refreshTime = 0;
+    double formatTimes[PdfFormat + 1] = {0};
+    int formatCounts[PdfFormat + 1] = {0};
+    for(const Job& job : _jobs)
+    {
+        if(!job.IsOK()) ++failures;
+        if(!job.error.empty()) continue;
+
+        parseTime += job.parseTime;
+        refreshTime += job.refreshTime;
+        for(const Output& output : job.outputs)
+        {
+            if(!output.IsOK()) continue;
+            formatTimes[output.format] += output.time;
+            ++formatCounts[output.format];
+        }
+    }
+
+    // Stage times are summed over all workers, so they can exceed the wall clock time
+    double total = parseTime + refreshTime;
+    for(double time : formatTimes) total += time;
+    total = std::max(total, 0.001);
+
+    fprintf(file, "[Reflow] Converted %d/%d files in %.1f ms\n", (int)_jobs.size() - failures, (int)_jobs.size(), _elapsedTime);
+    fprintf(file, "  parse    %10.1f ms  %5.1f%%\n", parseTime, 100.0 * parseTime / total);
+    fprintf(file, "  refresh  %10.1f ms  %5.1f%%\n", refreshTime, 100.0 * refreshTime / total);
+    for(int format = FlowFormat; format <= PdfFormat; ++format)
+    {
+        if(formatCounts[format] == 0) continue;
+        fprintf(file, "  %-5s    %10.1f ms  %5.1f%%  (%d files)\n", NameOfFormat((Format)format),
+                formatTimes[format], 100.0 * formatTimes[format] / total, formatCounts[format]);
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef REBATCHCONVERTER_H
+#define REBATCHCONVERTER_H
+
+#include "RETypes.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+
+class REGuitarProParser;
+
+/** REBatchConverter class.
+ *  Converts scores (.flow, Guitar Pro, MIDI) to one or more formats (.flow, .gp5, .mid, .wav, .pdf) on a pool of
+ *  worker threads, each worker owning its parser. Every job records how long loading, song refresh and each
+ *  output took.
+ *
+ *  Workers are bounded by the thread count and, optionally, by a memory budget: each job is given a rough
+ *  estimate of its peak memory use from its source size and outputs, and a worker waits before starting a
+ *  job that would exceed the budget, unless nothing else is running.
+ */
+class REBatchConverter
+{
+public:
+    enum Format
+    {
+        FlowFormat,
+        GuitarPro5Format,
+        MidiFormat,
+        WaveFormat,
+        JsonFormat,
+        PdfFormat
+    };
+
+    struct Output
+    {
+        Format format;
+        std::string destination;
+        std::string error;
+        unsigned long bytesWritten;
+        double time;            // milliseconds
+
+        Output() : format(FlowFormat), bytesWritten(0), time(0) {}
+
+        bool IsOK() const {return error.empty();}
+    };
+
+    struct Job
+    {
+        std::string source;
+        std::string error;
+        unsigned long bytesRead;
+        unsigned long memoryEstimate;
+        double parseTime;       // milliseconds
+        double refreshTime;
+        std::vector<Output> outputs;
+
+        Job() : bytesRead(0), memoryEstimate(0), parseTime(0), refreshTime(0) {}
+
+        bool IsOK() const;
+        double TotalTime() const;
+    };
+
+public:
+    REBatchConverter();
+
+    /** Zero means one thread per hardware core */
+    void SetThreadCount(int n) {_threadCount = std::max(0, n);}
+    int ThreadCount() const {return _threadCount;}
+
+    /** Zero means no limit */
+    void SetMemoryLimit(unsigned long bytes) {_memoryLimit = bytes;}
+    unsigned long MemoryLimit() const {return _memoryLimit;}
+
+    void SetVerbose(bool verbose) {_verbose = verbose;}
+
+    /** The format of each destination is given by its extension */
+    void AddJob(const std::string& source, const std::vector<std::string>& destinations);
+    const std::vector<Job>& Jobs() const {return _jobs;}
+
+    /** Runs all jobs and returns the number of failures */
+    int Run();
+
+    double ElapsedTime() const {return _elapsedTime;}
+
+    void WriteJson(REJsonWriter& writer) const;
+    void PrintSummary(FILE* file) const;
+
+public:
+    static bool FormatWithName(const std::string& name, Format* format);
+    static const char* NameOfFormat(Format format);
+    static bool IsSupportedSource(const std::string& filename);
+
+private:
+    void _RunWorker();
+    void _Convert(REGuitarProParser& parser, Job& job);
+    RESong* _Load(REGuitarProParser& parser, Job& job);
+    void _Write(const RESong& song, Output& output);
+    bool _WriteFlow(const RESong& song, Output& output);
+    bool _WriteJson(const RESong& song, Output& output);
+    bool _WritePdf(const RESong& song, Output& output);
+
+    void _AcquireMemory(unsigned long bytes);
+    void _ReleaseMemory(unsigned long bytes);
+
+private:
+    int _threadCount;
+    int _workerCount;
+    bool _verbose;
+    std::vector<Job> _jobs;
+    std::atomic<size_t> _nextJob;
+    std::mutex _logMutex;
+    double _elapsedTime;
+
+    unsigned long _memoryLimit;
+    unsigned long _memoryInUse;
+    std::mutex _memoryMutex;
+    std::condition_variable _memoryAvailable;
+};
+
+#endif // REBATCHCONVERTER_H
@@ -0,0 +1,50 @@
+#include "REBatchConverter.h"
+
+#include "RESong.h"
+#include "REScore.h"
+#include "REScoreSettings.h"
+#include "REPainter.h"
+
+#include <QFile>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QString>
+
+bool REBatchConverter::_WritePdf(const RESong& song, Output& output)
+{
+    // Same page setup as the document view export, with the first score of the song
+    const REScoreSettings* scoreSettings = song.Score(0);
+    if(scoreSettings == NULL) {
+        output.error = "Song has no score";
+        return false;
+    }
+
+    REScore score(&song);
+    score.Rebuild(*scoreSettings);
+
+    QPdfWriter pdf(QFile::decodeName(output.destination.c_str()));
+    pdf.setCreator("Reflow");
+    pdf.setTitle(QString("%1 - %2").arg(QString::fromStdString(song.Title())).arg(QString::fromStdString(scoreSettings->Name())));
+
+    QPainter qpainter;
+    if(!qpainter.begin(&pdf)) {
+        output.error = "Failed to open destination for writing";
+        return false;
+    }
+
+    REPainter painter(&qpainter);
+    painter.SetDrawingToScreen(false);
+
+    RERect pageRect = scoreSettings->PageRect();
+    RERect contentRect = scoreSettings->ContentRect();
+    qpainter.scale((float)pdf.width() / pageRect.Width(), (float)pdf.height() / pageRect.Height());
+    qpainter.translate(contentRect.origin.x, contentRect.origin.y);
+
+    for(unsigned int pageIndex=0; pageIndex<score.PageCount(); ++pageIndex)
+    {
+        if(pageIndex > 0) pdf.newPage();
+        score.DrawPage(painter, pageIndex);
+    }
+
+    return qpainter.end();
+}
@@ -0,0 +1,201 @@
+#include "REBatchConverter.h"
+
+#include <REOutputStream.h>
+#include <REMusicalFont.h>
+#include <RESoundFontManager.h>
+#include <REStyle.h>
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QStringList>
+#include <QSet>
+
+#include <cstdio>
+
+struct SourceFile
+{
+    QString path;
+    QString relativeDir;     // From the directory given on the command line, empty for files given directly
+};
+
+static QList<SourceFile> CollectSources(const QStringList& paths)
+{
+    QStringList filters;
+    // JSON songs are only converted when named explicitly, directories also hold reports
+    filters << "*.flow" << "*.gp3" << "*.gp4" << "*.gp5" << "*.mid" << "*.midi";
+
+    QList<SourceFile> files;
+    for(const QString& path : paths)
+    {
+        QFileInfo info(path);
+        if(info.isDir())
+        {
+            QStringList dirFiles;
+            QDirIterator it(path, filters, QDir::Files, QDirIterator::Subdirectories);
+            while(it.hasNext()) {
+                dirFiles << it.next();
+            }
+            dirFiles.sort();
+
+            QDir root(path);
+            for(const QString& dirFile : dirFiles) {
+                files << SourceFile{dirFile, root.relativeFilePath(QFileInfo(dirFile).path())};
+            }
+        }
+        else if(info.isFile()) {
+            files << SourceFile{path, QString()};
+        }
+        else {
+            fprintf(stderr, "[Reflow] Skipping %s: not found\n", qPrintable(path));
+        }
+    }
+    return files;
+}
+
+int main(int argc, char *argv[])
+{
+    // Fonts are needed for PDF layout, but no window is ever created: run without a display server
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication a(argc, argv);
+    a.setApplicationName("reflow-convert");
+    a.setApplicationVersion(REFLOW_CURRENT_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Converts scores between Reflow, Guitar Pro and MIDI files, and renders them to WAV or PDF, in parallel.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("paths", "Score files or directories (.flow, .gp3, .gp4, .gp5, .mid, .json)", "paths...");
+
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Number of worker threads (0: one per core).", "count", "0");
+    QCommandLineOption formatsOption(QStringList() << "f" << "formats", "Comma separated output formats (flow, gp5, mid, wav, json, pdf).", "list", "flow");
+    QCommandLineOption outputOption(QStringList() << "o" << "output-dir", "Write files to this directory instead of next to their source.", "dir");
+    QCommandLineOption memoryOption(QStringList() << "m" << "memory-limit", "Estimated memory the running conversions may use together (0: no limit).", "MB", "0");
+    QCommandLineOption soundFontOption("soundfont", "SoundFont used to render WAV and MIDI files.", "sf2");
+    QCommandLineOption reportOption("report", "Write per file timings as JSON to this file.", "file");
+    QCommandLineOption verboseOption(QStringList() << "v" << "verbose", "Print timings of every file.");
+    parser.addOption(jobsOption);
+    parser.addOption(formatsOption);
+    parser.addOption(outputOption);
+    parser.addOption(memoryOption);
+    parser.addOption(soundFontOption);
+    parser.addOption(reportOption);
+    parser.addOption(verboseOption);
+    parser.process(a);
+
+    QStringList formats;
+    bool needsSequencer = false;
+    bool needsLayout = false;
+    for(const QString& name : parser.value(formatsOption).split(',', QString::SkipEmptyParts))
+    {
+        REBatchConverter::Format format;
+        if(!REBatchConverter::FormatWithName(name.trimmed().toStdString(), &format)) {
+            fprintf(stderr, "[Reflow] Unknown output format %s\n", qPrintable(name));
+            return 1;
+        }
+        formats << REBatchConverter::NameOfFormat(format);
+        needsSequencer |= (format == REBatchConverter::MidiFormat || format == REBatchConverter::WaveFormat);
+        needsLayout |= (format == REBatchConverter::PdfFormat);
+    }
+    formats.removeDuplicates();
+
+    QList<SourceFile> files = CollectSources(parser.positionalArguments());
+    if(files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QDir outputDir;
+    bool hasOutputDir = parser.isSet(outputOption);
+    if(hasOutputDir)
+    {
+        outputDir = QDir(parser.value(outputOption));
+        if(!outputDir.exists() && !QDir().mkpath(outputDir.path())) {
+            fprintf(stderr, "[Reflow] Failed to create %s\n", qPrintable(outputDir.path()));
+            return 1;
+        }
+    }
+
+    // Shared resources are loaded lazily: load them once before the workers start
+    REStyleCollection::Instance();
+    if(parser.isSet(soundFontOption)) {
+        RESoundFontManager::Instance().SetDefaultSoundFontPath(parser.value(soundFontOption).toStdString());
+    }
+    if(needsSequencer) {
+        RESoundFontManager::Instance().DefaultSoundFont();
+    }
+    if(needsLayout) {
+        REMusicalFont::BuiltinFont();
+    }
+
+    REBatchConverter converter;
+    converter.SetThreadCount(parser.value(jobsOption).toInt());
+    converter.SetMemoryLimit(parser.value(memoryOption).toULong() * 1024 * 1024);
+    converter.SetVerbose(parser.isSet(verboseOption));
+
+    // Workers write in parallel: no destination may be another source or be written twice.
+    // Sources found in directories keep their subfolder under the output directory, and sources that
+    // still share a destination (x.gp5 and x.mid) are told apart by their full name (x.gp5.flow).
+    QSet<QString> claimedPaths;
+    for(const SourceFile& file : files) {
+        claimedPaths.insert(QFileInfo(file.path).absoluteFilePath());
+    }
+
+    for(const SourceFile& file : files)
+    {
+        QFileInfo info(file.path);
+        QDir destinationDir = (hasOutputDir ? QDir(outputDir.filePath(file.relativeDir)) : info.dir());
+        if(!destinationDir.exists() && !QDir().mkpath(destinationDir.path())) {
+            fprintf(stderr, "[Reflow] Failed to create %s\n", qPrintable(destinationDir.path()));
+            return 1;
+        }
+
+        std::vector<std::string> destinations;
+        for(const QString& format : formats)
+        {
+            QString destination = destinationDir.filePath(info.completeBaseName() + "." + format);
+            if(QFileInfo(destination).absoluteFilePath() == info.absoluteFilePath()) {
+                fprintf(stderr, "[Reflow] Skipping %s: it would be overwritten\n", qPrintable(destination));
+                continue;
+            }
+            if(claimedPaths.contains(QFileInfo(destination).absoluteFilePath())) {
+                destination = destinationDir.filePath(info.fileName() + "." + format);
+            }
+            if(claimedPaths.contains(QFileInfo(destination).absoluteFilePath())) {
+                fprintf(stderr, "[Reflow] Skipping %s: another file is converted to it\n", qPrintable(destination));
+                continue;
+            }
+
+            claimedPaths.insert(QFileInfo(destination).absoluteFilePath());
+            destinations.push_back(QFile::encodeName(destination).toStdString());
+        }
+        converter.AddJob(QFile::encodeName(file.path).toStdString(), destinations);
+    }
+
+    int failures = converter.Run();
+    converter.PrintSummary(stderr);
+
+    if(parser.isSet(reportOption))
+    {
+        REBufferOutputStream buffer;
+        REJsonOutputBuffer json(buffer);
+        REJsonWriter writer(json);
+        converter.WriteJson(writer);
+        json.Flush();
+        buffer.Put('\n');
+
+        QFile report(parser.value(reportOption));
+        if(!report.open(QFile::WriteOnly)) {
+            fprintf(stderr, "[Reflow] Failed to write %s\n", qPrintable(report.fileName()));
+            return 1;
+        }
+        report.write(buffer.Data(), buffer.Size());
+    }
+
+    return (failures == 0 ? 0 : 2);
+}
@@ -20,7 +20,7 @@ REAudioEngine* REAudioEngine::Instance()
 }
 
 REAudioEngine::REAudioEngine()
-    : _monitorRack(NULL), _soundfont(NULL), _sampleRate(44100)
+    : _monitorRack(NULL), _soundfont(NULL), _sampleRate(44100), _maxBufferSize(REFLOW_WORK_BUFFER_SIZE)
 {
 }
 REAudioEngine::~REAudioEngine()
@@ -38,6 +38,7 @@ void REAudioEngine::OnMidiPacketReceived(const REMidiInstantPacket* inPacket)
 void REAudioEngine::AddRack(REMusicRack* rack)
 {
     rack->SetSampleRate(_sampleRate);
+    rack->SetMaxBufferSize(_maxBufferSize);
     
     // CRITICAL: Add music rack to vector (Called from Main Thread)
     {
@@ -145,6 +146,13 @@ void REAudioEngine::_RouteInstantMidiClipToDevice(REMusicDevice* device, const R
     }
 }
 
+void REAudioEngine::_CollectRackCounters(REAudioEngineStats::Counters* counters)
+{
+    for(REMusicRack* rack : _racks) {
+        rack->CollectRenderCounters(counters);
+    }
+}
+
 const REAudioSettings& REAudioEngine::AudioSettings() const
 {
     return _settings;
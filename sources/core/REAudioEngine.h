@@ -12,6 +12,7 @@
 #include "RETypes.h"
 #include "REMidiClip.h"
 #include "REAudioSettings.h"
+#include "REAudioEngineStats.h"
 
 #include <mutex>
 
@@ -33,6 +34,9 @@ public:
     virtual void StopRendering();
     
     double SampleRate() const {return _sampleRate;}
+    
+    /** Largest number of frames handed to a rack in a single Render */
+    unsigned int MaxBufferSize() const {return _maxBufferSize;}
 
     const REAudioSettings& AudioSettings() const;
     void SetAudioSettings(const REAudioSettings& settings);
@@ -42,6 +46,10 @@ public:
     
     RESoundFont* SoundFont() {return _soundfont;}
     
+    /** Timing of the render callbacks since the engine started or the stats were reset */
+    const REAudioEngineStats& Stats() const {return _stats;}
+    REAudioEngineStats& Stats() {return _stats;}
+    
     void PlayInstantClipOnMonitoringDevice(const REMidiClip& clip, double bpm, int dpitch, bool appendSoundOffEvent=false);
     
 protected:
@@ -50,10 +58,12 @@ protected:
     
     void LoadDefaultSoundFont();
     void _RouteInstantMidiClipToDevice(REMusicDevice* device, const REInstantMidiClip* clip);
+    void _CollectRackCounters(REAudioEngineStats::Counters* counters);
     
 protected:
     static REAudioEngine* _instance;
     double _sampleRate;
+    unsigned int _maxBufferSize;
     REMidiInstantPacketRingBuffer _instantMidiPacketBuffer;
     REInstantMidiClipRingBuffer _instantMidiClipBuffer;
     REMusicRackVector _racks;
@@ -61,6 +71,7 @@ protected:
     REMusicDevice* _monitorDevice;
     RESoundFont* _soundfont;
     REAudioSettings _settings;
+    REAudioEngineStats _stats;
     mutable MutexType _mtx;
     
 public:
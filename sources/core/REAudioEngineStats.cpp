@@ -0,0 +1,165 @@
+//
+//  REAudioEngineStats.cpp
+//  Reflow
+//
+
+#include "REAudioEngineStats.h"
+#include "REOutputStream.h"
+
+namespace {
+
+const double HistogramBinWidth = 0.1;
+
+// Only the audio thread stores these, so a plain compare and store is enough
+template <typename T>
+void StoreMax(std::atomic<T>& value, T candidate)
+{
+    if(candidate > value.load(std::memory_order_relaxed)) {
+        value.store(candidate, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+void Accumulate(std::atomic<T>& value, T amount)
+{
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+}
+
+REAudioEngineStats::Report::Report()
+: callbacks(0), xruns(0), events(0), maxVoices(0), bufferFrames(0), sampleRate(0),
+  lastLoad(0), averageLoad(0), maxLoad(0), maxCallbackTime(0), totalLockWait(0), maxLockWait(0)
+{
+    for(int i=0; i<HistogramBinCount; ++i) {
+        histogram[i] = 0;
+    }
+}
+
+REAudioEngineStats::REAudioEngineStats()
+{
+    Reset();
+}
+
+void REAudioEngineStats::RecordCallback(unsigned int nbFrames, double sampleRate, double callbackSeconds, const Counters& counters)
+{
+    if(nbFrames == 0 || sampleRate <= 0) return;
+
+    double load = callbackSeconds * sampleRate / nbFrames;
+    int bin = (int)(load / HistogramBinWidth);
+    if(bin >= HistogramBinCount) bin = HistogramBinCount - 1;
+
+    _histogram[bin].fetch_add(1, std::memory_order_relaxed);
+    _bufferFrames.store(nbFrames, std::memory_order_relaxed);
+    _sampleRate.store(sampleRate, std::memory_order_relaxed);
+    _lastLoad.store(load, std::memory_order_relaxed);
+    Accumulate(_totalLoad, load);
+    StoreMax(_maxLoad, load);
+    StoreMax(_maxCallbackTime, callbackSeconds);
+    Accumulate(_totalLockWait, counters.lockWait);
+    StoreMax(_maxLockWait, counters.lockWait);
+    StoreMax(_maxVoices, counters.voices);
+    _events.fetch_add(counters.events, std::memory_order_relaxed);
+
+    // Last, so that a report never divides the total load by fewer callbacks than it holds
+    _callbacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void REAudioEngineStats::RecordXrun()
+{
+    _xruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+REAudioEngineStats::Report REAudioEngineStats::Snapshot() const
+{
+    Report report;
+    report.callbacks = _callbacks.load(std::memory_order_relaxed);
+    report.xruns = _xruns.load(std::memory_order_relaxed);
+    report.events = _events.load(std::memory_order_relaxed);
+    report.maxVoices = _maxVoices.load(std::memory_order_relaxed);
+    report.bufferFrames = _bufferFrames.load(std::memory_order_relaxed);
+    report.sampleRate = _sampleRate.load(std::memory_order_relaxed);
+    report.lastLoad = _lastLoad.load(std::memory_order_relaxed);
+    report.averageLoad = (report.callbacks ? _totalLoad.load(std::memory_order_relaxed) / report.callbacks : 0.0);
+    report.maxLoad = _maxLoad.load(std::memory_order_relaxed);
+    report.maxCallbackTime = _maxCallbackTime.load(std::memory_order_relaxed);
+    report.totalLockWait = _totalLockWait.load(std::memory_order_relaxed);
+    report.maxLockWait = _maxLockWait.load(std::memory_order_relaxed);
+    for(int i=0; i<HistogramBinCount; ++i) {
+        report.histogram[i] = _histogram[i].load(std::memory_order_relaxed);
+    }
+    return report;
+}
+
+void REAudioEngineStats::Reset()
+{
+    _callbacks.store(0, std::memory_order_relaxed);
+    _xruns.store(0, std::memory_order_relaxed);
+    _events.store(0, std::memory_order_relaxed);
+    _maxVoices.store(0, std::memory_order_relaxed);
+    _bufferFrames.store(0, std::memory_order_relaxed);
+    _sampleRate.store(0, std::memory_order_relaxed);
+    _lastLoad.store(0, std::memory_order_relaxed);
+    _totalLoad.store(0, std::memory_order_relaxed);
+    _maxLoad.store(0, std::memory_order_relaxed);
+    _maxCallbackTime.store(0, std::memory_order_relaxed);
+    _totalLockWait.store(0, std::memory_order_relaxed);
+    _maxLockWait.store(0, std::memory_order_relaxed);
+    for(int i=0; i<HistogramBinCount; ++i) {
+        _histogram[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+double REAudioEngineStats::LoadOfHistogramBin(int bin)
+{
+    return (bin + 1) * HistogramBinWidth;
+}
+
+void REAudioEngineStats::WriteJson(REJsonWriter& writer) const
+{
+    Report report = Snapshot();
+
+    writer.StartObject();
+
+    writer.String("sample_rate"); writer.Double(report.sampleRate);
+    writer.String("buffer_frames"); writer.Uint(report.bufferFrames);
+    writer.String("callbacks"); writer.Uint64(report.callbacks);
+    writer.String("xruns"); writer.Uint64(report.xruns);
+    writer.String("events"); writer.Uint64(report.events);
+    writer.String("max_voices"); writer.Uint(report.maxVoices);
+    writer.String("last_load"); writer.Double(report.lastLoad);
+    writer.String("average_load"); writer.Double(report.averageLoad);
+    writer.String("max_load"); writer.Double(report.maxLoad);
+    writer.String("max_callback_ms"); writer.Double(1000.0 * report.maxCallbackTime);
+    writer.String("total_lock_wait_ms"); writer.Double(1000.0 * report.totalLockWait);
+    writer.String("max_lock_wait_ms"); writer.Double(1000.0 * report.maxLockWait);
+
+    writer.String("load_histogram");
+    writer.StartArray();
+    for(int i=0; i<HistogramBinCount; ++i)
+    {
+        writer.StartObject();
+        writer.String("max_load");
+        if(i == HistogramBinCount - 1) writer.Null();
+        else writer.Double(LoadOfHistogramBin(i));
+        writer.String("callbacks"); writer.Uint64(report.histogram[i]);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.EndObject();
+}
+
+bool REAudioEngineStats::WriteToFile(const std::string& filename) const
+{
+    REFileOutputStream file;
+    if(!file.Open(filename)) return false;
+    {
+        REJsonOutputBuffer json(file);
+        REJsonWriter writer(json);
+        WriteJson(writer);
+        json.Flush();
+    }
+    file.Put('\n');
+    return file.Close();
+}
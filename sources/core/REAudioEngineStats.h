@@ -0,0 +1,95 @@
+//
+//  REAudioEngineStats.h
+//  Reflow
+//
+
+#ifndef __Reflow__REAudioEngineStats__
+#define __Reflow__REAudioEngineStats__
+
+#include "RETypes.h"
+
+#include <atomic>
+
+/** REAudioEngineStats class.
+ *  Timing of the audio engine render callbacks: how long each one took compared to the buffer it filled,
+ *  how many events and voices it processed, how long it waited on the engine and rack mutexes, and how
+ *  many buffers the driver reported as dropped.
+ *
+ *  The audio thread is the only writer of the callback figures, which are relaxed atomics so that the UI
+ *  can read a report at any time without locking anything.
+ */
+class REAudioEngineStats
+{
+public:
+    enum {
+        HistogramBinCount = 16      // Bins of 10% of the buffer period, the last one also counts anything longer
+    };
+
+    /** What one callback rendered, gathered from the racks while they are processed */
+    struct Counters
+    {
+        unsigned int events;        // MIDI events processed by the devices
+        unsigned int voices;        // Sounding voices, largest over the render slices of the callback
+        double lockWait;            // Seconds spent acquiring the engine and rack mutexes
+
+        Counters() : events(0), voices(0), lockWait(0) {}
+    };
+
+    struct Report
+    {
+        uint64_t callbacks;
+        uint64_t xruns;
+        uint64_t events;
+        unsigned int maxVoices;
+        unsigned int bufferFrames;  // Frames of the last callback
+        double sampleRate;
+        double lastLoad;            // Callback duration over buffer period
+        double averageLoad;
+        double maxLoad;
+        double maxCallbackTime;     // Seconds
+        double totalLockWait;
+        double maxLockWait;
+        uint64_t histogram[HistogramBinCount];
+
+        Report();
+    };
+
+public:
+    REAudioEngineStats();
+
+public: // [[CALLED FROM AUDIO RT THREAD]]
+    void RecordCallback(unsigned int nbFrames, double sampleRate, double callbackSeconds, const Counters& counters);
+
+    /** May be called from a driver notification thread */
+    void RecordXrun();
+
+public: // [[CALLED FROM MAIN UI THREAD]]
+    Report Snapshot() const;
+
+    /** Starts counting again. A callback running at the same time may still be counted. */
+    void Reset();
+
+    void WriteJson(REJsonWriter& writer) const;
+    bool WriteToFile(const std::string& filename) const;
+
+public:
+    /** Upper bound of the load of a histogram bin */
+    static double LoadOfHistogramBin(int bin);
+
+private:
+    std::atomic<uint64_t> _callbacks;
+    std::atomic<uint64_t> _xruns;
+    std::atomic<uint64_t> _events;
+    std::atomic<unsigned int> _maxVoices;
+    std::atomic<unsigned int> _bufferFrames;
+    std::atomic<double> _sampleRate;
+    std::atomic<double> _lastLoad;
+    std::atomic<double> _totalLoad;
+    std::atomic<double> _maxLoad;
+    std::atomic<double> _maxCallbackTime;
+    std::atomic<double> _totalLockWait;
+    std::atomic<double> _maxLockWait;
+    std::atomic<uint64_t> _histogram[HistogramBinCount];
+};
+
+#endif /* defined(__Reflow__REAudioEngineStats__) */
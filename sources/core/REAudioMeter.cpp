@@ -0,0 +1,104 @@
+//
+//  REAudioMeter.cpp
+//  Reflow
+//
+
+#include "REAudioMeter.h"
+
+#include <cmath>
+
+namespace {
+
+// Peaks fall back and RMS settles over roughly this many seconds
+const double MeterTimeConstant = 0.3;
+
+}
+
+REAudioMeter::REAudioMeter()
+: _load(0), _publishedLoad(0), _clipped(false)
+{
+    for(int i=0; i<2; ++i)
+    {
+        _peak[i] = 0;
+        _meanSquare[i] = 0;
+        _publishedPeak[i] = 0;
+        _publishedRms[i] = 0;
+    }
+}
+
+void REAudioMeter::Measure(const float* buffer, unsigned int nbSamples, float* peak, float* sumOfSquares)
+{
+    // Four independent lanes so that the compiler can keep them in one vector register
+    float p[4] = {0, 0, 0, 0};
+    float s[4] = {0, 0, 0, 0};
+
+    unsigned int i = 0;
+    for(; i + 4 <= nbSamples; i += 4)
+    {
+        for(int lane=0; lane<4; ++lane)
+        {
+            float x = buffer[i + lane];
+            float a = std::fabs(x);
+            p[lane] = (a > p[lane] ? a : p[lane]);
+            s[lane] += x * x;
+        }
+    }
+    for(; i < nbSamples; ++i)
+    {
+        float x = buffer[i];
+        float a = std::fabs(x);
+        p[0] = (a > p[0] ? a : p[0]);
+        s[0] += x * x;
+    }
+
+    *peak = std::max(std::max(p[0], p[1]), std::max(p[2], p[3]));
+    *sumOfSquares = (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+void REAudioMeter::Process(const float* bufferL, const float* bufferR, unsigned int nbSamples, double sampleRate, double renderSeconds)
+{
+    if(nbSamples == 0 || sampleRate <= 0) return;
+
+    double bufferSeconds = nbSamples / sampleRate;
+    float decay = (float)std::exp(-bufferSeconds / MeterTimeConstant);
+
+    const float* buffers[2] = {bufferL, bufferR};
+    bool clipped = false;
+    for(int i=0; i<2; ++i)
+    {
+        float peak, sumOfSquares;
+        Measure(buffers[i], nbSamples, &peak, &sumOfSquares);
+        if(peak > 1.0f) clipped = true;
+
+        _peak[i] = std::max(peak, _peak[i] * decay);
+        _meanSquare[i] = sumOfSquares / nbSamples + (_meanSquare[i] - sumOfSquares / nbSamples) * decay;
+
+        _publishedPeak[i].store(_peak[i], std::memory_order_relaxed);
+        _publishedRms[i].store(std::sqrt(_meanSquare[i]), std::memory_order_relaxed);
+    }
+
+    float load = (float)(renderSeconds / bufferSeconds);
+    _load = load + (_load - load) * decay;
+    _publishedLoad.store(_load, std::memory_order_relaxed);
+
+    if(clipped) {
+        _clipped.store(true, std::memory_order_relaxed);
+    }
+}
+
+REAudioMeter::Levels REAudioMeter::Snapshot() const
+{
+    Levels levels;
+    levels.peakL = _publishedPeak[0].load(std::memory_order_relaxed);
+    levels.peakR = _publishedPeak[1].load(std::memory_order_relaxed);
+    levels.rmsL = _publishedRms[0].load(std::memory_order_relaxed);
+    levels.rmsR = _publishedRms[1].load(std::memory_order_relaxed);
+    levels.load = _publishedLoad.load(std::memory_order_relaxed);
+    levels.clipped = _clipped.load(std::memory_order_relaxed);
+    return levels;
+}
+
+void REAudioMeter::ResetClip()
+{
+    _clipped.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,59 @@
+//
+//  REAudioMeter.h
+//  Reflow
+//
+
+#ifndef __Reflow__REAudioMeter__
+#define __Reflow__REAudioMeter__
+
+#include "RETypes.h"
+
+#include <atomic>
+
+/** REAudioMeter class.
+ *  Peak and RMS levels of a stereo output, and how much of the buffer duration was spent rendering it.
+ *
+ *  Levels are measured and smoothed on the audio thread, which is the only writer, then published as
+ *  atomics so that the UI can read a snapshot at display rate without locking the rack.
+ */
+class REAudioMeter
+{
+public:
+    struct Levels
+    {
+        float peakL, peakR;     // linear, 1.0 is full scale
+        float rmsL, rmsR;
+        float load;             // render time over buffer duration
+        bool clipped;           // a sample went over full scale since the last ResetClip
+
+        Levels() : peakL(0), peakR(0), rmsL(0), rmsR(0), load(0), clipped(false) {}
+    };
+
+public:
+    REAudioMeter();
+
+public: // [[CALLED FROM AUDIO RT THREAD]]
+    void Process(const float* bufferL, const float* bufferR, unsigned int nbSamples, double sampleRate, double renderSeconds);
+
+public: // [[CALLED FROM MAIN UI THREAD]]
+    Levels Snapshot() const;
+    void ResetClip();
+
+public:
+    /** Largest absolute sample and sum of squares of a buffer */
+    static void Measure(const float* buffer, unsigned int nbSamples, float* peak, float* sumOfSquares);
+
+private:
+    // Audio thread state
+    float _peak[2];
+    float _meanSquare[2];
+    float _load;
+
+    // Published state
+    std::atomic<float> _publishedPeak[2];
+    std::atomic<float> _publishedRms[2];
+    std::atomic<float> _publishedLoad;
+    std::atomic<bool> _clipped;
+};
+
+#endif /* defined(__Reflow__REAudioMeter__) */
@@ -52,9 +52,14 @@ RETimeDiv REBar::TheoricDuration() const
     return RETimeDiv(4*_timeSignature.numerator, _timeSignature.denominator);
 }
 
+REExactTick REBar::ExactTheoricDuration() const
+{
+    return (4 * (REExactTick)_timeSignature.numerator * REFLOW_EXACT_TICKS_PER_QUARTER) / _timeSignature.denominator;
+}
+
 unsigned long REBar::TheoricDurationInTicks() const
 {
-    return Reflow::TimeDivToTicks(TheoricDuration());
+    return Reflow::ExactTicksToTicks(ExactTheoricDuration());
 }
 
 bool REBar::HasTimeSignatureChange() const
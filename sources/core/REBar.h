@@ -16,6 +16,7 @@ class REBar
 {
 	friend class RESong;
     friend class REArchive;
+    friend class REChunkedArchive;
     
 public:
     typedef std::pair<int, REChordName> REChordNameTickPair;
@@ -58,6 +59,7 @@ public:
     int AccidentalCountOnKeySignature() const;
     
     RETimeDiv TheoricDuration() const;
+    REExactTick ExactTheoricDuration() const;
     unsigned long TheoricDurationInTicks() const;
     unsigned long OffsetInTicks() const;
     
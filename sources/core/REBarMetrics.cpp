@@ -9,6 +9,8 @@
 #include "REBarMetrics.h"
 #include "RETrackSet.h"
 
+#include <algorithm>
+
 REBarMetrics::REBarMetrics()
 : _leadingSpaceIfFirst(40.0), _leadingSpaceInMiddle(10.0), _trailingSpaceInMiddle(10.0), _trailingSpaceIfLast(10.0), _contentWidth(0.0),
   _timeSignatureOffsetIfFirst(0), _timeSignatureOffsetInMiddle(0)
@@ -49,12 +51,12 @@ const REBarMetrics::REBMColumn& REBarMetrics::Column(int columnIndex) const
 
 int REBarMetrics::ColumnIndexAtTick(unsigned long tick) const
 {
-    for(unsigned int i=0; i<_columns.size(); ++i)
-    {
-        const REBarMetrics::REBMColumn& col = _columns[i];
-        if(col.tick == tick) {
-            return i;
-        }
+    // Columns are built from an ordered tick set, so we can binary search them
+    std::vector<REBMColumn>::const_iterator it = std::lower_bound(_columns.begin(), _columns.end(), tick,
+        [](const REBMColumn& col, unsigned long t) {return col.tick < t;});
+    
+    if(it != _columns.end() && it->tick == tick) {
+        return (int)(it - _columns.begin());
     }
     return -1;
 }
@@ -65,13 +67,11 @@ int REBarMetrics::ColumnIndexAtOrBeforeTick(unsigned long tick, unsigned long* p
         return -1;
     }
     
-    int i = 1;
-    while(i < _columns.size() && _columns[i].tick < tick)
-    {
-        ++i;
-    }
+    // First column (after the first one) whose tick is not before the requested tick
+    std::vector<REBMColumn>::const_iterator it = std::lower_bound(_columns.begin() + 1, _columns.end(), tick,
+        [](const REBMColumn& col, unsigned long t) {return col.tick < t;});
 
-    int firstColumn = i-1;
+    int firstColumn = (int)(it - _columns.begin()) - 1;
     const REBarMetrics::REBMColumn& col = _columns[firstColumn];
     *prevTick = col.tick;
     if(firstColumn != _columns.size()-1) 
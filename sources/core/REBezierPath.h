@@ -38,6 +38,12 @@ public:
     void AddEllipseInRect(const RERect& rect);
     void Transform(const REAffineTransform& transform);
     void Close();
+    
+    RERect BoundingBox() const;
+
+    /** Same elements and fill rule */
+    bool operator==(const REBezierPath& rhs) const;
+    bool operator!=(const REBezierPath& rhs) const {return !(*this == rhs);}
         
 #ifdef REFLOW_QT
 public:
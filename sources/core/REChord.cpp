@@ -19,7 +19,7 @@
 #include <algorithm>
 
 REChord::REChord()
-: _parent(0), _index(-1), _noteValue(Reflow::QuarterNote), _dots(0), _tuplet(0,0), _flags(0), _text(NULL), _dynamics(Reflow::DynamicsUndefined)
+: _parent(0), _index(-1), _noteValue(Reflow::QuarterNote), _dots(0), _tuplet(0,0), _flags(0), _text(NULL), _dynamics(Reflow::DynamicsUndefined), _duration(0), _offset(0)
 {
     _RefreshDuration();
 #ifdef REFLOW_2
@@ -340,25 +340,36 @@ bool REChord::operator==(const REChord &rhs) const {
 
 unsigned long REChord::DurationInTicks() const
 {
-    return Reflow::TimeDivToTicks(_duration);
+    return Reflow::ExactTicksToTicks(_duration);
 }
 
 unsigned long REChord::OffsetInTicks() const
 {
-    return Reflow::TimeDivToTicks(_offset);
+    return Reflow::ExactTicksToTicks(_offset);
+}
+
+RETimeDiv REChord::Duration() const
+{
+    return Reflow::ExactTicksToTimeDiv(_duration);
+}
+
+RETimeDiv REChord::Offset() const
+{
+    return Reflow::ExactTicksToTimeDiv(_offset);
 }
 
 void REChord::_RefreshDuration() const
 {
+    const REExactTick quarter = REFLOW_EXACT_TICKS_PER_QUARTER;
     switch(_noteValue)
     {
-        case Reflow::WholeNote: _duration = RETimeDiv(4); break;
-        case Reflow::HalfNote: _duration = RETimeDiv(2); break;
-        case Reflow::QuarterNote: _duration = RETimeDiv(1); break;
-        case Reflow::EighthNote: _duration = RETimeDiv(1,2); break;
-        case Reflow::SixteenthNote: _duration = RETimeDiv(1,4); break;
-        case Reflow::ThirtySecondNote: _duration = RETimeDiv(1,8); break;
-        case Reflow::SixtyFourthNote: _duration = RETimeDiv(1,16); break;
+        case Reflow::WholeNote: _duration = 4 * quarter; break;
+        case Reflow::HalfNote: _duration = 2 * quarter; break;
+        case Reflow::QuarterNote: _duration = quarter; break;
+        case Reflow::EighthNote: _duration = quarter / 2; break;
+        case Reflow::SixteenthNote: _duration = quarter / 4; break;
+        case Reflow::ThirtySecondNote: _duration = quarter / 8; break;
+        case Reflow::SixtyFourthNote: _duration = quarter / 16; break;
     }
     
     if(_dots == 1) {
@@ -369,7 +380,7 @@ void REChord::_RefreshDuration() const
     }
     
     if (_tuplet.tuplet != 0 && _tuplet.tupletFor != 0) {
-        _duration *= RETimeDiv(_tuplet.tupletFor, _tuplet.tuplet);
+        _duration = (_duration * _tuplet.tupletFor) / _tuplet.tuplet;
     }
 }
 
@@ -115,8 +115,11 @@ public:
     unsigned long DurationInTicks() const;
     unsigned long OffsetInTicks() const;
     
-    const RETimeDiv& Duration() const {return _duration;}
-    const RETimeDiv& Offset() const {return _offset;}
+    RETimeDiv Duration() const;
+    RETimeDiv Offset() const;
+    
+    REExactTick ExactDuration() const {return _duration;}
+    REExactTick ExactOffset() const {return _offset;}
     
   	RELocator Locator() const;
     
@@ -222,8 +225,8 @@ private:
     REBeatText* _text;
     uint32_t _flags;
     
-    mutable RETimeDiv _duration;
-    mutable RETimeDiv _offset;
+    mutable REExactTick _duration;
+    mutable REExactTick _offset;
 };
 
 
@@ -0,0 +1,214 @@
+//
+//  REChordAnalyzer.cpp
+//  Reflow
+//
+
+#include "REChordAnalyzer.h"
+#include "REChordFormulaCollection.h"
+#include "REChordName.h"
+#include "RESong.h"
+#include "RETrack.h"
+#include "RETrackSet.h"
+#include "REVoice.h"
+#include "REPhrase.h"
+#include "REChord.h"
+#include "RENote.h"
+
+namespace {
+
+int PitchClassCount(uint16_t mask)
+{
+    int count = 0;
+    for(; mask; mask &= (mask - 1)) ++count;
+    return count;
+}
+
+/** Mask of the pitch classes relative to root, bit 0 being the root itself. */
+uint16_t RotatedMask(uint16_t mask, int root)
+{
+    return (uint16_t)(((mask >> root) | (mask << (12 - root))) & 0x0FFF);
+}
+
+/** Spelling used for suggested roots: flats, except for F#. */
+REPitchClass RootPitchClass(int chromatic)
+{
+    return REPitchClass(0, chromatic).Normalized(chromatic != 6);
+}
+
+struct PhraseCursor
+{
+    const REPhrase* phrase;
+    unsigned int index;
+};
+
+}
+
+REChordAnalyzer::REChordAnalyzer(const REChordFormulaCollection* collection)
+: _collection(collection)
+{
+}
+
+REChordAnalyzer::~REChordAnalyzer()
+{
+}
+
+void REChordAnalyzer::Reset()
+{
+    _bars.clear();
+}
+
+bool REChordAnalyzer::Update(const RESong* song, int maxBars, REIntVector* changedBars)
+{
+    int nbBars = (int)song->BarCount();
+    _bars.resize(nbBars);
+
+    RETrackSet tracks;
+    for(unsigned int i=0; i<song->TrackCount(); ++i) {
+        if(!song->Track(i)->IsDrums()) tracks.Set(i);
+    }
+
+    for(int barIndex=0; barIndex < nbBars; ++barIndex)
+    {
+        BarAnalysis& bar = _bars[barIndex];
+        REPitchSummary key = _KeyOfBar(song, tracks, barIndex);
+        if(bar.valid && key == bar.key) continue;
+
+        if(maxBars == 0) return false;
+        if(maxBars > 0) --maxBars;
+
+        REBar::REBarChordNameVector suggestions;
+        _AnalyseBar(song, tracks, barIndex, suggestions);
+
+        bool changed = (suggestions.size() != bar.suggestions.size());
+        for(unsigned int i=0; !changed && i<suggestions.size(); ++i) {
+            const REChordName& a = suggestions[i].second;
+            const REChordName& b = bar.suggestions[i].second;
+            changed = (suggestions[i].first != bar.suggestions[i].first || a.ToString() != b.ToString());
+        }
+
+        bar.valid = true;
+        bar.key = key;
+        bar.suggestions.swap(suggestions);
+        if(changed && changedBars) {
+            changedBars->push_back(barIndex);
+        }
+    }
+    return true;
+}
+
+const REBar::REBarChordNameVector& REChordAnalyzer::SuggestedChordNamesOfBar(int barIndex) const
+{
+    static const REBar::REBarChordNameVector _empty;
+    if(barIndex < 0 || barIndex >= (int)_bars.size()) return _empty;
+    return _bars[barIndex].suggestions;
+}
+
+const REChordName* REChordAnalyzer::SuggestedChordNameAtTick(int barIndex, int tick) const
+{
+    const REChordName* chordName = NULL;
+    for(const REBar::REChordNameTickPair& suggestion : SuggestedChordNamesOfBar(barIndex))
+    {
+        if(suggestion.first > tick) break;
+        chordName = &suggestion.second;
+    }
+    return chordName;
+}
+
+bool REChordAnalyzer::Recognize(uint16_t pitchClassMask, int bassPitchClass, REChordName& outChordName) const
+{
+    pitchClassMask &= 0x0FFF;
+    if(_collection == NULL || PitchClassCount(pitchClassMask) < 2) return false;
+
+    // Bass first, then the other pitch classes upwards from it
+    for(int i=0; i<12; ++i)
+    {
+        int root = (bassPitchClass + i) % 12;
+        if(0 == (pitchClassMask & (1 << root))) continue;
+
+        const REChordFormulaCollectionEntry* entry = _collection->EntryWithPitchClassMask(RotatedMask(pitchClassMask, root));
+        if(entry == NULL) continue;
+
+        outChordName = REChordName(RootPitchClass(root), entry->formula);
+        if(root != bassPitchClass)
+        {
+            for(int degree=1; degree < outChordName.DegreeCount(); ++degree) {
+                if(outChordName.Degree(degree).ChromaticStep() == bassPitchClass) {
+                    outChordName.SetInversion(degree);
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+REPitchSummary REChordAnalyzer::_KeyOfBar(const RESong* song, const RETrackSet& tracks, int barIndex) const
+{
+    REPitchSummary key;
+    for(unsigned int i=0; i<song->TrackCount(); ++i)
+    {
+        if(!tracks.IsSet(i)) continue;
+        key.Merge(song->Track(i)->PitchSummaryOfBar(barIndex));
+    }
+    return key;
+}
+
+void REChordAnalyzer::_AnalyseBar(const RESong* song, const RETrackSet& tracks, int barIndex, REBar::REBarChordNameVector& outSuggestions) const
+{
+    RETickSet ticks;
+    song->CalculateTickSet(barIndex, tracks, ticks);
+    if(ticks.empty()) return;
+
+    std::vector<PhraseCursor> cursors;
+    for(unsigned int i=0; i<song->TrackCount(); ++i)
+    {
+        if(!tracks.IsSet(i)) continue;
+
+        const RETrack* track = song->Track(i);
+        for(unsigned int v=0; v<track->VoiceCount(); ++v)
+        {
+            const REPhrase* phrase = track->Voice(v)->Phrase(barIndex);
+            if(phrase && phrase->ChordCount() > 0) {
+                PhraseCursor cursor = {phrase, 0};
+                cursors.push_back(cursor);
+            }
+        }
+    }
+
+    std::string previous;
+    for(uint32_t tick : ticks)
+    {
+        // Chords of a phrase follow each other, so at most one of them sounds at a given tick
+        uint16_t mask = 0;
+        int bass = 128;
+        for(PhraseCursor& cursor : cursors)
+        {
+            const REPhrase* phrase = cursor.phrase;
+            while(cursor.index < phrase->ChordCount() &&
+                  phrase->Chord(cursor.index)->OffsetInTicks() + phrase->Chord(cursor.index)->DurationInTicks() <= tick) {
+                ++cursor.index;
+            }
+            if(cursor.index >= phrase->ChordCount()) continue;
+
+            const REChord* chord = phrase->Chord(cursor.index);
+            if(chord->OffsetInTicks() > tick) continue;
+
+            for(const RENote* note : chord->Notes())
+            {
+                int midi = note->Pitch().midi;
+                mask |= (1 << (midi % 12));
+                if(midi < bass) bass = midi;
+            }
+        }
+
+        REChordName chordName;
+        if(mask == 0 || !Recognize(mask, bass % 12, chordName)) continue;
+
+        std::string name = chordName.ToString();
+        if(name == previous) continue;
+
+        outSuggestions.push_back(REBar::REChordNameTickPair((int)tick, chordName));
+        previous.swap(name);
+    }
+}
@@ -0,0 +1,73 @@
+//
+//  REChordAnalyzer.h
+//  Reflow
+//
+
+#ifndef __Reflow__REChordAnalyzer__
+#define __Reflow__REChordAnalyzer__
+
+#include "RETypes.h"
+#include "REBar.h"
+
+class REChordFormulaCollection;
+
+/** REChordAnalyzer class.
+ *  Suggests chord names by analysing the notes of a song, independently of the chord names inserted by the user.
+ *
+ *  For each tick at which a chord starts in any pitched track, the pitch classes of all the notes sounding at
+ *  that tick are gathered in a 12 bit mask, which is then looked up, rotated to each candidate root, in the
+ *  pitch class index of a REChordFormulaCollection. A new suggestion is only emitted when the recognized
+ *  chord differs from the previous one in the bar.
+ *
+ *  Results are cached per bar along with the merged pitch summaries of the bar over all tracks, so that
+ *  Update only analyses again the bars whose notes changed. Update can be given a budget of bars to
+ *  analyse, letting the caller spread the work of a large song over several idle slices.
+ */
+class REChordAnalyzer
+{
+public:
+    REChordAnalyzer(const REChordFormulaCollection* collection);
+    ~REChordAnalyzer();
+
+public:
+    /** Discard every cached result.
+     */
+    void Reset();
+
+    /** Analyse the bars of song whose notes changed since they were last analysed, at most maxBars of them
+     *  (all of them if maxBars is negative). Bars whose suggestions changed are appended to changedBars.
+     *  Returns true when every bar of the song is up to date.
+     */
+    bool Update(const RESong* song, int maxBars = -1, REIntVector* changedBars = NULL);
+
+    int BarCount() const {return (int)_bars.size();}
+    const REBar::REBarChordNameVector& SuggestedChordNamesOfBar(int barIndex) const;
+    const REChordName* SuggestedChordNameAtTick(int barIndex, int tick) const;
+
+    /** Recognize the chord made of a set of pitch classes (bit n set for pitch class n, 0 being C).
+     *  The bass pitch class is tried first as the root, then the other pitch classes in ascending order.
+     *  Returns false if no formula of the collection matches.
+     */
+    bool Recognize(uint16_t pitchClassMask, int bassPitchClass, REChordName& outChordName) const;
+
+private:
+    struct BarAnalysis
+    {
+        bool valid;
+        REPitchSummary key;
+        REBar::REBarChordNameVector suggestions;
+
+        BarAnalysis() : valid(false) {}
+    };
+    typedef std::vector<BarAnalysis> BarAnalysisVector;
+
+private:
+    REPitchSummary _KeyOfBar(const RESong* song, const RETrackSet& tracks, int barIndex) const;
+    void _AnalyseBar(const RESong* song, const RETrackSet& tracks, int barIndex, REBar::REBarChordNameVector& outSuggestions) const;
+
+private:
+    const REChordFormulaCollection* _collection;
+    BarAnalysisVector _bars;
+};
+
+#endif /* defined(__Reflow__REChordAnalyzer__) */
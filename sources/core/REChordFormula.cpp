@@ -10,6 +10,8 @@
 #include "REChordName.h"
 #include "REOutputStream.h"
 #include "REInputStream.h"
+#include "REFunctions.h"
+#include "REException.h"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
@@ -47,6 +49,7 @@ bool REChordFormula::IsValid() const
 bool REChordFormula::Parse(const std::string& rawFormula_)
 {
     _intervalCount = 0;
+    _optionalDegrees = 0;
     std::string rawFormula = rawFormula_;
     _rawFormula = rawFormula;
     
@@ -186,6 +189,7 @@ REChordFormula::REChordFormula(const REChordFormula& rhs)
 REChordFormula& REChordFormula::operator=(const REChordFormula& rhs)
 {
     _intervalCount = rhs._intervalCount;
+    _optionalDegrees = rhs._optionalDegrees;
     memcpy(_intervals, rhs._intervals, sizeof(rhs._intervals));
     
     _rawFormula = rhs._rawFormula;
@@ -209,6 +213,9 @@ void REChordFormula::DecodeFrom(REInputStream& decoder)
     _rawFormula = decoder.ReadString();
     _symbol = decoder.ReadString();
     _intervalCount = decoder.ReadInt8();
+    if(_intervalCount < 0 || _intervalCount > 6) {
+        REThrow("Invalid chord formula");
+    }
     _optionalDegrees = decoder.ReadInt8();
     for(int i=0; i<_intervalCount; ++i) {
         _intervals[i].DecodeFrom(decoder);
@@ -225,6 +232,30 @@ void REChordFormula::CalculatePitchesWithRootNote(const REPitchClass& rootNote,
     }
 }
 
+uint16_t REChordFormula::PitchClassMask() const
+{
+    if(!IsValid()) return 0;
+    
+    uint16_t mask = 1;
+    for(int i=0; i<_intervalCount; ++i) {
+        mask |= (1 << Reflow::Wrap12(_intervals[i].ChromaticStep()));
+    }
+    return mask;
+}
+
+uint16_t REChordFormula::RequiredPitchClassMask() const
+{
+    if(!IsValid()) return 0;
+    
+    uint16_t mask = 1;
+    for(int i=0; i<_intervalCount; ++i) {
+        if(0 == (_optionalDegrees & (1 << i))) {
+            mask |= (1 << Reflow::Wrap12(_intervals[i].ChromaticStep()));
+        }
+    }
+    return mask;
+}
+
 void REChordFormula::SetSymbol(const std::string& symbol)
 {
     _symbol = symbol;
@@ -30,6 +30,12 @@ public:
     
     void CalculatePitchesWithRootNote(const REPitchClass& rootNote, REPitchClassVector& pitches) const;
     
+    /** Set of the chromatic degrees relative to the root (bit 0), octaves folded in 12 bits */
+    uint16_t PitchClassMask() const;
+    
+    /** Same as PitchClassMask, without the optional degrees */
+    uint16_t RequiredPitchClassMask() const;
+    
     void SetSymbol(const std::string& symbol);
     const std::string& Symbol() const;
     
@@ -7,6 +7,8 @@
 //
 
 #include "REChordFormulaCollection.h"
+#include "REOutputStream.h"
+#include "REInputStream.h"
 
 #include <cassert>
 #include <sstream>
@@ -18,7 +20,13 @@ using std::vector;
 using std::string;
 using namespace boost;
 
+namespace {
+    const char CacheMagic[4] = {'R', 'E', 'C', 'H'};
+    const uint32_t CacheVersion = 1;
+}
+
 REChordFormulaCollection::REChordFormulaCollection()
+: _indexByPitchClassMask(4096, -1)
 {}
 
 REChordFormulaCollection::~REChordFormulaCollection()
@@ -29,6 +37,10 @@ REChordFormulaCollection::~REChordFormulaCollection()
 void REChordFormulaCollection::Clear()
 {
     _chords.clear();
+    _indexById.clear();
+    _indexBySymbol.clear();
+    _indexByRawFormula.clear();
+    _indexByPitchClassMask.assign(4096, -1);
 }
 
 bool REChordFormulaCollection::LoadChordsXML(const char *data, int length)
@@ -80,7 +92,92 @@ void REChordFormulaCollection::OnStartElement(const REXMLParser& parser,
     
     // Add formula to collection
     entry.formula = REChordFormula(formula, entry.symbols[0]);
+    _AddEntry(entry);
+}
+
+void REChordFormulaCollection::_AddEntry(const REChordFormulaCollectionEntry& entry)
+{
+    int idx = (int)_chords.size();
     _chords.push_back(entry);
+    
+    // Lookups return the first matching entry, as the linear scans did
+    _indexById.insert(std::make_pair(entry.formulaId, idx));
+    _indexByRawFormula.insert(std::make_pair(entry.rawFormula, idx));
+    for(const std::string& symbol : entry.symbols) {
+        _indexBySymbol.insert(std::make_pair(symbol, idx));
+    }
+    
+    // Every combination of the optional degrees names the same chord
+    uint16_t required = entry.formula.RequiredPitchClassMask();
+    uint16_t optional = entry.formula.PitchClassMask() & ~required;
+    if(required == 0) return;
+    
+    uint16_t subset = optional;
+    while(true)
+    {
+        int16_t& slot = _indexByPitchClassMask[required | subset];
+        if(slot == -1) slot = idx;
+        
+        if(subset == 0) break;
+        subset = (subset - 1) & optional;
+    }
+}
+
+void REChordFormulaCollection::WriteCache(REOutputStream& coder, uint64_t sourceChecksum) const
+{
+    coder.Write(CacheMagic, 4);
+    coder.WriteUInt32(CacheVersion);
+    coder.WriteUInt32((uint32_t)(sourceChecksum >> 32));
+    coder.WriteUInt32((uint32_t)(sourceChecksum & 0xFFFFFFFF));
+    
+    coder.WriteUInt32(_chords.size());
+    for(const REChordFormulaCollectionEntry& entry : _chords)
+    {
+        coder.WriteString(entry.formulaId);
+        coder.WriteString(entry.rawFormula);
+        coder.WriteString(entry.type);
+        coder.WriteString(entry.name);
+        coder.WriteUInt32(entry.symbols.size());
+        for(const std::string& symbol : entry.symbols) {
+            coder.WriteString(symbol);
+        }
+        entry.formula.EncodeTo(coder);
+    }
+}
+
+bool REChordFormulaCollection::ReadCache(REInputStream& decoder, uint64_t sourceChecksum)
+{
+    Clear();
+    try
+    {
+        if(decoder.ReadBytes(4) != std::string(CacheMagic, 4)) return false;
+        if(decoder.ReadUInt32() != CacheVersion) return false;
+        
+        uint64_t checksum = decoder.ReadUInt32();
+        checksum = (checksum << 32) | decoder.ReadUInt32();
+        if(checksum != sourceChecksum) return false;
+        
+        uint32_t count = decoder.ReadUInt32();
+        for(uint32_t i=0; i<count; ++i)
+        {
+            REChordFormulaCollectionEntry entry;
+            entry.formulaId = decoder.ReadString();
+            entry.rawFormula = decoder.ReadString();
+            entry.type = decoder.ReadString();
+            entry.name = decoder.ReadString();
+            uint32_t symbolCount = decoder.ReadUInt32();
+            for(uint32_t j=0; j<symbolCount; ++j) {
+                entry.symbols.push_back(decoder.ReadString());
+            }
+            entry.formula.DecodeFrom(decoder);
+            _AddEntry(entry);
+        }
+    }
+    catch(std::exception&) {
+        Clear();
+        return false;
+    }
+    return true;
 }
 
 int REChordFormulaCollection::EntryCount() const
@@ -96,53 +193,37 @@ const REChordFormulaCollectionEntry* REChordFormulaCollection::Entry(int idx) co
     return NULL;
 }
 
+const REChordFormulaCollectionEntry* REChordFormulaCollection::_Find(const std::unordered_map<std::string, int>& index, const std::string& key) const
+{
+    auto it = index.find(key);
+    return it != index.end() ? &_chords[it->second] : NULL;
+}
+
 const REChordFormulaCollectionEntry* REChordFormulaCollection::EntryWithId(const std::string& chordId) const
 {
-    REChordFormulaCollectionEntryVector::const_iterator it = _chords.begin();
-    for(; it != _chords.end(); ++it)
-    {
-        const REChordFormulaCollectionEntry* entry = &(*it);
-        if(entry->formulaId == chordId) {
-            return entry;
-        }
-    }
-    return NULL;
+    return _Find(_indexById, chordId);
 }
 
 const REChordFormulaCollectionEntry* REChordFormulaCollection::EntryWithSymbol(const std::string& symbol) const
 {
-    REChordFormulaCollectionEntryVector::const_iterator it = _chords.begin();
-    for(; it != _chords.end(); ++it)
-    {
-        const REChordFormulaCollectionEntry* entry = &(*it);
-        if(std::find(entry->symbols.begin(), entry->symbols.end(), symbol) != entry->symbols.end())
-        {
-            return entry;
-        }
-    }
-    return NULL;
+    return _Find(_indexBySymbol, symbol);
 }
 
 const REChordFormulaCollectionEntry* REChordFormulaCollection::EntryWithRawFormula(const std::string& rawFormula) const
 {
-    REChordFormulaCollectionEntryVector::const_iterator it = _chords.begin();
-    for(; it != _chords.end(); ++it)
-    {
-        const REChordFormulaCollectionEntry* entry = &(*it);
-        REPrintf("(%s - %s)\n", entry->rawFormula.c_str(), rawFormula.c_str());
-        if(entry->rawFormula == rawFormula) {
-            return entry;
-        }
-    }
-    return NULL;
+    return _Find(_indexByRawFormula, rawFormula);
+}
+
+const REChordFormulaCollectionEntry* REChordFormulaCollection::EntryWithPitchClassMask(uint16_t mask) const
+{
+    int idx = _indexByPitchClassMask[mask & 0x0FFF];
+    return idx >= 0 ? &_chords[idx] : NULL;
 }
 
 int REChordFormulaCollection::IndexOfEntry(const REChordFormulaCollectionEntry* entry) const
 {
-    for(int i=0; i<_chords.size(); ++i) {
-        if(&_chords[i] == entry) {
-            return i;
-        }
+    if(_chords.empty() || entry < &_chords.front() || entry > &_chords.back()) {
+        return -1;
     }
-    return -1;
+    return (int)(entry - &_chords.front());
 }
@@ -14,6 +14,8 @@
 #include "REChordFormula.h"
 #include "REXMLParser.h"
 
+#include <unordered_map>
+
 
 class REChordFormulaCollectionEntry
 {
@@ -52,6 +54,12 @@ public:
     
     bool LoadChordsXML(const char* data, int length);
     
+    /** Binary image of the parsed collection, tagged with the checksum of the XML it was built from.
+     *  ReadCache fails if the checksum or the cache format differ.
+     */
+    void WriteCache(REOutputStream& coder, uint64_t sourceChecksum) const;
+    bool ReadCache(REInputStream& decoder, uint64_t sourceChecksum);
+    
     void Clear();
     
     int EntryCount() const;
@@ -61,10 +69,23 @@ public:
     const REChordFormulaCollectionEntry* EntryWithRawFormula(const std::string& rawFormula) const;
     int IndexOfEntry(const REChordFormulaCollectionEntry* entry) const;
     
+    /** First entry (in collection order) whose formula matches a set of pitch classes relative to
+     *  the root (see REChordFormula::PitchClassMask). Optional degrees may be present or not.
+     */
+    const REChordFormulaCollectionEntry* EntryWithPitchClassMask(uint16_t mask) const;
+    
     static REChordFormulaCollection* BuiltinCollection();
     
+private:
+    void _AddEntry(const REChordFormulaCollectionEntry& entry);
+    const REChordFormulaCollectionEntry* _Find(const std::unordered_map<std::string, int>& index, const std::string& key) const;
+    
 private:
     REChordFormulaCollectionEntryVector _chords;
+    std::unordered_map<std::string, int> _indexById;
+    std::unordered_map<std::string, int> _indexBySymbol;
+    std::unordered_map<std::string, int> _indexByRawFormula;
+    std::vector<int16_t> _indexByPitchClassMask;      // 4096 entries, -1 when no formula matches
     static REChordFormulaCollection* _builtinCollection;
     
 private:
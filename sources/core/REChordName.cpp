@@ -11,12 +11,12 @@
 #include "REInputStream.h"
 
 REChordName::REChordName()
-: _root(0,0)
+: _root(0,0), _inversion(0)
 {
 }
 
 REChordName::REChordName(const REPitchClass& root, const REChordFormula& formula)
-: _root(root), _formula(formula)
+: _root(root), _formula(formula), _inversion(0)
 {
 }
 
@@ -0,0 +1,640 @@
+//
+//  REChunkedArchive.cpp
+//  Reflow
+//
+
+#include "REChunkedArchive.h"
+#include "RECompression.h"
+#include "REInputStream.h"
+#include "REOutputStream.h"
+#include "RESong.h"
+#include "REBar.h"
+#include "RETrack.h"
+#include "REScoreSettings.h"
+#include "REFunctions.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+const char Magic[4] = {'F', 'L', 'O', '2'};
+const uint32_t HeaderSize = 16;         // magic, io version, table offset, reserved
+const uint32_t TableOffsetPosition = 8;
+const uint32_t EntrySize = 28;
+
+void AppendUInt16(std::string* data, uint16_t v)
+{
+    data->push_back((char)(v & 0xFF));
+    data->push_back((char)((v >> 8) & 0xFF));
+}
+
+void AppendUInt32(std::string* data, uint32_t v)
+{
+    for(int i=0; i<4; ++i) {
+        data->push_back((char)((v >> (8*i)) & 0xFF));
+    }
+}
+
+void StoreUInt32(char* dst, uint32_t v)
+{
+    for(int i=0; i<4; ++i) {
+        dst[i] = (char)((v >> (8*i)) & 0xFF);
+    }
+}
+
+}
+
+REChunkedArchive::REChunkedArchive()
+: _compression(LZ4Compression), _threadCount(0), _version(REFLOW_IO_VERSION), _tableOffset(0), _fileSize(0), _writtenChunkCount(0)
+{
+}
+
+REChunkedArchive::~REChunkedArchive()
+{
+}
+
+void REChunkedArchive::Reset()
+{
+    _entries.clear();
+    _filename.clear();
+    _tableOffset = 0;
+    _fileSize = 0;
+}
+
+bool REChunkedArchive::IsChunkedArchive(const char* data, unsigned long size)
+{
+    return size >= HeaderSize && 0 == memcmp(data, Magic, sizeof(Magic));
+}
+
+uint64_t REChunkedArchive::_Checksum(const std::string& data)
+{
+    return Reflow::Checksum64(data.data(), data.size());
+}
+
+void REChunkedArchive::_RunParallel(int count, const std::function<void(int)>& work) const
+{
+    int threadCount = _threadCount;
+    if(threadCount <= 0) {
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, count);
+
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for(int i = next++; i < count; i = next++) {
+            work(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(int i=1; i<threadCount; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+const REChunkedArchive::Entry* REChunkedArchive::_FindEntry(uint16_t type, uint32_t index) const
+{
+    for(const Entry& entry : _entries) {
+        if(entry.type == type && entry.index == index) return &entry;
+    }
+    return NULL;
+}
+
+#pragma mark -
+#pragma mark Reading
+
+bool REChunkedArchive::Read(const std::string& filename, RESong& song)
+{
+    REMappedFileInputStream stream;
+    if(!stream.Open(filename)) {
+        _error = "Failed to open " + filename;
+        return false;
+    }
+
+    if(!Read(stream, song)) {
+        return false;
+    }
+
+    // Remember the table so the next save to this file can be incremental
+    _filename = filename;
+    _fileSize = (uint32_t)stream.Size();
+    return true;
+}
+
+bool REChunkedArchive::Read(REInputStream& stream, RESong& song)
+{
+    Reset();
+    return _ReadTable(stream) && _DecodeSong(stream, song);
+}
+
+bool REChunkedArchive::_ReadTable(REInputStream& stream)
+{
+    _error.clear();
+    try
+    {
+        stream.SetEndianness(Reflow::LittleEndian);
+        stream.SeekTo(0);
+        if(stream.ReadBytes(sizeof(Magic)) != std::string(Magic, sizeof(Magic))) {
+            _error = "Not a chunked Reflow file";
+            return false;
+        }
+
+        _version = stream.ReadUInt32();
+        if(_version > REFLOW_IO_VERSION) {
+            _error = "File was created with a more recent file version";
+            return false;
+        }
+
+        _tableOffset = stream.ReadUInt32();
+        stream.SeekTo(_tableOffset);
+
+        uint32_t count = stream.ReadUInt32();
+        if((unsigned long)count * EntrySize > stream.Size() - stream.Pos()) {
+            _error = "Corrupted table of contents";
+            return false;
+        }
+
+        _entries.resize(count);
+        for(Entry& entry : _entries)
+        {
+            entry.type = stream.ReadUInt16();
+            entry.compression = stream.ReadUInt16();
+            entry.index = stream.ReadUInt32();
+            entry.offset = stream.ReadUInt32();
+            entry.storedSize = stream.ReadUInt32();
+            entry.rawSize = stream.ReadUInt32();
+            uint64_t low = stream.ReadUInt32();
+            uint64_t high = stream.ReadUInt32();
+            entry.checksum = low | (high << 32);
+
+            if((unsigned long)entry.offset + entry.storedSize > _tableOffset) {
+                _error = "Corrupted table of contents";
+                return false;
+            }
+        }
+    }
+    catch(std::exception& e) {
+        _error = e.what();
+        return false;
+    }
+    return true;
+}
+
+bool REChunkedArchive::_ReadChunk(REInputStream& stream, const Entry& entry, std::string* raw) const
+{
+    // Mapped and memory streams are decoded in place
+    std::string stored;
+    const char* data = stream.Data();
+    if(data) {
+        data += entry.offset;
+    }
+    else {
+        stream.SeekTo(entry.offset);
+        stored.resize(entry.storedSize);
+        if(entry.storedSize) stream.Read(&stored[0], entry.storedSize);
+        data = stored.data();
+    }
+
+    if(entry.compression == LZ4Compression)
+    {
+        raw->resize(entry.rawSize);
+        if(!RECompression::DecompressLZ4(data, entry.storedSize, entry.rawSize ? &(*raw)[0] : NULL, entry.rawSize)) {
+            return false;
+        }
+    }
+    else if(entry.compression == NoCompression && entry.storedSize == entry.rawSize) {
+        raw->assign(data, entry.storedSize);
+    }
+    else {
+        return false;
+    }
+
+    return _Checksum(*raw) == entry.checksum;
+}
+
+bool REChunkedArchive::_DecodeSong(REInputStream& stream, RESong& song)
+{
+    song.Clear();
+
+    try
+    {
+        std::string raw;
+        auto openChunk = [&](uint16_t type, uint32_t index) -> bool {
+            const Entry* entry = _FindEntry(type, index);
+            if(entry == NULL || !_ReadChunk(stream, *entry, &raw)) {
+                _error = "Missing or corrupted chunk";
+                return false;
+            }
+            return true;
+        };
+
+        // Song properties
+        if(!openChunk(SongChunk, 0)) return false;
+        REConstBufferInputStream songDecoder(raw.data(), raw.size());
+        songDecoder.SetVersion(_version);
+
+        song._title = songDecoder.ReadString();
+        song._subtitle = songDecoder.ReadString();
+        song._artist = songDecoder.ReadString();
+        song._album = songDecoder.ReadString();
+        song._musicBy = songDecoder.ReadString();
+        song._lyricsBy = songDecoder.ReadString();
+        song._transcriber = songDecoder.ReadString();
+        song._copyright = songDecoder.ReadString();
+        song._notice = songDecoder.ReadString();
+        song._defaultTempo = songDecoder.ReadInt16();
+        song._tempoTimeline.DecodeFrom(songDecoder);
+        uint32_t barCount = songDecoder.ReadUInt32();
+        uint32_t trackCount = songDecoder.ReadUInt32();
+
+        // Bars
+        for(uint32_t block = 0; block * BarsPerChunk < barCount; ++block)
+        {
+            if(!openChunk(BarsChunk, block)) return false;
+            REConstBufferInputStream decoder(raw.data(), raw.size());
+            decoder.SetVersion(_version);
+
+            uint32_t count = decoder.ReadUInt32();
+            for(uint32_t i=0; i<count; ++i)
+            {
+                REBar* bar = new REBar;
+                bar->_index = song._bars.size();
+                bar->_parent = &song;
+                song._bars.push_back(bar);
+                bar->DecodeFrom(decoder);
+            }
+        }
+
+        if(song._bars.size() != barCount) {
+            _error = "Unexpected bar count";
+            return false;
+        }
+
+        if(trackCount > _entries.size()) {
+            _error = "Unexpected track count";
+            return false;
+        }
+
+        // Tracks are decoded independently, then attached in order.
+        // Streams without in-memory data are shared by the workers, so reading from them is serialized.
+        std::vector<RETrack*> tracks(trackCount, NULL);
+        std::vector<std::string> errors(trackCount);
+        std::mutex streamMutex;
+        bool sharedStream = (stream.Data() == NULL);
+
+        _RunParallel((int)trackCount, [&](int i) {
+            std::string trackRaw;
+            bool ok = false;
+            {
+                std::unique_lock<std::mutex> lock(streamMutex, std::defer_lock);
+                if(sharedStream) lock.lock();
+                const Entry* entry = _FindEntry(TrackChunk, i);
+                ok = (entry != NULL && _ReadChunk(stream, *entry, &trackRaw));
+            }
+            if(!ok) {
+                errors[i] = "Missing or corrupted chunk";
+                return;
+            }
+
+            RETrack* track = new RETrack;
+            track->_index = i;
+            track->_parent = &song;
+            tracks[i] = track;
+            try {
+                REConstBufferInputStream decoder(trackRaw.data(), trackRaw.size());
+                decoder.SetVersion(_version);
+                track->DecodeFrom(decoder);
+            }
+            catch(std::exception& e) {
+                errors[i] = e.what();
+            }
+        });
+
+        for(uint32_t i=0; i<trackCount; ++i) {
+            if(tracks[i]) song._tracks.push_back(tracks[i]);
+        }
+        for(const std::string& error : errors) {
+            if(!error.empty()) {
+                _error = error;
+                return false;
+            }
+        }
+
+        // Scores
+        if(!openChunk(ScoresChunk, 0)) return false;
+        REConstBufferInputStream scoresDecoder(raw.data(), raw.size());
+        scoresDecoder.SetVersion(_version);
+
+        uint32_t scoreCount = scoresDecoder.ReadUInt32();
+        for(uint32_t i=0; i<scoreCount; ++i)
+        {
+            REScoreSettings* score = new REScoreSettings;
+            score->_index = i;
+            song._scores.push_back(score);
+            score->DecodeFrom(scoresDecoder);
+        }
+    }
+    catch(std::exception& e) {
+        _error = e.what();
+        return false;
+    }
+
+    song.Refresh();
+    return true;
+}
+
+#pragma mark -
+#pragma mark Writing
+
+void REChunkedArchive::_EncodeChunks(const RESong& song, ChunkVector* chunks) const
+{
+    REBufferOutputStream coder;
+    auto addChunk = [&](uint16_t type, uint32_t index) {
+        Chunk chunk;
+        chunk.type = type;
+        chunk.index = index;
+        chunk.raw.assign(coder.Data(), coder.Pos());
+        chunk.checksum = _Checksum(chunk.raw);
+        chunks->push_back(chunk);
+        coder.SeekTo(0);
+    };
+
+    // Song properties
+    coder.WriteString(song._title);
+    coder.WriteString(song._subtitle);
+    coder.WriteString(song._artist);
+    coder.WriteString(song._album);
+    coder.WriteString(song._musicBy);
+    coder.WriteString(song._lyricsBy);
+    coder.WriteString(song._transcriber);
+    coder.WriteString(song._copyright);
+    coder.WriteString(song._notice);
+    coder.WriteInt16(song._defaultTempo);
+    song._tempoTimeline.EncodeTo(coder);
+    coder.WriteUInt32(song.BarCount());
+    coder.WriteUInt32(song.TrackCount());
+    addChunk(SongChunk, 0);
+
+    // Bars
+    for(uint32_t first = 0, block = 0; first < song.BarCount(); first += BarsPerChunk, ++block)
+    {
+        uint32_t last = std::min(first + BarsPerChunk, song.BarCount());
+        coder.WriteUInt32(last - first);
+        for(uint32_t i=first; i<last; ++i) {
+            song._bars[i]->EncodeTo(coder);
+        }
+        addChunk(BarsChunk, block);
+    }
+
+    // Tracks, each one with its own coder
+    ChunkVector tracks(song.TrackCount());
+    _RunParallel((int)song.TrackCount(), [&](int i) {
+        REBufferOutputStream trackCoder;
+        song._tracks[i]->EncodeTo(trackCoder);
+
+        Chunk& chunk = tracks[i];
+        chunk.type = TrackChunk;
+        chunk.index = i;
+        chunk.raw.assign(trackCoder.Data(), trackCoder.Pos());
+        chunk.checksum = _Checksum(chunk.raw);
+    });
+    chunks->insert(chunks->end(), std::make_move_iterator(tracks.begin()), std::make_move_iterator(tracks.end()));
+
+    // Scores
+    coder.WriteUInt32(song.ScoreCount());
+    for(const REScoreSettings* score : song._scores) {
+        score->EncodeTo(coder);
+    }
+    addChunk(ScoresChunk, 0);
+}
+
+REChunkedArchive::Entry REChunkedArchive::_StoreChunk(const Chunk& chunk, uint32_t offset, std::string* stored) const
+{
+    Entry entry;
+    entry.type = chunk.type;
+    entry.index = chunk.index;
+    entry.offset = offset;
+    entry.rawSize = (uint32_t)chunk.raw.size();
+    entry.checksum = chunk.checksum;
+    entry.compression = NoCompression;
+
+    // Keep chunks raw when compression does not pay off
+    if(_compression == LZ4Compression && !chunk.raw.empty())
+    {
+        std::string compressed;
+        RECompression::CompressLZ4(chunk.raw.data(), chunk.raw.size(), &compressed);
+        if(compressed.size() < chunk.raw.size()) {
+            entry.compression = LZ4Compression;
+            stored->swap(compressed);
+        }
+    }
+
+    if(entry.compression == NoCompression) {
+        *stored = chunk.raw;
+    }
+    entry.storedSize = (uint32_t)stored->size();
+    return entry;
+}
+
+void REChunkedArchive::_StoreChunks(const ChunkVector& chunks, const std::vector<int>& indices, EntryVector* entries, std::vector<std::string>* stored) const
+{
+    // Compression is the costly part: chunks are stored in parallel, offsets are left to the caller
+    entries->resize(indices.size());
+    stored->resize(indices.size());
+    _RunParallel((int)indices.size(), [&](int i) {
+        (*entries)[i] = _StoreChunk(chunks[indices[i]], 0, &(*stored)[i]);
+    });
+}
+
+uint32_t REChunkedArchive::_EncodeFull(const ChunkVector& chunks, std::string* data, EntryVector* entries) const
+{
+    data->assign(HeaderSize, '\0');
+    memcpy(&(*data)[0], Magic, sizeof(Magic));
+    StoreUInt32(&(*data)[4], REFLOW_IO_VERSION);
+
+    std::vector<int> indices(chunks.size());
+    for(unsigned int i=0; i<chunks.size(); ++i) indices[i] = i;
+
+    std::vector<std::string> stored;
+    _StoreChunks(chunks, indices, entries, &stored);
+    for(unsigned int i=0; i<chunks.size(); ++i)
+    {
+        (*entries)[i].offset = (uint32_t)data->size();
+        *data += stored[i];
+    }
+
+    uint32_t tableOffset = (uint32_t)data->size();
+    StoreUInt32(&(*data)[TableOffsetPosition], tableOffset);
+    _EncodeTable(*entries, data);
+    return tableOffset;
+}
+
+void REChunkedArchive::_EncodeTable(const EntryVector& entries, std::string* table)
+{
+    AppendUInt32(table, (uint32_t)entries.size());
+    for(const Entry& entry : entries)
+    {
+        AppendUInt16(table, entry.type);
+        AppendUInt16(table, entry.compression);
+        AppendUInt32(table, entry.index);
+        AppendUInt32(table, entry.offset);
+        AppendUInt32(table, entry.storedSize);
+        AppendUInt32(table, entry.rawSize);
+        AppendUInt32(table, (uint32_t)(entry.checksum & 0xFFFFFFFF));
+        AppendUInt32(table, (uint32_t)(entry.checksum >> 32));
+    }
+}
+
+bool REChunkedArchive::Write(const RESong& song, const std::string& filename)
+{
+    _error.clear();
+
+    ChunkVector chunks;
+    _EncodeChunks(song, &chunks);
+
+    if(filename == _filename && !_entries.empty() && _FileMatchesTable(filename)) {
+        if(_WriteAppend(chunks, filename)) return true;
+    }
+    return _WriteFull(chunks, filename);
+}
+
+void REChunkedArchive::Encode(const RESong& song, std::string* data) const
+{
+    ChunkVector chunks;
+    _EncodeChunks(song, &chunks);
+
+    EntryVector entries;
+    _EncodeFull(chunks, data, &entries);
+}
+
+bool REChunkedArchive::_FileMatchesTable(const std::string& filename) const
+{
+    // Make sure the file was not replaced since we last read or wrote it
+    FILE* file = fopen(filename.c_str(), "rb");
+    if(file == NULL) return false;
+
+    char header[HeaderSize];
+    bool ok = (1 == fread(header, HeaderSize, 1, file));
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+
+    if(!ok || !IsChunkedArchive(header, HeaderSize)) return false;
+
+    uint32_t tableOffset = 0;
+    for(int i=0; i<4; ++i) {
+        tableOffset |= (uint32_t)(uint8_t)header[TableOffsetPosition + i] << (8*i);
+    }
+    return tableOffset == _tableOffset && size == (long)_fileSize;
+}
+
+bool REChunkedArchive::_WriteFull(const ChunkVector& chunks, const std::string& filename)
+{
+    std::string data;
+    EntryVector entries;
+    uint32_t tableOffset = _EncodeFull(chunks, &data, &entries);
+
+    FILE* file = fopen(filename.c_str(), "wb");
+    if(file == NULL) {
+        _error = "Failed to open " + filename + " for writing";
+        Reset();
+        return false;
+    }
+    bool ok = (1 == fwrite(data.data(), data.size(), 1, file));
+    ok = (0 == fclose(file)) && ok;
+    if(!ok) {
+        _error = "Failed to write " + filename;
+        Reset();
+        return false;
+    }
+
+    _entries.swap(entries);
+    _filename = filename;
+    _version = REFLOW_IO_VERSION;
+    _tableOffset = tableOffset;
+    _fileSize = (uint32_t)data.size();
+    _writtenChunkCount = (unsigned int)chunks.size();
+    return true;
+}
+
+bool REChunkedArchive::_WriteAppend(const ChunkVector& chunks, const std::string& filename)
+{
+    // Chunks are only ever appended: until the header is patched, the file still reads as before
+    if(_version != REFLOW_IO_VERSION) return false;
+
+    EntryVector entries(chunks.size());
+    std::vector<int> changed;
+    for(unsigned int i=0; i<chunks.size(); ++i)
+    {
+        const Chunk& chunk = chunks[i];
+        const Entry* previous = _FindEntry(chunk.type, chunk.index);
+        if(previous && previous->rawSize == chunk.raw.size() && previous->checksum == chunk.checksum) {
+            entries[i] = *previous;
+        }
+        else {
+            changed.push_back(i);
+        }
+    }
+
+    EntryVector changedEntries;
+    std::vector<std::string> stored;
+    _StoreChunks(chunks, changed, &changedEntries, &stored);
+
+    std::string appended;
+    unsigned int writtenCount = (unsigned int)changed.size();
+    for(unsigned int i=0; i<changed.size(); ++i)
+    {
+        changedEntries[i].offset = _fileSize + (uint32_t)appended.size();
+        entries[changed[i]] = changedEntries[i];
+        appended += stored[i];
+    }
+
+    unsigned long liveBytes = HeaderSize;
+    for(const Entry& entry : entries) {
+        liveBytes += entry.storedSize;
+    }
+
+    if(writtenCount == 0 && entries.size() == _entries.size()) {
+        _writtenChunkCount = 0;
+        return true;
+    }
+
+    uint32_t tableOffset = _fileSize + (uint32_t)appended.size();
+    _EncodeTable(entries, &appended);
+    uint32_t fileSize = _fileSize + (uint32_t)appended.size();
+    liveBytes += appended.size() - (tableOffset - _fileSize);
+
+    // Compact once dead chunks and tables outweigh live data
+    if(liveBytes * 2 < fileSize) {
+        return false;
+    }
+
+    FILE* file = fopen(filename.c_str(), "r+b");
+    if(file == NULL) return false;
+
+    char offsetBytes[4];
+    StoreUInt32(offsetBytes, tableOffset);
+
+    bool ok = (0 == fseek(file, _fileSize, SEEK_SET));
+    ok = ok && (1 == fwrite(appended.data(), appended.size(), 1, file));
+    ok = ok && (0 == fflush(file));
+    ok = ok && (0 == fseek(file, TableOffsetPosition, SEEK_SET));
+    ok = ok && (1 == fwrite(offsetBytes, sizeof(offsetBytes), 1, file));
+    ok = (0 == fclose(file)) && ok;
+    if(!ok) return false;
+
+    _entries.swap(entries);
+    _tableOffset = tableOffset;
+    _fileSize = fileSize;
+    _writtenChunkCount = writtenCount;
+    return true;
+}
@@ -0,0 +1,124 @@
+//
+//  REChunkedArchive.h
+//  Reflow
+//
+
+#ifndef __Reflow__REChunkedArchive__
+#define __Reflow__REChunkedArchive__
+
+#include "RETypes.h"
+
+/** REChunkedArchive class.
+ *  Second generation .flow container. The song is stored as independent chunks (song properties,
+ *  blocks of bars, one chunk per track, score settings) listed in a table of contents, each chunk
+ *  being optionally LZ4 compressed.
+ *
+ *  Track chunks are encoded, compressed, decompressed and decoded on a pool of threads, each track
+ *  on its own; results are merged in track order so the output does not depend on the thread count.
+ *
+ *  The archive remembers the table of the file it last read or wrote: saving again to the same file
+ *  only appends the chunks whose contents changed, followed by a new table, and then switches the
+ *  header over to it. The file is compacted by a full rewrite once it holds more dead bytes than live ones.
+ */
+class REChunkedArchive
+{
+public:
+    enum ChunkType
+    {
+        SongChunk = 1,
+        BarsChunk = 2,
+        TrackChunk = 3,
+        ScoresChunk = 4
+    };
+
+    enum Compression
+    {
+        NoCompression = 0,
+        LZ4Compression = 1
+    };
+
+    struct Entry
+    {
+        uint16_t type;
+        uint16_t compression;
+        uint32_t index;
+        uint32_t offset;
+        uint32_t storedSize;
+        uint32_t rawSize;
+        uint64_t checksum;
+    };
+    typedef std::vector<Entry> EntryVector;
+
+    static const unsigned int BarsPerChunk = 64;
+
+public:
+    REChunkedArchive();
+    ~REChunkedArchive();
+
+public:
+    void SetCompression(Compression compression) {_compression = compression;}
+    Compression ChunkCompression() const {return _compression;}
+
+    /** Zero means one thread per hardware core */
+    void SetThreadCount(int n) {_threadCount = std::max(0, n);}
+    int ThreadCount() const {return _threadCount;}
+
+    static bool IsChunkedArchive(const char* data, unsigned long size);
+
+    bool Read(const std::string& filename, RESong& song);
+    bool Read(REInputStream& stream, RESong& song);
+
+    bool Write(const RESong& song, const std::string& filename);
+
+    /** Encodes a complete archive in memory, leaving the table of the last file untouched */
+    void Encode(const RESong& song, std::string* data) const;
+
+    /** Forgets the table of the last file so the next Write is a full one */
+    void Reset();
+
+public:
+    const EntryVector& Entries() const {return _entries;}
+    unsigned int WrittenChunkCount() const {return _writtenChunkCount;}
+    const std::string& Error() const {return _error;}
+
+private:
+    struct Chunk
+    {
+        uint16_t type;
+        uint32_t index;
+        std::string raw;
+        uint64_t checksum;
+    };
+    typedef std::vector<Chunk> ChunkVector;
+
+    bool _ReadTable(REInputStream& stream);
+    bool _ReadChunk(REInputStream& stream, const Entry& entry, std::string* raw) const;
+    const Entry* _FindEntry(uint16_t type, uint32_t index) const;
+    bool _DecodeSong(REInputStream& stream, RESong& song);
+
+    void _EncodeChunks(const RESong& song, ChunkVector* chunks) const;
+    Entry _StoreChunk(const Chunk& chunk, uint32_t offset, std::string* stored) const;
+    void _StoreChunks(const ChunkVector& chunks, const std::vector<int>& indices, EntryVector* entries, std::vector<std::string>* stored) const;
+    uint32_t _EncodeFull(const ChunkVector& chunks, std::string* data, EntryVector* entries) const;
+    bool _FileMatchesTable(const std::string& filename) const;
+    bool _WriteFull(const ChunkVector& chunks, const std::string& filename);
+    bool _WriteAppend(const ChunkVector& chunks, const std::string& filename);
+
+    void _RunParallel(int count, const std::function<void(int)>& work) const;
+
+    static uint64_t _Checksum(const std::string& data);
+    static void _EncodeTable(const EntryVector& entries, std::string* table);
+
+private:
+    Compression _compression;
+    int _threadCount;
+    EntryVector _entries;
+    std::string _filename;
+    uint32_t _version;
+    uint32_t _tableOffset;
+    uint32_t _fileSize;
+    unsigned int _writtenChunkCount;
+    std::string _error;
+};
+
+#endif /* defined(__Reflow__REChunkedArchive__) */
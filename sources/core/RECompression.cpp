@@ -0,0 +1,153 @@
+//
+//  RECompression.cpp
+//  Reflow
+//
+
+#include "RECompression.h"
+
+#include <cstring>
+
+namespace {
+
+const int MinMatch = 4;
+const int LastLiterals = 5;         // The last 5 bytes of a block are always literals
+const int MatchFindLimit = 12;      // No match may start within the last 12 bytes
+const int HashBits = 12;
+const unsigned long MaxOffset = 65535;
+
+inline uint32_t Read32(const char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HashBits);
+}
+
+void WriteLength(std::string* dst, unsigned long length)
+{
+    while(length >= 255) {
+        dst->push_back((char)255);
+        length -= 255;
+    }
+    dst->push_back((char)length);
+}
+
+void WriteSequence(std::string* dst, const char* literals, unsigned long literalCount, unsigned long offset, unsigned long matchLength)
+{
+    unsigned long extraMatch = matchLength - MinMatch;
+    uint8_t token = (uint8_t)((std::min(literalCount, 15UL) << 4) | std::min(extraMatch, 15UL));
+    dst->push_back((char)token);
+
+    if(literalCount >= 15) WriteLength(dst, literalCount - 15);
+    dst->append(literals, literalCount);
+
+    dst->push_back((char)(offset & 0xFF));
+    dst->push_back((char)((offset >> 8) & 0xFF));
+
+    if(extraMatch >= 15) WriteLength(dst, extraMatch - 15);
+}
+
+void WriteLastLiterals(std::string* dst, const char* literals, unsigned long literalCount)
+{
+    dst->push_back((char)(std::min(literalCount, 15UL) << 4));
+    if(literalCount >= 15) WriteLength(dst, literalCount - 15);
+    dst->append(literals, literalCount);
+}
+
+bool ReadLength(const uint8_t*& ip, const uint8_t* end, unsigned long* length)
+{
+    uint8_t b;
+    do {
+        if(ip >= end) return false;
+        b = *ip++;
+        *length += b;
+    } while(b == 255);
+    return true;
+}
+
+}
+
+void RECompression::CompressLZ4(const char* src, unsigned long size, std::string* dst)
+{
+    dst->reserve(dst->size() + size + size / 255 + 16);
+
+    unsigned long anchor = 0;
+    if(size > (unsigned long)MatchFindLimit)
+    {
+        std::vector<long> table(1 << HashBits, -1);
+        unsigned long matchLimit = size - LastLiterals;
+        unsigned long ip = 0;
+
+        while(ip < size - MatchFindLimit)
+        {
+            uint32_t sequence = Read32(src + ip);
+            uint32_t h = Hash(sequence);
+            long ref = table[h];
+            table[h] = (long)ip;
+
+            if(ref < 0 || ip - ref > MaxOffset || Read32(src + ref) != sequence) {
+                ++ip;
+                continue;
+            }
+
+            unsigned long length = MinMatch;
+            while(ip + length < matchLimit && src[ref + length] == src[ip + length]) {
+                ++length;
+            }
+
+            WriteSequence(dst, src + anchor, ip - anchor, ip - ref, length);
+            ip += length;
+            anchor = ip;
+        }
+    }
+
+    WriteLastLiterals(dst, src + anchor, size - anchor);
+}
+
+bool RECompression::DecompressLZ4(const char* src, unsigned long size, char* dst, unsigned long rawSize)
+{
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(src);
+    const uint8_t* end = ip + size;
+    unsigned long op = 0;
+
+    while(ip < end)
+    {
+        uint8_t token = *ip++;
+
+        // Literals
+        unsigned long literalCount = token >> 4;
+        if(literalCount == 15 && !ReadLength(ip, end, &literalCount)) return false;
+        if(literalCount > (unsigned long)(end - ip) || literalCount > rawSize - op) return false;
+
+        memcpy(dst + op, ip, literalCount);
+        ip += literalCount;
+        op += literalCount;
+
+        // The last sequence has no match
+        if(ip == end) break;
+
+        // Match
+        if(end - ip < 2) return false;
+        unsigned long offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if(offset == 0 || offset > op) return false;
+
+        unsigned long length = token & 0x0F;
+        if(length == 15 && !ReadLength(ip, end, &length)) return false;
+        length += MinMatch;
+        if(length > rawSize - op) return false;
+
+        // Byte by byte: source and destination overlap for repeated patterns
+        const char* match = dst + op - offset;
+        for(unsigned long i=0; i<length; ++i) {
+            dst[op + i] = match[i];
+        }
+        op += length;
+    }
+
+    return op == rawSize;
+}
@@ -0,0 +1,25 @@
+//
+//  RECompression.h
+//  Reflow
+//
+
+#ifndef __Reflow__RECompression__
+#define __Reflow__RECompression__
+
+#include "RETypes.h"
+
+/** RECompression class.
+ *  Self-contained codec producing LZ4 block format data (no frame header), so that
+ *  chunks can be decoded by any LZ4 implementation and vice versa.
+ */
+class RECompression
+{
+public:
+    /** Appends the compressed form of src to dst */
+    static void CompressLZ4(const char* src, unsigned long size, std::string* dst);
+
+    /** Decompresses exactly rawSize bytes into dst, returns false on malformed input */
+    static bool DecompressLZ4(const char* src, unsigned long size, char* dst, unsigned long rawSize);
+};
+
+#endif /* defined(__Reflow__RECompression__) */
@@ -0,0 +1,217 @@
+//
+//  REDisplayList.cpp
+//  Reflow
+//
+
+#include "REDisplayList.h"
+#include "REPainter.h"
+
+#include <cstring>
+
+bool REDisplayList::Command::IsDrawing() const
+{
+    switch(op)
+    {
+        case FillRectOp:
+        case FillQuadOp:
+        case StrokeLineOp:
+        case StrokeRectOp:
+        case StrokeRectWithWidthOp:
+        case StrokePathOp:
+        case FillPathOp:
+        case PathStrokeOp:
+        case PathFillOp:
+        case DrawTextOp:
+        case DrawTextInRectOp:
+        case DrawTextBatchedOp:
+        case DrawMusicSymbolOp:
+        case DrawMusicSymbolFlippedOp:
+            return true;
+        default:
+            return false;
+    }
+}
+
+REDisplayList::REDisplayList()
+: _drawCommandCount(0)
+{
+}
+
+REDisplayList::~REDisplayList()
+{
+    Clear();
+}
+
+void REDisplayList::Clear()
+{
+    for(REBezierPath* path : _paths) {
+        delete path;
+    }
+    _paths.clear();
+    _commands.clear();
+    _strings.clear();
+    _stringIndices.clear();
+    _dashes.clear();
+    _bounds = RERect();
+    _drawCommandCount = 0;
+}
+
+int REDisplayList::_InternString(const std::string& str)
+{
+    auto it = _stringIndices.find(str);
+    if(it != _stringIndices.end()) {
+        return it->second;
+    }
+
+    int idx = (int)_strings.size();
+    _strings.push_back(str);
+    _stringIndices[str] = idx;
+    return idx;
+}
+
+int REDisplayList::_AddPath(const REBezierPath& path)
+{
+    _paths.push_back(new REBezierPath(path));
+    return (int)_paths.size() - 1;
+}
+
+int REDisplayList::_AddDashes(const REReal* lengths, int count)
+{
+    int offset = (int)_dashes.size();
+    _dashes.insert(_dashes.end(), lengths, lengths + count);
+    return offset;
+}
+
+void REDisplayList::_AddCommand(const Command& cmd)
+{
+    if(cmd.IsDrawing())
+    {
+        _bounds = (_drawCommandCount == 0 ? cmd.bounds : _bounds.Union(cmd.bounds));
+        ++_drawCommandCount;
+    }
+    _commands.push_back(cmd);
+}
+
+void REDisplayList::Replay(REPainter& painter) const
+{
+    for(const Command& cmd : _commands)
+    {
+        const float* v = cmd.v;
+        switch(cmd.op)
+        {
+            case SaveOp: painter.Save(); break;
+            case RestoreOp: painter.Restore(); break;
+            case TranslateOp: painter.Translate(v[0], v[1]); break;
+            case ScaleOp: painter.Scale(v[0], v[1]); break;
+            case SetStrokeColorOp: painter.SetStrokeColor(REColor(v[0], v[1], v[2], v[3])); break;
+            case SetFillColorOp: painter.SetFillColor(REColor(v[0], v[1], v[2], v[3])); break;
+            case SetLineDashOp: painter.SetLineDash(cmd.flags ? &_dashes[cmd.ref0] : NULL, cmd.flags, v[0]); break;
+
+            case FillRectOp: painter.FillRect(RERect(v[0], v[1], v[2], v[3])); break;
+            case FillQuadOp:
+            {
+                REPoint points[4] = {REPoint(v[0], v[1]), REPoint(v[2], v[3]), REPoint(v[4], v[5]), REPoint(v[6], v[7])};
+                painter.FillQuad(points);
+                break;
+            }
+            case StrokeLineOp: painter.StrokeLine(REPoint(v[0], v[1]), REPoint(v[2], v[3])); break;
+            case StrokeRectOp: painter.StrokeRect(RERect(v[0], v[1], v[2], v[3])); break;
+            case StrokeRectWithWidthOp: painter.StrokeRect(RERect(v[0], v[1], v[2], v[3]), v[4]); break;
+            case StrokePathOp: painter.StrokePath(*_paths[cmd.ref0]); break;
+            case FillPathOp: painter.FillPath(*_paths[cmd.ref0]); break;
+
+            case PathBeginOp: painter.PathBegin(); break;
+            case PathCloseOp: painter.PathClose(); break;
+            case PathMoveToOp: painter.PathMoveToPoint(v[0], v[1]); break;
+            case PathLineToOp: painter.PathLineToPoint(v[0], v[1]); break;
+            case PathCurveToOp: painter.PathCurveToPoint(REPoint(v[0], v[1]), REPoint(v[2], v[3]), REPoint(v[4], v[5])); break;
+            case PathQuadCurveToOp: painter.PathQuadCurveToPoint(REPoint(v[0], v[1]), REPoint(v[2], v[3])); break;
+            case PathAddEllipseOp: painter.PathAddEllipseInRect(RERect(v[0], v[1], v[2], v[3])); break;
+            case PathStrokeOp: painter.PathStroke(); break;
+            case PathFillOp: painter.PathFill(); break;
+
+            case DrawTextOp:
+                painter.DrawText(_strings[cmd.ref0], REPoint(v[0], v[1]), _strings[cmd.ref1], cmd.flags, v[2], REColor(v[3], v[4], v[5], v[6]));
+                break;
+            case DrawTextInRectOp:
+                painter.DrawTextInRect(_strings[cmd.ref0], RERect(v[0], v[1], v[2], v[3]), _strings[cmd.ref1], cmd.flags, v[4], REColor(v[5], v[6], v[7], v[8]));
+                break;
+            case BeginTextBatchedOp:
+                painter.BeginTextBatched(_strings[cmd.ref1], cmd.flags, v[0], REColor(v[1], v[2], v[3], v[4]));
+                break;
+            case DrawTextBatchedOp: painter.DrawTextBatched(_strings[cmd.ref0], REPoint(v[0], v[1])); break;
+            case EndTextBatchedOp: painter.EndTextBatched(); break;
+
+            case DrawMusicSymbolOp: painter.DrawMusicSymbol(_strings[cmd.ref0].c_str(), v[0], v[1], v[2]); break;
+            case DrawMusicSymbolFlippedOp: painter.DrawMusicSymbolFlipped(_strings[cmd.ref0].c_str(), v[0], v[1], v[2]); break;
+        }
+    }
+}
+
+bool REDisplayList::_CommandsEqual(const Command& a, const REDisplayList& otherList, const Command& b) const
+{
+    if(a.op != b.op || a.flags != b.flags) return false;
+    if(0 != memcmp(a.v, b.v, sizeof(a.v))) return false;
+
+    switch(a.op)
+    {
+        case StrokePathOp:
+        case FillPathOp:
+            // Two paths with the same footprint may still differ in shape, e.g. a slur's curvature
+            return *_paths[a.ref0] == *otherList._paths[b.ref0];
+
+        case SetLineDashOp:
+            return std::equal(_dashes.begin() + a.ref0, _dashes.begin() + a.ref0 + a.flags, otherList._dashes.begin() + b.ref0);
+
+        default:
+            break;
+    }
+
+    if((a.ref0 < 0) != (b.ref0 < 0) || (a.ref1 < 0) != (b.ref1 < 0)) return false;
+    if(a.ref0 >= 0 && _strings[a.ref0] != otherList._strings[b.ref0]) return false;
+    if(a.ref1 >= 0 && _strings[a.ref1] != otherList._strings[b.ref1]) return false;
+    return true;
+}
+
+RERect REDisplayList::DifferenceRect(const REDisplayList& other) const
+{
+    RERect dirty;
+    bool hasDirty = false;
+    auto addDirty = [&](const Command& cmd) {
+        if(!cmd.IsDrawing()) return;
+        dirty = (hasDirty ? dirty.Union(cmd.bounds) : cmd.bounds);
+        hasDirty = true;
+    };
+
+    // Walk both lists in step. A differing drawing command dirties its old and new footprint;
+    // a differing state command (color, transform...) may affect everything drawn after it.
+    size_t count = std::min(_commands.size(), other._commands.size());
+    size_t i = 0;
+    for(; i < count; ++i)
+    {
+        const Command& a = _commands[i];
+        const Command& b = other._commands[i];
+        if(_CommandsEqual(a, other, b)) continue;
+
+        if(a.IsDrawing() && b.IsDrawing()) {
+            addDirty(a);
+            addDirty(b);
+        }
+        else break;
+    }
+
+    for(size_t j = i; j < _commands.size(); ++j) addDirty(_commands[j]);
+    for(size_t j = i; j < other._commands.size(); ++j) addDirty(other._commands[j]);
+
+    return hasDirty ? dirty : RERect();
+}
+
+bool REDisplayList::operator==(const REDisplayList& rhs) const
+{
+    if(_commands.size() != rhs._commands.size()) return false;
+
+    for(size_t i=0; i<_commands.size(); ++i) {
+        if(!_CommandsEqual(_commands[i], rhs, rhs._commands[i])) return false;
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+//
+//  REDisplayList.h
+//  Reflow
+//
+
+#ifndef __Reflow__REDisplayList__
+#define __Reflow__REDisplayList__
+
+#include "RETypes.h"
+#include "REBezierPath.h"
+
+/** REDisplayList class.
+ *  Flat list of drawing commands captured by a RERecordingPainter.
+ *  Strings (texts, font names and musical glyph names) are interned, so a command is a fixed size record.
+ *  Every drawing command keeps its bounds in the coordinate space of the list, which allows two lists
+ *  to be compared to find the area that needs to be repainted.
+ */
+class REDisplayList
+{
+    friend class RERecordingPainter;
+
+public:
+    enum Opcode
+    {
+        SaveOp,
+        RestoreOp,
+        TranslateOp,
+        ScaleOp,
+        SetStrokeColorOp,
+        SetFillColorOp,
+        SetLineDashOp,
+
+        FillRectOp,
+        FillQuadOp,
+        StrokeLineOp,
+        StrokeRectOp,
+        StrokeRectWithWidthOp,
+        StrokePathOp,
+        FillPathOp,
+
+        PathBeginOp,
+        PathCloseOp,
+        PathMoveToOp,
+        PathLineToOp,
+        PathCurveToOp,
+        PathQuadCurveToOp,
+        PathAddEllipseOp,
+        PathStrokeOp,
+        PathFillOp,
+
+        DrawTextOp,
+        DrawTextInRectOp,
+        BeginTextBatchedOp,
+        DrawTextBatchedOp,
+        EndTextBatchedOp,
+
+        DrawMusicSymbolOp,
+        DrawMusicSymbolFlippedOp
+    };
+
+    struct Command
+    {
+        uint8_t op;
+        uint32_t flags;
+        int32_t ref0;       // interned string (text, glyph) or path/dash index
+        int32_t ref1;       // interned font name
+        float v[10];
+        RERect bounds;
+
+        Command(Opcode op_) : op(op_), flags(0), ref0(-1), ref1(-1), bounds() {std::fill(v, v+10, 0.0f);}
+
+        bool IsDrawing() const;
+    };
+    typedef std::vector<Command> CommandVector;
+
+public:
+    REDisplayList();
+    ~REDisplayList();
+
+public:
+    void Clear();
+    bool IsEmpty() const {return _commands.empty();}
+
+    unsigned int CommandCount() const {return (unsigned int)_commands.size();}
+    unsigned int DrawCommandCount() const {return _drawCommandCount;}
+    const Command& CommandAtIndex(int idx) const {return _commands[idx];}
+
+    const RERect& Bounds() const {return _bounds;}
+
+    const std::string& StringAtIndex(int idx) const {return _strings[idx];}
+
+    void Replay(REPainter& painter) const;
+
+    RERect DifferenceRect(const REDisplayList& other) const;
+
+    bool operator==(const REDisplayList& rhs) const;
+    bool operator!=(const REDisplayList& rhs) const {return !(*this == rhs);}
+
+private:
+    int _InternString(const std::string& str);
+    int _AddPath(const REBezierPath& path);
+    int _AddDashes(const REReal* lengths, int count);
+    void _AddCommand(const Command& cmd);
+    bool _CommandsEqual(const Command& a, const REDisplayList& otherList, const Command& b) const;
+
+private:
+    CommandVector _commands;
+    std::vector<std::string> _strings;
+    std::map<std::string, int> _stringIndices;
+    std::vector<REBezierPath*> _paths;
+    std::vector<REReal> _dashes;
+    RERect _bounds;
+    unsigned int _drawCommandCount;
+};
+
+#endif /* defined(__Reflow__REDisplayList__) */
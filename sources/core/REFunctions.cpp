@@ -316,6 +316,25 @@ RETimeDiv Reflow::TicksToTimeDiv(unsigned long ticks)
     return RETimeDiv(ticks, REFLOW_PULSES_PER_QUARTER);
 }
 
+REExactTick Reflow::TimeDivToExactTicks(const RETimeDiv& td)
+{
+    return ((REExactTick)td.numerator() * REFLOW_EXACT_TICKS_PER_QUARTER) / td.denominator();
+}
+
+RETimeDiv Reflow::ExactTicksToTimeDiv(REExactTick ticks)
+{
+    // Reduce in 64 bits first, the numerator of long bars would not fit in RETimeDiv otherwise
+    REExactTick den = REFLOW_EXACT_TICKS_PER_QUARTER;
+    REExactTick a = (ticks < 0 ? -ticks : ticks), b = den;
+    while(b != 0) {
+        REExactTick r = a % b;
+        a = b;
+        b = r;
+    }
+    if(a == 0) return RETimeDiv(0);
+    return RETimeDiv((int32_t)(ticks / a), (int32_t)(den / a));
+}
+
 void Reflow::WriteTimeDivToJson(const RETimeDiv& div, REJsonWriter& writer, uint32_t version)
 {
     if(div.denominator() == 1) {
@@ -906,3 +925,14 @@ std::string Reflow::Tail (std::string const& source, size_t const length)
     return source.substr(source.size() - length);
 }
 
+uint64_t Reflow::Checksum64(const char* data, unsigned long size)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for(unsigned long i=0; i<size; ++i) {
+        h ^= (uint8_t)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
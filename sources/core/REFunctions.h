@@ -37,6 +37,11 @@ namespace Reflow
     unsigned long TimeDivToTicks(const RETimeDiv&);
     RETimeDiv TicksToTimeDiv(unsigned long ticks);
     
+    REExactTick TimeDivToExactTicks(const RETimeDiv& td);
+    RETimeDiv ExactTicksToTimeDiv(REExactTick ticks);
+    inline unsigned long ExactTicksToTicks(REExactTick ticks) {return (unsigned long)(ticks / (REFLOW_EXACT_TICKS_PER_QUARTER / REFLOW_PULSES_PER_QUARTER));}
+    inline REExactTick TicksToExactTicks(unsigned long ticks) {return (REExactTick)ticks * (REFLOW_EXACT_TICKS_PER_QUARTER / REFLOW_PULSES_PER_QUARTER);}
+    
     void WriteTimeDivToJson(const RETimeDiv& div, REJsonWriter& writer, uint32_t version);
     void ReadTimeDivFromJson(RETimeDiv& div, const REJsonValue& obj, uint32_t version);
     
@@ -101,6 +106,8 @@ namespace Reflow
     
     std::string Tail (std::string const& source, size_t const length);
     
+    uint64_t Checksum64(const char* data, unsigned long size);
+    
     RESize SizeOfText(const std::string& textUTF8, const REFontDesc& fontDesc);
     RERect BoundsOfText(const std::string& textUTF8, const REFontDesc& fontDesc);
 }
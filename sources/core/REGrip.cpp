@@ -10,6 +10,7 @@
 #include "REFunctions.h"
 #include "REOutputStream.h"
 #include "REInputStream.h"
+#include "REException.h"
 
 #include <sstream>
 
@@ -214,6 +215,9 @@ void REGrip::EncodeTo(REOutputStream& coder) const
 void REGrip::DecodeFrom(REInputStream& decoder)
 {
     _stringCount = decoder.ReadInt8();
+    if(_stringCount < 0 || _stringCount > REFLOW_MAX_STRINGS) {
+        REThrow("Invalid grip string count");
+    }
     _playStringFlags = decoder.ReadInt16();
     for(int i=0; i<_stringCount; ++i) {
         _frets[i] = decoder.ReadInt8();
@@ -8,12 +8,19 @@
 
 #include "REGripCollection.h"
 #include "REGrip.h"
+#include "REOutputStream.h"
+#include "REInputStream.h"
 
 #include <cassert>
 #include <sstream>
 #include <boost/algorithm/string.hpp>
 #include <boost/foreach.hpp>
 
+namespace {
+    const char CacheMagic[4] = {'R', 'E', 'G', 'R'};
+    const uint32_t CacheVersion = 1;
+}
+
 REGripCollection::REGripCollection()
 {
 }
@@ -26,6 +33,7 @@ REGripCollection::~REGripCollection()
 void REGripCollection::Clear()
 {
     _grips.clear();
+    _indicesByFormulaId.clear();
 }
 
 
@@ -38,26 +46,75 @@ bool REGripCollection::LoadGripsXML(const char *data, int length)
 
 void REGripCollection::FetchGrips(REGripVector& grips, int chromaticStep, const std::string& formulaId) const
 {
-    REGripCollectionEntryVector::const_iterator it = _grips.begin();
-    for(; it != _grips.end(); ++it)
+    auto it = _indicesByFormulaId.find(formulaId);
+    if(it == _indicesByFormulaId.end()) return;
+    
+    for(int idx : it->second)
     {
-        const REGripCollectionEntry& entry = *it;
-        if(formulaId == entry.formulaId)
+        const REGripCollectionEntry& entry = _grips[idx];
+        if(chromaticStep == entry.chromaticStep)
         {
-            REGrip grip = entry.grip;
-            if(chromaticStep == entry.chromaticStep)
-            {
-                grips.push_back(grip);                
-            }
-            else if(grip.IsTransposable())
-            {
-                int dfret = chromaticStep - entry.chromaticStep;
-                grips.push_back(grip.Transposed(dfret));
-            }
+            grips.push_back(entry.grip);
+        }
+        else if(entry.grip.IsTransposable())
+        {
+            int dfret = chromaticStep - entry.chromaticStep;
+            grips.push_back(entry.grip.Transposed(dfret));
         }
     }
 }
 
+void REGripCollection::_AddEntry(const REGripCollectionEntry& entry)
+{
+    _indicesByFormulaId[entry.formulaId].push_back((int)_grips.size());
+    _grips.push_back(entry);
+}
+
+void REGripCollection::WriteCache(REOutputStream& coder, uint64_t sourceChecksum) const
+{
+    coder.Write(CacheMagic, 4);
+    coder.WriteUInt32(CacheVersion);
+    coder.WriteUInt32((uint32_t)(sourceChecksum >> 32));
+    coder.WriteUInt32((uint32_t)(sourceChecksum & 0xFFFFFFFF));
+    
+    coder.WriteUInt32(_grips.size());
+    for(const REGripCollectionEntry& entry : _grips)
+    {
+        coder.WriteString(entry.formulaId);
+        coder.WriteInt8(entry.chromaticStep);
+        entry.grip.EncodeTo(coder);
+    }
+}
+
+bool REGripCollection::ReadCache(REInputStream& decoder, uint64_t sourceChecksum)
+{
+    Clear();
+    try
+    {
+        if(decoder.ReadBytes(4) != std::string(CacheMagic, 4)) return false;
+        if(decoder.ReadUInt32() != CacheVersion) return false;
+        
+        uint64_t checksum = decoder.ReadUInt32();
+        checksum = (checksum << 32) | decoder.ReadUInt32();
+        if(checksum != sourceChecksum) return false;
+        
+        uint32_t count = decoder.ReadUInt32();
+        for(uint32_t i=0; i<count; ++i)
+        {
+            REGripCollectionEntry entry;
+            entry.formulaId = decoder.ReadString();
+            entry.chromaticStep = decoder.ReadInt8();
+            entry.grip.DecodeFrom(decoder);
+            _AddEntry(entry);
+        }
+    }
+    catch(std::exception&) {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
 void REGripCollection::OnStartElement(const REXMLParser& parser, 
                                        const std::string& name, 
                                        const std::string& namespaceURI, 
@@ -97,5 +154,5 @@ void REGripCollection::OnStartElement(const REXMLParser& parser,
     }
     
     // Add it to the collection
-    _grips.push_back(entry);
+    _AddEntry(entry);
 }
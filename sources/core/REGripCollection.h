@@ -14,6 +14,8 @@
 #include "REPitchClass.h"
 #include "REXMLParser.h"
 
+#include <unordered_map>
+
 
 class REGripCollectionEntry
 {
@@ -45,14 +47,22 @@ public:
     
     bool LoadGripsXML(const char* data, int length);
     
+    /** Binary image of the parsed collection, see REChordFormulaCollection::WriteCache */
+    void WriteCache(REOutputStream& coder, uint64_t sourceChecksum) const;
+    bool ReadCache(REInputStream& decoder, uint64_t sourceChecksum);
+    
     void FetchGrips(REGripVector& grips, int chromaticStep, const std::string& formulaId) const;
     
     void Clear();
     
     static REGripCollection* BuiltinCollection();
     
+private:
+    void _AddEntry(const REGripCollectionEntry& entry);
+    
 private:
     REGripCollectionEntryVector _grips;
+    std::unordered_map<std::string, std::vector<int> > _indicesByFormulaId;
     static REGripCollection* _builtinCollection;
     
 private:
@@ -11,6 +11,15 @@
 #include <stdio.h>
 #include <iostream>
 
+#ifdef _WIN32
+#  include <Windows.h>
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
 #include "REInputStream.h"
 #include "RETypes.h"
 #include "REException.h"
@@ -216,7 +225,7 @@ void REBufferInputStream::SeekTo(unsigned long pos)
 }
 
 bool REBufferInputStream::AtEnd() const {
-    return _pos < Size();
+    return _pos >= Size();
 }
 
 void REInputStream::Skip(unsigned long count)
@@ -266,7 +275,7 @@ void REConstBufferInputStream::SeekTo(unsigned long pos)
 }
 
 bool REConstBufferInputStream::AtEnd() const {
-    return _pos < Size();
+    return _pos >= Size();
 }
 
 
@@ -335,3 +344,140 @@ void REFileInputStream::SeekTo(unsigned long pos)
 bool REFileInputStream::AtEnd() const {
     return Pos() >= Size();
 }
+
+
+
+
+REMappedFileInputStream::REMappedFileInputStream()
+: _data(NULL), _pos(0), _size(0)
+#ifdef _WIN32
+, _fileHandle(INVALID_HANDLE_VALUE), _mappingHandle(NULL)
+#else
+, _fd(-1)
+#endif
+{
+    SetVersion(REFLOW_IO_VERSION);
+    SetEndianness(Reflow::LittleEndian);
+}
+
+REMappedFileInputStream::~REMappedFileInputStream()
+{
+    Close();
+}
+
+bool REMappedFileInputStream::Open(const std::string& filename)
+{
+    Close();
+    
+#ifdef _WIN32
+    _fileHandle = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(_fileHandle == INVALID_HANDLE_VALUE) {
+        std::cout << "Error: Failed to open " << filename << " for reading" << std::endl;
+        return false;
+    }
+    
+    LARGE_INTEGER size;
+    if(!::GetFileSizeEx(_fileHandle, &size) || size.QuadPart == 0) {
+        std::cout << "Error: Failed to map " << filename << std::endl;
+        Close();
+        return false;
+    }
+    
+    _mappingHandle = ::CreateFileMappingA(_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* data = (_mappingHandle ? ::MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0) : NULL);
+    if(data == NULL) {
+        std::cout << "Error: Failed to map " << filename << std::endl;
+        Close();
+        return false;
+    }
+    _size = (unsigned long)size.QuadPart;
+#else
+    _fd = ::open(filename.c_str(), O_RDONLY);
+    if(_fd < 0) {
+        std::cout << "Error: Failed to open " << filename << " for reading" << std::endl;
+        return false;
+    }
+    
+    struct stat st;
+    if(::fstat(_fd, &st) != 0 || st.st_size == 0) {
+        std::cout << "Error: Failed to map " << filename << std::endl;
+        Close();
+        return false;
+    }
+    
+    void* data = ::mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if(data == MAP_FAILED) {
+        std::cout << "Error: Failed to map " << filename << std::endl;
+        Close();
+        return false;
+    }
+    
+    // Parsers read front to back
+    ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+    _size = (unsigned long)st.st_size;
+#endif
+    
+    _data = static_cast<const char*>(data);
+    _pos = 0;
+    return true;
+}
+
+void REMappedFileInputStream::Close()
+{
+#ifdef _WIN32
+    if(_data) {
+        ::UnmapViewOfFile(_data);
+    }
+    if(_mappingHandle) {
+        ::CloseHandle(_mappingHandle);
+        _mappingHandle = NULL;
+    }
+    if(_fileHandle != INVALID_HANDLE_VALUE) {
+        ::CloseHandle(_fileHandle);
+        _fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if(_data) {
+        ::munmap(const_cast<char*>(_data), _size);
+    }
+    if(_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+#endif
+    _data = NULL;
+    _pos = 0;
+    _size = 0;
+}
+
+void REMappedFileInputStream::Read(char* bytes, unsigned long size)
+{
+    if(_pos + size > _size) {
+        REThrow("IO Error");
+    }
+    memcpy(bytes, _data + _pos, size);
+    _pos += size;
+}
+const char* REMappedFileInputStream::Data() const
+{
+    return _data;
+}
+unsigned long REMappedFileInputStream::Size() const
+{
+    return _size;
+}
+unsigned long REMappedFileInputStream::Pos() const
+{
+    return _pos;
+}
+void REMappedFileInputStream::SeekTo(unsigned long pos)
+{
+    if(pos <= _size) {
+        _pos = pos;
+    }
+    else REThrow("IO Error");
+}
+
+bool REMappedFileInputStream::AtEnd() const {
+    return _pos >= _size;
+}
@@ -118,4 +118,38 @@ private:
     unsigned long _size;
 };
 
+/** REMappedFileInputStream class.
+ *  Read-only memory mapping of a file: parsers can stream over it without
+ *  the whole file being copied into a buffer first.
+ */
+class REMappedFileInputStream : public REInputStream
+{
+public:
+	REMappedFileInputStream();
+    virtual ~REMappedFileInputStream();
+    
+    bool Open(const std::string& filename);
+    void Close();
+    bool IsOpen() const {return _data != NULL;}
+	
+public:
+	virtual void Read(char* bytes, unsigned long size);
+	virtual const char* Data() const;
+	virtual unsigned long Size() const;
+	virtual unsigned long Pos() const;
+	virtual void SeekTo(unsigned long pos);
+	virtual bool AtEnd() const;
+    
+private:
+    const char* _data;
+	unsigned long _pos;
+    unsigned long _size;
+#ifdef _WIN32
+    void* _fileHandle;
+    void* _mappingHandle;
+#else
+    int _fd;
+#endif
+};
+
 #endif
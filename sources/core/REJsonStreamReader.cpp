@@ -0,0 +1,251 @@
+//
+//  REJsonStreamReader.cpp
+//  Reflow
+//
+
+#include "REJsonStreamReader.h"
+#include "REInputStream.h"
+
+#include <rapidjson/reader.h>
+
+namespace {
+
+/** Cursor over an REInputStream following the rapidjson Stream concept.
+ *  The reader copies streams by value and assigns them back, so the refill buffer lives outside the cursor.
+ */
+class REJsonInputCursor
+{
+public:
+    typedef char Ch;
+
+    struct Source
+    {
+        REInputStream* stream;
+        std::vector<char> chunk;
+    };
+
+public:
+    REJsonInputCursor(Source* source)
+    : _source(source), _begin(NULL), _cur(NULL), _end(NULL), _base(source->stream->Pos())
+    {
+        // Memory backed streams are scanned in place
+        const char* data = source->stream->Data();
+        if(data) {
+            _begin = _cur = data + _base;
+            _end = data + source->stream->Size();
+        }
+    }
+
+    Ch Peek() {return (_cur != _end || _Fill()) ? *_cur : '\0';}
+    Ch Take() {return (_cur != _end || _Fill()) ? *_cur++ : '\0';}
+    size_t Tell() const {return _base + (_cur - _begin);}
+
+    Ch* PutBegin() {return NULL;}
+    void Put(Ch) {}
+    size_t PutEnd(Ch*) {return 0;}
+
+private:
+    bool _Fill()
+    {
+        REInputStream* stream = _source->stream;
+        if(stream->Data() || stream->Pos() >= stream->Size()) {
+            return false;
+        }
+
+        _base += (_end - _begin);
+        std::vector<char>& chunk = _source->chunk;
+        unsigned long count = std::min((unsigned long)chunk.size(), stream->Size() - stream->Pos());
+        stream->Read(chunk.data(), count);
+        _begin = _cur = chunk.data();
+        _end = _begin + count;
+        return true;
+    }
+
+private:
+    Source* _source;
+    const char* _begin;
+    const char* _cur;
+    const char* _end;
+    size_t _base;
+};
+
+}
+
+REJsonStreamReader::REJsonStreamReader()
+: _elementHandler(NULL), _depth(0), _expectKey(false)
+{
+}
+
+REJsonStreamReader::~REJsonStreamReader()
+{
+    _Reset();
+}
+
+bool REJsonStreamReader::Read(REInputStream& stream)
+{
+    _Reset();
+    _error.clear();
+    _ResetAllocator();
+
+    REJsonInputCursor::Source source;
+    source.stream = &stream;
+    if(stream.Data() == NULL) {
+        source.chunk.resize(64 * 1024);
+    }
+    REJsonInputCursor cursor(&source);
+
+    try
+    {
+        rapidjson::Reader reader;
+        if(!reader.Parse<0>(cursor, *this)) {
+            if(_error.empty()) {
+                _error = reader.GetParseError();
+            }
+        }
+    }
+    catch(std::exception& e) {
+        _error = e.what();
+    }
+
+    _Reset();
+    return _error.empty();
+}
+
+void REJsonStreamReader::_Reset()
+{
+    for(Frame& frame : _stack) {
+        delete frame.value;
+        delete frame.key;
+    }
+    _stack.clear();
+    _elementHandler = NULL;
+    _key.clear();
+    _depth = 0;
+    _expectKey = false;
+}
+
+void REJsonStreamReader::_ResetAllocator()
+{
+    // Values only reference memory from the pool, so dropping it frees everything read so far
+    _allocator.reset(new rapidjson::MemoryPoolAllocator<>());
+}
+
+#pragma mark -
+#pragma mark Handler
+
+void REJsonStreamReader::Null() {REJsonValue value; _AddValue(value);}
+void REJsonStreamReader::Bool(bool b) {REJsonValue value(b); _AddValue(value);}
+void REJsonStreamReader::Int(int i) {REJsonValue value(i); _AddValue(value);}
+void REJsonStreamReader::Uint(unsigned i) {REJsonValue value(i); _AddValue(value);}
+void REJsonStreamReader::Int64(int64_t i) {REJsonValue value(i); _AddValue(value);}
+void REJsonStreamReader::Uint64(uint64_t i) {REJsonValue value(i); _AddValue(value);}
+void REJsonStreamReader::Double(double d) {REJsonValue value(d); _AddValue(value);}
+
+void REJsonStreamReader::String(const char* str, rapidjson::SizeType length, bool /*copy*/)
+{
+    // Root member names are kept aside
+    if(_depth == 1 && _stack.empty() && _expectKey) {
+        _key.assign(str, length);
+        _expectKey = false;
+        return;
+    }
+
+    // The reader's string buffer is transient, always copy
+    REJsonValue value(str, length, *_allocator);
+    _AddValue(value);
+}
+
+void REJsonStreamReader::StartObject() {_StartContainer(rapidjson::kObjectType);}
+void REJsonStreamReader::EndObject(rapidjson::SizeType) {_EndContainer();}
+void REJsonStreamReader::StartArray() {_StartContainer(rapidjson::kArrayType);}
+void REJsonStreamReader::EndArray(rapidjson::SizeType) {_EndContainer();}
+
+void REJsonStreamReader::_StartContainer(rapidjson::Type type)
+{
+    ++_depth;
+
+    if(_depth == 1)
+    {
+        if(type != rapidjson::kObjectType) {
+            _error = "Root of the document is not an object";
+        }
+        _expectKey = true;
+        return;
+    }
+
+    // Root member arrays with an element handler are not materialized
+    if(_depth == 2 && type == rapidjson::kArrayType && _error.empty())
+    {
+        auto it = _elementHandlers.find(_key);
+        if(it != _elementHandlers.end()) {
+            _elementHandler = &it->second;
+            return;
+        }
+    }
+
+    Frame frame;
+    frame.value = new REJsonValue(type);
+    frame.key = NULL;
+    _stack.push_back(frame);
+}
+
+void REJsonStreamReader::_EndContainer()
+{
+    --_depth;
+
+    if(_depth == 0) {
+        return;
+    }
+
+    if(_stack.empty())
+    {
+        // End of a streamed root array
+        _elementHandler = NULL;
+        _expectKey = true;
+        return;
+    }
+
+    Frame frame = _stack.back();
+    _stack.pop_back();
+    delete frame.key;
+
+    _AddValue(*frame.value);
+    delete frame.value;
+}
+
+void REJsonStreamReader::_AddValue(REJsonValue& value)
+{
+    if(!_stack.empty())
+    {
+        Frame& top = _stack.back();
+        if(!top.value->IsObject()) {
+            top.value->PushBack(value, *_allocator);
+        }
+        else if(top.key == NULL) {
+            top.key = new REJsonValue;
+            *top.key = value;
+        }
+        else {
+            top.value->AddMember(*top.key, value, *_allocator);
+            delete top.key;
+            top.key = NULL;
+        }
+        return;
+    }
+
+    // A root member or an element of a streamed array is complete
+    if(_error.empty())
+    {
+        if(_elementHandler) {
+            (*_elementHandler)(_key, value);
+        }
+        else if(_memberHandler) {
+            _memberHandler(_key, value);
+        }
+    }
+
+    if(!_elementHandler) {
+        _expectKey = true;
+    }
+    _ResetAllocator();
+}
@@ -0,0 +1,75 @@
+//
+//  REJsonStreamReader.h
+//  Reflow
+//
+
+#ifndef __Reflow__REJsonStreamReader__
+#define __Reflow__REJsonStreamReader__
+
+#include "RETypes.h"
+
+/** REJsonStreamReader class.
+ *  SAX style reader for documents whose root is an object. Root members are materialized one at a time
+ *  and handed to the member handler; root arrays registered with SetElementHandler are materialized
+ *  element by element instead. The whole document is never held in memory.
+ */
+class REJsonStreamReader
+{
+    template<typename, typename> friend class rapidjson::GenericReader;
+
+public:
+    typedef std::function<void(const std::string& key, const REJsonValue& value)> ValueHandler;
+
+public:
+    REJsonStreamReader();
+    ~REJsonStreamReader();
+
+public:
+    void SetMemberHandler(const ValueHandler& handler) {_memberHandler = handler;}
+    void SetElementHandler(const std::string& key, const ValueHandler& handler) {_elementHandlers[key] = handler;}
+
+    bool Read(REInputStream& stream);
+    const std::string& Error() const {return _error;}
+
+private:
+    // rapidjson Handler concept
+    void Null();
+    void Bool(bool b);
+    void Int(int i);
+    void Uint(unsigned i);
+    void Int64(int64_t i);
+    void Uint64(uint64_t i);
+    void Double(double d);
+    void String(const char* str, rapidjson::SizeType length, bool copy);
+    void StartObject();
+    void EndObject(rapidjson::SizeType memberCount);
+    void StartArray();
+    void EndArray(rapidjson::SizeType elementCount);
+
+private:
+    struct Frame
+    {
+        REJsonValue* value;
+        REJsonValue* key;
+    };
+
+    void _StartContainer(rapidjson::Type type);
+    void _EndContainer();
+    void _AddValue(REJsonValue& value);
+    void _ResetAllocator();
+    void _Reset();
+
+private:
+    ValueHandler _memberHandler;
+    std::map<std::string, ValueHandler> _elementHandlers;
+    const ValueHandler* _elementHandler;
+
+    std::vector<Frame> _stack;
+    std::unique_ptr<rapidjson::MemoryPoolAllocator<> > _allocator;
+    std::string _key;
+    std::string _error;
+    int _depth;
+    bool _expectKey;
+};
+
+#endif /* defined(__Reflow__REJsonStreamReader__) */
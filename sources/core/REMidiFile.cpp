@@ -7,6 +7,8 @@
 //
 
 #include <sstream>
+#include <atomic>
+#include <thread>
 
 #include "REMidiFile.h"
 
@@ -44,7 +46,7 @@ void REMidiFile::Clear()
 
 void REMidiFile::Load(const std::string& filename, const REMidiFileLoadOptions& options)
 {
-    REFileInputStream stream;
+    REMappedFileInputStream stream;
     if(stream.Open(filename))
     {
         Load(stream, options);
@@ -55,8 +57,34 @@ void REMidiFile::Load(const std::string& filename, const REMidiFileLoadOptions&
     }
 }
 
+void REMidiFile::_RunParallel(int count, const std::function<void(int)>& work) const
+{
+    int threadCount = _options.threadCount;
+    if(threadCount <= 0) {
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, count);
+    
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for(int i = next++; i < count; i = next++) {
+            work(i);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for(int i=1; i<threadCount; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
 void REMidiFile::Load(REInputStream& stream, const REMidiFileLoadOptions& options)
 {
+    Clear();
     _options = options;
     stream.SetEndianness(Reflow::BigEndian);
     
@@ -78,22 +106,39 @@ void REMidiFile::Load(REInputStream& stream, const REMidiFileLoadOptions& option
     _quarterDiv = headerDivisions;
     _lastTick = 0;
     
-    for(int i=0; i<nbTracks; ++i)
+    // Locate the track chunks first. When the stream exposes its memory (buffer or mapped file),
+    // events are decoded in place; otherwise chunks are copied once into local storage.
+    struct TrackChunk {const char* bytes; unsigned int size;};
+    std::vector<TrackChunk> chunks;
+    std::vector<std::string> chunkStorage;
+    chunkStorage.reserve(nbTracks);
+    
+    const char* data = stream.Data();
+    for(int i=0; i<nbTracks && !stream.AtEnd(); ++i)
     {
         std::string chunkHeader = stream.ReadBytes(4);
         unsigned int chunkSize = stream.ReadInt32();
-        std::string bytes = stream.ReadBytes(chunkSize);
+        if(chunkSize > stream.Size() - stream.Pos()) {
+            _error = "Truncated MIDI Track";
+            return;
+        }
+        
+        const char* bytes = NULL;
+        if(data != NULL) {
+            bytes = data + stream.Pos();
+            stream.SeekTo(stream.Pos() + chunkSize);
+        }
+        else {
+            chunkStorage.push_back(stream.ReadBytes(chunkSize));
+            bytes = chunkStorage.back().data();
+        }
         
         if(chunkHeader == "MTrk")
         {
             REMidiFileTrack* track = new REMidiFileTrack;
             track->_index = i;
             _tracks.push_back(track);
-            if(!track->ReadEvents(bytes.data(), chunkSize)) {
-                _error = "Failed to read events from MIDI Track";
-                return;
-            }
-            _lastTick = std::max<uint32_t>(_lastTick, track->_lastTick);
+            chunks.push_back(TrackChunk{bytes, chunkSize});
         }
     }
     
@@ -102,65 +147,134 @@ void REMidiFile::Load(REInputStream& stream, const REMidiFileLoadOptions& option
         return;
     }
     
+    // Decode tracks concurrently, each one only touches its own events
+    std::vector<char> decoded(_tracks.size(), 0);
+    _RunParallel((int)_tracks.size(), [&](int idx) {
+        decoded[idx] = _tracks[idx]->ReadEvents(chunks[idx].bytes, chunks[idx].size);
+    });
+    
+    for(int i=0; i<_tracks.size(); ++i)
+    {
+        if(!decoded[i]) {
+            _error = "Failed to read events from MIDI Track";
+            return;
+        }
+        _lastTick = std::max<uint32_t>(_lastTick, _tracks[i]->_lastTick);
+    }
+    
     // Import Bars
     REMidiFileTrack* tempoTrack = _tracks[0];
     _lastTick = tempoTrack->_ComputeBars(_quarterDiv, _lastTick);
     
-    // Import Notes
+    // Import Notes: every (track, channel) pair is quantized independently against the
+    // bars of the tempo track, which is only read from here on.
+    std::vector<std::pair<REMidiFileTrack*, int> > work;
     for(REMidiFileTrack* track : _tracks)
     {
         if(options.mergeChannels) {
-            track->_ImportNotesMerged(*tempoTrack, _quarterDiv, _lastTick);
+            work.push_back(std::make_pair(track, -1));
         }
         else
         {
             for(int channelIndex=0; channelIndex<16; ++channelIndex)
             {
-                if(track->NoteCountOfChannel(channelIndex))
-                {
-                    track->_ImportNotes(*tempoTrack, _quarterDiv, _lastTick, channelIndex);
+                if(track->NoteCountOfChannel(channelIndex)) {
+                    work.push_back(std::make_pair(track, channelIndex));
                 }
             }
         }
     }
     
+    if(!work.empty())
+    {
+        _RunParallel((int)work.size(), [&](int idx) {
+            REMidiFileTrack* track = work[idx].first;
+            int channelIndex = work[idx].second;
+            if(channelIndex == -1) {
+                track->_ImportNotesMerged(*tempoTrack, _quarterDiv, _lastTick);
+            }
+            else {
+                track->_ImportNotes(*tempoTrack, _quarterDiv, _lastTick, channelIndex);
+            }
+        });
+    }
+    
     _error = "";
 }
 
 REMidiFileTrack::REMidiFileTrack()
-: _lastTick(0), _tempo(0)
+: _index(0), _tempo(0), _lastTick(0)
 {
     
 }
 
+namespace {
+    
+inline bool ReadMidiVLV(const uint8_t*& p, const uint8_t* end, uint32_t* value)
+{
+    // A variable length quantity has at most 4 bytes
+    uint32_t v = 0;
+    for(int i=0; i<4; ++i)
+    {
+        if(p == end) return false;
+        uint8_t c = *p++;
+        v = (v << 7) | (c & 0x7F);
+        if(!(c & 0x80)) {
+            *value = v;
+            return true;
+        }
+    }
+    *value = v;
+    return true;
+}
+
+inline int MidiMessageDataLength(uint8_t status)
+{
+    switch(status & 0xF0) {
+        case 0xC0:
+        case 0xD0: return 1;
+        default: return 2;
+    }
+}
+
+}
+
 bool REMidiFileTrack::ReadEvents(const char* bytes, int length)
 {
-    REConstBufferInputStream stream(bytes, length);
-    stream.SetEndianness(Reflow::BigEndian);
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(bytes);
+    const uint8_t* end = p + length;
     
     for(int channelIndex=0; channelIndex<16; ++channelIndex)
     {
         _noteCountPerChannel[channelIndex] = 0;
+        _midiEventsPerChannel[channelIndex].clear();
     }
+    _metaEvents.clear();
     
     uint32_t tick = 0;
     uint8_t runningStatus = 0x90;
-    while(stream.Pos() < stream.Size())
+    while(p < end)
     {
         // Read Delta Time
-        int dt = stream.ReadVLV();
+        uint32_t dt = 0;
+        if(!ReadMidiVLV(p, end, &dt) || p == end) return false;
         tick += dt;
         
         // Read MIDI Event
-        uint8_t b0 = stream.ReadUInt8();
+        uint8_t b0 = *p++;
         if(b0 == 0xFF)
         {
-            REMidiFileMetaEvent meta;
+            uint32_t dataLen = 0;
+            if(p == end) return false;
+            uint8_t type = *p++;
+            if(!ReadMidiVLV(p, end, &dataLen) || dataLen > (uint32_t)(end - p)) return false;
+            
+            _metaEvents.push_back(REMidiFileMetaEvent());
+            REMidiFileMetaEvent& meta = _metaEvents.back();
             meta._tick = tick;
-            meta._type = stream.ReadUInt8();
-            int dataLen = stream.ReadVLV();
-            meta._data = stream.ReadBytes(dataLen);
-            _metaEvents.push_back(meta);
+            meta._type = type;
+            meta._data.assign(reinterpret_cast<const char*>(p), dataLen);
+            p += dataLen;
             
             if(meta._type == 0x03) {
                 _name = meta._data;
@@ -168,64 +282,51 @@ bool REMidiFileTrack::ReadEvents(const char* bytes, int length)
             else if(meta._type == 0x2F) {
                 _lastTick = std::max<uint32_t> (meta._tick, _lastTick);
             }
-            else if(meta._type == 0x51 && _index == 0) {
-                uint32_t b0 = meta._data[0];
-                uint32_t b1 = meta._data[1];
-                uint32_t b2 = meta._data[2];
-                _tempo = 60000000 / (((b0<<16) & 0x00FF0000) | ((b1<<8) & 0x0000FF00) | (b2 & 0xFF));
+            else if(meta._type == 0x51 && _index == 0 && dataLen >= 3) {
+                uint32_t b0 = (uint8_t)meta._data[0];
+                uint32_t b1 = (uint8_t)meta._data[1];
+                uint32_t b2 = (uint8_t)meta._data[2];
+                uint32_t usPerQuarter = (b0 << 16) | (b1 << 8) | b2;
+                if(usPerQuarter) _tempo = 60000000 / usPerQuarter;
             }
-
         }
         else if(b0 == 0xF0 || b0 == 0xF7)
         {
-            // SYSEX
-            int dataLen = stream.ReadVLV();
-            std::string bytes = stream.ReadBytes(dataLen);
+            // SYSEX: skipped in place
+            uint32_t dataLen = 0;
+            if(!ReadMidiVLV(p, end, &dataLen) || dataLen > (uint32_t)(end - p)) return false;
+            p += dataLen;
         }
-        else if(b0 & 0x80)
+        else
         {
-            // Reset the running status
-            runningStatus = b0;
-            
             REMidiEvent midi;
             midi.tick = tick;
-            midi.data[0] = b0;
-            midi.data[1] = stream.ReadUInt8();
-            if ((b0 & 0xF0) == 0xC0) {
-                midi.data[2] = 0;
-            }
-            else if ((b0 & 0xF0) == 0xD0) {
-                midi.data[2] = 0;
-            }
-            else {
-                midi.data[2] = stream.ReadUInt8();
+            if(b0 & 0x80)
+            {
+                // Reset the running status
+                runningStatus = b0;
+                if(p == end) return false;
+                midi.data[1] = *p++;
             }
-            
-            _midiEventsPerChannel[b0 & 0x0F].push_back(midi);
-            if((b0 & 0xF0) == 0x90) {
-                _noteCountPerChannel[b0 & 0x0F] = 1 + _noteCountPerChannel[b0 & 0x0F];
+            else
+            {
+                // Use the running status
+                midi.data[1] = b0;
             }
-        }
-        else
-        {
-            // Use the running status
-            REMidiEvent midi;
-            midi.tick = tick;
             midi.data[0] = runningStatus;
-            midi.data[1] = b0;
-            if ((runningStatus & 0xF0) == 0xC0) {
-                midi.data[2] = 0;
-            }
-            else if ((runningStatus & 0xF0) == 0xD0) {
-                midi.data[2] = 0;
+            
+            if(MidiMessageDataLength(runningStatus) == 2) {
+                if(p == end) return false;
+                midi.data[2] = *p++;
             }
             else {
-                midi.data[2] = stream.ReadUInt8();
+                midi.data[2] = 0;
             }
             
-            _midiEventsPerChannel[runningStatus & 0x0F].push_back(midi);
-            if(midi.Type() == 0x9) {
-                _noteCountPerChannel[runningStatus & 0x0F] = 1 + _noteCountPerChannel[runningStatus & 0x0F];
+            int channel = runningStatus & 0x0F;
+            _midiEventsPerChannel[channel].push_back(midi);
+            if((runningStatus & 0xF0) == 0x90) {
+                ++_noteCountPerChannel[channel];
             }
         }
     }
@@ -286,39 +387,43 @@ int REMidiFileTrack::_ComputeBars(int ppqn, int maxTick)
     return currentTick;
 }
 
-void REMidiFileTrack::_ImportNotesMerged(const REMidiFileTrack& tempoTrack, int ppqn, int maxTick)
+void REMidiFileTrack::_CollectNotes(int channelIndex, double tickRatio, REBeat& beat) const
 {
-    double tickRatio = (double)REFLOW_PULSES_PER_QUARTER / (double)ppqn;
-    REBeat remainingBeat = REBeat(maxTick * tickRatio);
+    const REMidiEventVector& events = _midiEventsPerChannel[channelIndex];
     
-    for(int channelIndex = 0; channelIndex < 16; ++channelIndex)
+    // Pair each note-on with the next note-off of the same pitch in a single pass.
+    // Note-ons still waiting for their note-off are kept per pitch.
+    std::vector<uint32_t> offTicks(events.size(), UINT32_MAX);
+    boost::array<std::vector<int>, 256> openNotes;
+    for(int i=0; i<events.size(); ++i)
     {
-        for(int i=0; i<_midiEventsPerChannel[channelIndex].size(); ++i)
+        const REMidiEvent& midi = events[i];
+        uint8_t status = midi.data[0] & 0xF0;
+        std::vector<int>& open = openNotes[midi.data[1]];
+        if(status == 0x90 && midi.data[2] > 0) {
+            open.push_back(i);
+        }
+        else if(status == 0x80 || status == 0x90)
         {
-            const REMidiEvent& midi = _midiEventsPerChannel[channelIndex][i];
-            if((midi.data[0] & 0xF0) == 0x90 && midi.data[2] > 0)
-            {
-                unsigned int pitch = midi.data[1];
-                for(unsigned int j=i; j<_midiEventsPerChannel[channelIndex].size(); ++j)
-                {
-                    const REMidiEvent& midi2 = _midiEventsPerChannel[channelIndex][j];
-                    if( ((midi2.data[0] & 0xF0) == 0x90 && midi2.data[2] == 0) ||
-                       (midi2.data[0] & 0xF0) == 0x80)
-                    {
-                        if(pitch == midi2.data[1])
-                        {
-                            RXNote n = RXNote(midi.tick * tickRatio, (midi2.tick - midi.tick) * tickRatio, pitch, midi.data[2]);
-                            remainingBeat << n;
-                            break;
-                        }
-                    }
-                }
+            for(int noteOn : open) {
+                offTicks[noteOn] = midi.tick;
             }
+            open.clear();
         }
     }
     
-    //std::cout << remainingBeat.to_pretty_s() << std::endl;
-    
+    for(int i=0; i<events.size(); ++i)
+    {
+        if(offTicks[i] == UINT32_MAX) continue;
+        
+        const REMidiEvent& midi = events[i];
+        RXNote n = RXNote(midi.tick * tickRatio, (offTicks[i] - midi.tick) * tickRatio, midi.data[1], midi.data[2]);
+        beat << n;
+    }
+}
+
+REBeat REMidiFileTrack::_QuantizeBars(const REMidiFileTrack& tempoTrack, double tickRatio, REBeat remainingBeat) const
+{
     // Calculate Bar Beats
     REBeatVector beats;
     for(int barIndex=0; barIndex<tempoTrack._bars.size(); ++barIndex)
@@ -350,7 +455,22 @@ void REMidiFileTrack::_ImportNotesMerged(const REMidiFileTrack& tempoTrack, int
         beats.push_back(remainingBeat);
     }*/
     
-    _mainBeat = REBeat::BeatGroup(beats);
+    return REBeat::BeatGroup(beats);
+}
+
+void REMidiFileTrack::_ImportNotesMerged(const REMidiFileTrack& tempoTrack, int ppqn, int maxTick)
+{
+    double tickRatio = (double)REFLOW_PULSES_PER_QUARTER / (double)ppqn;
+    REBeat remainingBeat = REBeat(maxTick * tickRatio);
+    
+    for(int channelIndex = 0; channelIndex < 16; ++channelIndex)
+    {
+        _CollectNotes(channelIndex, tickRatio, remainingBeat);
+    }
+    
+    //std::cout << remainingBeat.to_pretty_s() << std::endl;
+    
+    _mainBeat = _QuantizeBars(tempoTrack, tickRatio, remainingBeat);
     /*std::cout << "#### DUMPING TRACK ####" << std::endl;
     for(int i=0; i<_mainBeat.SubBeatCount(); ++i)
     {
@@ -366,71 +486,11 @@ void REMidiFileTrack::_ImportNotes(const REMidiFileTrack& tempoTrack, int ppqn,
     double tickRatio = (double)REFLOW_PULSES_PER_QUARTER / (double)ppqn;
     REBeat remainingBeat = REBeat(maxTick * tickRatio);
     
-    for(int i=0; i<_midiEventsPerChannel[channelIndex].size(); ++i)
-    {
-        const REMidiEvent& midi = _midiEventsPerChannel[channelIndex][i];
-        if((midi.data[0] & 0xF0) == 0x90 && midi.data[2] > 0)
-        {
-            unsigned int pitch = midi.data[1];
-            for(unsigned int j=i; j<_midiEventsPerChannel[channelIndex].size(); ++j)
-            {
-                const REMidiEvent& midi2 = _midiEventsPerChannel[channelIndex][j];
-                if( ((midi2.data[0] & 0xF0) == 0x90 && midi2.data[2] == 0) ||
-                   (midi2.data[0] & 0xF0) == 0x80)
-                {
-                    if(pitch == midi2.data[1])
-                    {
-                        RXNote n = RXNote(midi.tick * tickRatio, (midi2.tick - midi.tick) * tickRatio, pitch, midi.data[2]);
-                        remainingBeat << n;
-                        break;
-                    }
-                }
-            }
-        }
-    }
+    _CollectNotes(channelIndex, tickRatio, remainingBeat);
     
     //std::cout << remainingBeat.to_pretty_s() << std::endl;
     
-    // Calculate Bar Beats
-    REBeatVector beats;
-    for(int barIndex=0; barIndex<tempoTrack._bars.size(); ++barIndex)
-    {
-        const REMidiFileBar& bar = tempoTrack._bars[barIndex];
-        REBeat::pair_type cb = remainingBeat.cut(bar.Duration() * tickRatio);
-        
-        //std::cout << cb.first.to_pretty_s() << std::endl;
-        
-        int treshold = REFLOW_PULSES_PER_QUARTER / 16;
-        REBeat beat = cb.first.DividedBeatWithTreshold(bar.TimeSignature().numerator, treshold).first;
-        //std::cout << beat.to_pretty_s() << std::endl;
-        
-        REBeatVector qbeats;
-        for(int i=0; i<beat.SubBeatCount(); ++i)
-        {
-            REBeat qbeat = beat.SubBeat(i).BestDividedBeat(1<<1 | 1<<2 | 1<<3 | 1<<4 | 1<<6 | 1<<8);
-            //std::cout << qbeat.to_pretty_s() << std::endl;
-            qbeats.push_back(qbeat);
-        }
-        
-        beat = REBeat::BeatGroup(qbeats);
-        //std::cout << beat.to_pretty_s() << std::endl;
-        beats.push_back(beat);
-        remainingBeat = cb.second;
-    }
-    /*if(remainingBeat.duration() > 0)
-     {
-     beats.push_back(remainingBeat);
-     }*/
-    
-    _mainBeatPerChannel[channelIndex] = REBeat::BeatGroup(beats);
-    /*std::cout << "#### DUMPING TRACK ####" << std::endl;
-     for(int i=0; i<_mainBeat.SubBeatCount(); ++i)
-     {
-     std::cout << "  Dumping Bar " << i << std::endl;
-     const REBeat& beat = _mainBeat.SubBeat(i);
-     std::cout << beat.to_pretty_s() << std::endl;
-     std::cout << std::endl << std::endl;
-     }*/
+    _mainBeatPerChannel[channelIndex] = _QuantizeBars(tempoTrack, tickRatio, remainingBeat);
 }
 
 
@@ -558,6 +618,7 @@ int REMidiFileTrack::ChannelIndexWithMostNotes() const
 RESong* REMidiFile::ImportSong() const
 {
     RESong* song = new RESong;
+    song->SetRefreshThreadCount(_options.threadCount);
     song->SetTitle("No Title");
     song->SetArtist("No Artist");
     
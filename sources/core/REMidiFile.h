@@ -13,6 +13,8 @@
 #include "REClip.h"
 #include "REBeat.h"
 
+#include <functional>
+
 #ifndef Q_MOC_RUN
 #include <boost/array.hpp>
 #endif
@@ -85,6 +87,8 @@ protected:
     int _ComputeBars(int ppqn, int maxTick);
     void _ImportNotesMerged(const REMidiFileTrack& tempoTrack, int ppqn, int maxTick);
     void _ImportNotes(const REMidiFileTrack& tempoTrack, int ppqn, int maxTick, int channel);
+    void _CollectNotes(int channel, double tickRatio, REBeat& beat) const;
+    REBeat _QuantizeBars(const REMidiFileTrack& tempoTrack, double tickRatio, REBeat remainingBeat) const;
     void _ImportTrackFromBeat(RETrack* track, int nbBars, const REBeat& mainBeat) const;
     
     REPhrase* ImportPhrase(const RETrack* track, REBeat beat) const;
@@ -106,9 +110,10 @@ typedef std::vector<REMidiFileTrack*> REMidiFileTrackVector;
 
 struct REMidiFileLoadOptions
 {
-    REMidiFileLoadOptions() : mergeChannels(true) {}
+    REMidiFileLoadOptions() : mergeChannels(true), threadCount(0) {}
     
     bool mergeChannels;
+    int threadCount;        // Worker threads used to decode, quantize and refresh tracks, 0 for one per core
 };
 
 
@@ -132,7 +137,7 @@ public:
     
 private:
     void Clear();
-    
+    void _RunParallel(int count, const std::function<void(int)>& work) const;
     
 private:
     std::string _error;
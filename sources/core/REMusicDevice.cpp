@@ -129,6 +129,7 @@ void RESynthMusicDevice::Process(unsigned int nbSamples, float* workBufferL, flo
             const ScheduledMidiEvent& evt = _events.front();
             ProcessMidiEvent(evt.cmdByte, evt.data1, evt.data2);
             _events.pop_front();
+            ++_processedEventCount;
         }
         
         // Process Samples until next MIDI event
@@ -156,6 +157,16 @@ void RESynthMusicDevice::Process(unsigned int nbSamples, float* workBufferL, flo
     }        
 }
 
+unsigned int RESynthMusicDevice::SoundingVoiceCount() const
+{
+    unsigned int count = 0;
+    for(const RESynthChannel* channel : _channels)
+    {
+        if(channel) count += channel->SoundingVoiceCount();
+    }
+    return count;
+}
+
 RESynthChannel* RESynthMusicDevice::Channel(int channel)
 {
     if(channel >= 0 && channel < NumChannels)
@@ -271,6 +282,14 @@ void RESynthMusicDevice::SetMidiProgramOfAllChannels(int program, int bank)
     }
 }
 
+void RESynthMusicDevice::ChangeSoundFont(RESoundFont* sf)
+{
+    _soundfont = sf;
+    for(RESynthChannel* channel : _channels) {
+        channel->ProcessProgramChangeEvent(channel->_program);
+    }
+}
+
 
 
 
@@ -294,7 +313,7 @@ REMusicDevice* REMusicDevice::CreateMusicDevice(Reflow::MusicDeviceType type)
 }
 
 REMusicDevice::REMusicDevice()
-: _sampleRate(44100)
+: _sampleRate(44100), _processedEventCount(0)
 {
     
 }
@@ -355,6 +374,16 @@ void RESynthChannel::ProcessAllSoundOff()
     }
 }
 
+unsigned int RESynthChannel::SoundingVoiceCount() const
+{
+    unsigned int count = 0;
+    for(const REMonophonicSynthVoice* voice : _voices)
+    {
+        if(voice->IsSounding()) ++count;
+    }
+    return count;
+}
+
 void RESynthChannel::ProcessNoteOnEvent(uint8_t pitch, uint8_t velocity)
 {
     //REPrintf("SynthMusicDevice::NoteOn %2.2x %2.2x\n", pitch, velocity);
@@ -12,6 +12,7 @@
 #include <deque>
 
 #include "RETypes.h"
+#include "REAudioMeter.h"
 
 class REMusicDeviceImpl;
 
@@ -30,6 +31,13 @@ public:
     
     double SampleRate() const {return _sampleRate;}
     
+    /** Levels of the device output, updated by the rack while metering is enabled */
+    const REAudioMeter& Meter() const {return _meter;}
+    REAudioMeter& Meter() {return _meter;}
+    
+    /** [[CALLED FROM AUDIO RT THREAD]] Voices currently producing sound */
+    virtual unsigned int SoundingVoiceCount() const {return 0;}
+    
 public:
     virtual Reflow::MusicDeviceType Type() const = 0;
     virtual void MidiEvent(unsigned int cmdByte, unsigned int data1, unsigned int data2, unsigned int sampleOffset) = 0;
@@ -47,6 +55,8 @@ protected:
 protected:
     double _sampleRate;
     int32_t _uuid;
+    REAudioMeter _meter;
+    unsigned int _processedEventCount;     // Since the rack last collected it
 };
 
 
@@ -77,6 +87,7 @@ protected:
     void ProcessPitchWheelEvent(int8_t lsb, int8_t msb);
     void ProcessSamples(unsigned int nbSamples, float* workBufferL, float* workBufferR);
     void ProcessAllSoundOff();
+    unsigned int SoundingVoiceCount() const;
     
     void Initialize();
     void Shutdown();
@@ -126,6 +137,7 @@ public:
     
     // Called from Audio Rendering Thread
     virtual void Process(unsigned int nbSamples, float* workBufferL, float* workBufferR);
+    virtual unsigned int SoundingVoiceCount() const;
     
     virtual void SetVolume(float vol);
     virtual void SetPan(float pan);
@@ -136,6 +148,9 @@ public:
     RESoundFont* SoundFont() {return _soundfont;}
     void SetSoundFont(RESoundFont* sf) {_soundfont = sf;}
     
+    /** Channels pick their patch again from sf, sounding voices end with the samples they started with */
+    void ChangeSoundFont(RESoundFont* sf);
+    
     void SetMidiProgramOfAllChannels(int program, int bank);
     
 protected:
@@ -10,10 +10,13 @@
 #include "REMusicDevice.h"
 #include "REAudioEngine.h"
 
+#include <chrono>
+
 REMusicRack::REMusicRack()
-: _renderingEnabled(false), _delegate(NULL), _metronomeDevice(NULL), _audioEngine(NULL)
+: _renderingEnabled(false), _meteringEnabled(true), _delegate(NULL), _metronomeDevice(NULL), _audioEngine(NULL)
 {
-    
+    _deviceBufferL.resize(REFLOW_WORK_BUFFER_SIZE);
+    _deviceBufferR.resize(REFLOW_WORK_BUFFER_SIZE);
 }
 
 REMusicRack::~REMusicRack()
@@ -42,10 +45,32 @@ bool REMusicRack::RenderingEnabled() const
     return _renderingEnabled;
 }
 
+void REMusicRack::SetMeteringEnabled(bool metering)
+{
+    // CRITICAL: Prevent rack from being rendered while we modify some parameters
+    MutexLocker lock_my_rack_please(_mtx);
+    
+    _meteringEnabled = metering;
+}
+
+void REMusicRack::SetMaxBufferSize(unsigned int nbSamples)
+{
+    // CRITICAL: Prevent rack from being rendered while we modify some parameters
+    MutexLocker lock_my_rack_please(_mtx);
+    
+    _deviceBufferL.resize(std::max<unsigned int>(nbSamples, REFLOW_WORK_BUFFER_SIZE));
+    _deviceBufferR.resize(std::max<unsigned int>(nbSamples, REFLOW_WORK_BUFFER_SIZE));
+}
+
 void REMusicRack::Render(unsigned int nbSamples, float* workBufferL, float* workBufferR)
 {
+    std::chrono::steady_clock::time_point lockStart = std::chrono::steady_clock::now();
+    
     // CRITICAL: Do not modify a music rack while it is being processed
     MutexLocker lock_my_rack_please(_mtx);
+    
+    std::chrono::duration<double> lockWait = std::chrono::steady_clock::now() - lockStart;
+    _renderCounters.lockWait += lockWait.count();
  
     if(!_renderingEnabled) return;
 
@@ -54,6 +79,7 @@ void REMusicRack::Render(unsigned int nbSamples, float* workBufferL, float* work
     // Will Render Rack
     if(_delegate) _delegate->WillRenderRack(this, nbSamples, workBufferL, workBufferR);
     
+    unsigned int voices = 0;
     for(unsigned int i=0; i<_devices.size(); ++i)
     {
         REMusicDevice* device = _devices[i];
@@ -62,10 +88,19 @@ void REMusicRack::Render(unsigned int nbSamples, float* workBufferL, float* work
         if(_delegate) _delegate->WillRenderDevice(this, device, nbSamples, workBufferL, workBufferR);
         
         // Render Device
-        device->Process(nbSamples, workBufferL, workBufferR);
+        if(_meteringEnabled) {
+            _RenderMeteredDevice(device, nbSamples, workBufferL, workBufferR);
+        }
+        else {
+            device->Process(nbSamples, workBufferL, workBufferR);
+        }
 
         // Did Render Device
         if(_delegate) _delegate->DidRenderDevice(this, device, nbSamples, workBufferL, workBufferR);
+        
+        _renderCounters.events += device->_processedEventCount;
+        device->_processedEventCount = 0;
+        voices += device->SoundingVoiceCount();
     }
     
     // Render Metronome
@@ -73,12 +108,51 @@ void REMusicRack::Render(unsigned int nbSamples, float* workBufferL, float* work
     {
         _metronomeDevice->SetVolume(audioSettings.MetronomeGain());
         _metronomeDevice->Process(nbSamples, workBufferL, workBufferR);
+        
+        _renderCounters.events += _metronomeDevice->_processedEventCount;
+        _metronomeDevice->_processedEventCount = 0;
+        voices += _metronomeDevice->SoundingVoiceCount();
     }
+    _renderCounters.voices = std::max(_renderCounters.voices, voices);
     
     // Did Render Rack
     if(_delegate) _delegate->DidRenderRack(this, nbSamples, workBufferL, workBufferR);
 }
 
+void REMusicRack::CollectRenderCounters(REAudioEngineStats::Counters* counters)
+{
+    counters->events += _renderCounters.events;
+    counters->voices += _renderCounters.voices;
+    counters->lockWait += _renderCounters.lockWait;
+    _renderCounters = REAudioEngineStats::Counters();
+}
+
+void REMusicRack::_RenderMeteredDevice(REMusicDevice* device, unsigned int nbSamples, float* workBufferL, float* workBufferR)
+{
+    // No allocation on the audio thread: a block larger than announced is rendered without metering
+    if(nbSamples > _deviceBufferL.size()) {
+        device->Process(nbSamples, workBufferL, workBufferR);
+        return;
+    }
+    
+    float* bufferL = _deviceBufferL.data();
+    float* bufferR = _deviceBufferR.data();
+    std::fill(bufferL, bufferL + nbSamples, 0.0f);
+    std::fill(bufferR, bufferR + nbSamples, 0.0f);
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    device->Process(nbSamples, bufferL, bufferR);
+    std::chrono::duration<double> renderTime = std::chrono::steady_clock::now() - start;
+    
+    device->_meter.Process(bufferL, bufferR, nbSamples, device->SampleRate(), renderTime.count());
+    
+    for(unsigned int i=0; i<nbSamples; ++i)
+    {
+        workBufferL[i] += bufferL[i];
+        workBufferR[i] += bufferR[i];
+    }
+}
+
 RESynthMusicDevice* REMusicRack::MetronomeDevice()
 {
     return _metronomeDevice;
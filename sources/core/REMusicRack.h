@@ -10,6 +10,7 @@
 #define Reflow_REMusicRack_h
 
 #include "RETypes.h"
+#include "REAudioEngineStats.h"
 
 #include <mutex>
 
@@ -33,6 +34,16 @@ public:
     bool RenderingEnabled() const;
     void Render(unsigned int nbSamples, float* workBufferL, float* workBufferR);
     
+    /** Devices are rendered into their own buffers to measure their levels and render time */
+    void SetMeteringEnabled(bool metering);
+    bool MeteringEnabled() const {return _meteringEnabled;}
+    
+    /** Sizes the metering buffers for the largest block the audio engine renders, larger blocks are not metered */
+    void SetMaxBufferSize(unsigned int nbSamples);
+    
+    /** [[CALLED FROM AUDIO RT THREAD]] Adds what was rendered since the last call to counters, then starts over */
+    void CollectRenderCounters(REAudioEngineStats::Counters* counters);
+    
     void SetDelegate(REMusicRackDelegate* delegate);
     REMusicRackDelegate* Delegate() {return _delegate;}
     const REMusicRackDelegate* Delegate() const {return _delegate;}
@@ -63,10 +74,15 @@ public:
     
 protected:
     REMusicDevice* _NewMusicDevice(int32_t uuid);
+    void _RenderMeteredDevice(REMusicDevice* device, unsigned int nbSamples, float* workBufferL, float* workBufferR);
     
 private:
     double _sampleRate;
     bool _renderingEnabled;
+    bool _meteringEnabled;
+    std::vector<float> _deviceBufferL;
+    std::vector<float> _deviceBufferR;
+    REAudioEngineStats::Counters _renderCounters;
     MutexType _mtx;
     REMusicDeviceVector _devices;
     RESynthMusicDevice* _metronomeDevice;
@@ -0,0 +1,131 @@
+//
+//  RENoteSelection.cpp
+//  Reflow
+//
+
+#include "RENoteSelection.h"
+#include "RESong.h"
+#include "RETrack.h"
+#include "REVoice.h"
+#include "REPhrase.h"
+#include "REChord.h"
+#include "RENote.h"
+
+RENoteSelection::RENoteSelection(RESong* song)
+: _song(song), _count(0), _valid(false)
+{
+}
+
+void RENoteSelection::_Validate() const
+{
+    if(_valid) return;
+
+    _notes.clear();
+    _bars.clear();
+    _count = 0;
+
+    RENoteSet notes;
+    if(_song) _song->FindSelectedNotes(&notes);
+
+    _valid = true;
+    for(RENote* note : notes) {
+        _Insert(note);
+    }
+}
+
+void RENoteSelection::_Insert(RENote* note) const
+{
+    // Builds without note selection never report a note as selected
+    if(!note->IsSelected()) return;
+
+    const REPhrase* phrase = note->Chord()->Phrase();
+    int barIndex = phrase->Index();
+    int trackIndex = phrase->Track()->Index();
+
+    if(_notes[BarTrack(barIndex, trackIndex)].insert(note).second) {
+        _bars.insert(barIndex);
+        ++_count;
+    }
+}
+
+void RENoteSelection::Select(RENote* note)
+{
+    _Validate();
+    note->SetSelected(true);
+    _Insert(note);
+}
+
+void RENoteSelection::SelectNotes(const RENoteSet& notes)
+{
+    _Validate();
+    for(RENote* note : notes) {
+        note->SetSelected(true);
+        _Insert(note);
+    }
+}
+
+int RENoteSelection::UnselectAll(REIntSet* invalidatedBars)
+{
+    _Validate();
+
+    int nbNotesUnselected = _count;
+    for(NoteSetMap::value_type& entry : _notes) {
+        for(RENote* note : entry.second) {
+            note->SetSelected(false);
+        }
+    }
+    if(invalidatedBars != NULL) {
+        invalidatedBars->insert(_bars.begin(), _bars.end());
+    }
+
+    _notes.clear();
+    _bars.clear();
+    _count = 0;
+    return nbNotesUnselected;
+}
+
+int RENoteSelection::Count() const
+{
+    _Validate();
+    return _count;
+}
+
+int RENoteSelection::FindSelectedNotes(REConstNoteSet* noteSet, REIntSet* affectedBars) const
+{
+    _Validate();
+    if(noteSet != NULL) {
+        for(const NoteSetMap::value_type& entry : _notes) {
+            noteSet->insert(entry.second.begin(), entry.second.end());
+        }
+    }
+    if(affectedBars != NULL) {
+        affectedBars->insert(_bars.begin(), _bars.end());
+    }
+    return _count;
+}
+
+int RENoteSelection::FindSelectedNotes(RENoteSet* noteSet, REIntSet* affectedBars)
+{
+    _Validate();
+    if(noteSet != NULL) {
+        for(const NoteSetMap::value_type& entry : _notes) {
+            noteSet->insert(entry.second.begin(), entry.second.end());
+        }
+    }
+    if(affectedBars != NULL) {
+        affectedBars->insert(_bars.begin(), _bars.end());
+    }
+    return _count;
+}
+
+const REIntSet& RENoteSelection::AffectedBars() const
+{
+    _Validate();
+    return _bars;
+}
+
+const RENoteSelection::NoteSetMap& RENoteSelection::NotesByBarAndTrack() const
+{
+    _Validate();
+    return _notes;
+}
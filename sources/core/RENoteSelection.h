@@ -0,0 +1,58 @@
+//
+//  RENoteSelection.h
+//  Reflow
+//
+
+#ifndef __Reflow__RENoteSelection__
+#define __Reflow__RENoteSelection__
+
+#include "RETypes.h"
+
+/** RENoteSelection class.
+ *  Index of the selected notes of a song, grouped by bar and track, kept next to the RENote::Selected
+ *  flag that staves draw from. Queries and clears only touch the selected notes.
+ *
+ *  Notes are referenced by pointer, so any modification of the song invalidates the index; it is then
+ *  rebuilt from the note flags with one scan of the song the next time it is queried.
+ */
+class RENoteSelection
+{
+public:
+    typedef std::pair<int, int> BarTrack;
+    typedef std::map<BarTrack, RENoteSet> NoteSetMap;
+
+public:
+    RENoteSelection(RESong* song);
+
+public:
+    void Invalidate() {_valid = false;}
+    bool IsValid() const {return _valid;}
+
+    void Select(RENote* note);
+    void SelectNotes(const RENoteSet& notes);
+
+    /** Unselects every note and adds the bars that held one to invalidatedBars */
+    int UnselectAll(REIntSet* invalidatedBars);
+
+    int Count() const;
+    bool IsEmpty() const {return Count() == 0;}
+
+    int FindSelectedNotes(REConstNoteSet* noteSet, REIntSet* affectedBars=NULL) const;
+    int FindSelectedNotes(RENoteSet* noteSet, REIntSet* affectedBars=NULL);
+
+    const REIntSet& AffectedBars() const;
+    const NoteSetMap& NotesByBarAndTrack() const;
+
+private:
+    void _Validate() const;
+    void _Insert(RENote* note) const;
+
+private:
+    RESong* _song;
+    mutable NoteSetMap _notes;
+    mutable REIntSet _bars;
+    mutable int _count;
+    mutable bool _valid;
+};
+
+#endif /* defined(__Reflow__RENoteSelection__) */
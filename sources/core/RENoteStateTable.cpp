@@ -0,0 +1,99 @@
+//
+//  RENoteStateTable.cpp
+//  Reflow
+//
+
+#include "RENoteStateTable.h"
+#include "RETrack.h"
+#include "REVoice.h"
+#include "REPhrase.h"
+#include "REChord.h"
+#include "RENote.h"
+
+#include <algorithm>
+
+namespace {
+
+void AddChord(const REChord* chord, bool tablature, RENoteStateTable::KeySet* keys, RENoteStateTable::FretSet* frets)
+{
+    for(const RENote* note : chord->Notes())
+    {
+        int pitch = note->Pitch().midi;
+        if(pitch >= 0 && pitch < RENoteStateTable::KeyCount) {
+            keys->set(pitch);
+        }
+
+        int bit = (tablature ? RENoteStateTable::FretBit(note->String(), note->Fret()) : -1);
+        if(bit != -1) {
+            frets->set(bit);
+        }
+    }
+}
+
+}
+
+RENoteStateTable::RENoteStateTable()
+{
+}
+
+void RENoteStateTable::Build(const RETrack* track, int barIndex)
+{
+    _keysInBar.reset();
+    _fretsInBar.reset();
+    _states.clear();
+
+    bool tablature = track->IsTablature();
+
+    std::vector<const REPhrase*> phrases;
+    std::vector<unsigned long> onsets;
+    for(unsigned int voiceIndex=0; voiceIndex < track->VoiceCount(); ++voiceIndex)
+    {
+        const REPhrase* phrase = track->Voice(voiceIndex)->Phrase(barIndex);
+        if(phrase == NULL || phrase->ChordCount() == 0) continue;
+
+        phrases.push_back(phrase);
+        for(const REChord* chord : phrase->Chords())
+        {
+            onsets.push_back(chord->OffsetInTicks());
+            AddChord(chord, tablature, &_keysInBar, &_fretsInBar);
+        }
+    }
+
+    std::sort(onsets.begin(), onsets.end());
+    onsets.erase(std::unique(onsets.begin(), onsets.end()), onsets.end());
+
+    // Chords are sorted by offset in their phrase, so each voice is walked once
+    std::vector<unsigned int> nextChords(phrases.size(), 0);
+    _states.resize(onsets.size());
+    for(unsigned int i=0; i < onsets.size(); ++i)
+    {
+        State& state = _states[i];
+        state.tick = onsets[i];
+
+        for(unsigned int p=0; p < phrases.size(); ++p)
+        {
+            const REPhrase* phrase = phrases[p];
+            unsigned int& next = nextChords[p];
+            while(next < phrase->ChordCount() && phrase->Chord(next)->OffsetInTicks() <= state.tick) {
+                ++next;
+            }
+            if(next > 0) {
+                AddChord(phrase->Chord(next - 1), tablature, &state.keys, &state.frets);
+            }
+        }
+    }
+}
+
+const RENoteStateTable::State* RENoteStateTable::StateAtTick(unsigned long tick) const
+{
+    // Last state starting at or before tick
+    StateVector::const_iterator it = std::upper_bound(_states.begin(), _states.end(), tick,
+        [](unsigned long t, const State& state) {return t < state.tick;});
+    return (it == _states.begin() ? NULL : &*(it - 1));
+}
+
+int RENoteStateTable::FretBit(int string, int fret)
+{
+    if(string < 0 || string >= REFLOW_MAX_STRINGS || fret < 0 || fret >= FretCount) return -1;
+    return string * FretCount + fret;
+}
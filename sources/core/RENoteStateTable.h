@@ -0,0 +1,64 @@
+//
+//  RENoteStateTable.h
+//  Reflow
+//
+
+#ifndef __Reflow__RENoteStateTable__
+#define __Reflow__RENoteStateTable__
+
+#include "RETypes.h"
+
+#include <bitset>
+
+/** RENoteStateTable class.
+ *  The notes of one bar of a track, all voices together, as bitsets of MIDI keys and of string and fret pairs:
+ *  those of the whole bar, and those of the chords sounding from each onset of the bar up to the next one.
+ *
+ *  The sequencer builds a table per bar when it calculates its clips, so that the instrument views only look up
+ *  the state of the tick being played instead of walking the phrases on every repaint.
+ */
+class RENoteStateTable
+{
+public:
+    enum {
+        KeyCount = 128,
+        FretCount = 32              // Frets 0 to 31 of each string
+    };
+
+    typedef std::bitset<KeyCount> KeySet;
+    typedef std::bitset<REFLOW_MAX_STRINGS * FretCount> FretSet;
+
+    /** Notes of the chord of each voice that started at or before tick */
+    struct State
+    {
+        unsigned long tick;         // From the start of the bar
+        KeySet keys;
+        FretSet frets;              // Empty when the track has no tablature
+    };
+    typedef std::vector<State> StateVector;
+
+public:
+    RENoteStateTable();
+
+public:
+    /** Reads the phrases of every voice of the track at barIndex */
+    void Build(const RETrack* track, int barIndex);
+
+    const KeySet& KeysInBar() const {return _keysInBar;}
+    const FretSet& FretsInBar() const {return _fretsInBar;}
+    const StateVector& States() const {return _states;}
+
+    /** State sounding at tick, NULL before the first onset of the bar */
+    const State* StateAtTick(unsigned long tick) const;
+
+public:
+    /** Bit of a string and fret pair in a FretSet, -1 if the table has no room for it */
+    static int FretBit(int string, int fret);
+
+private:
+    KeySet _keysInBar;
+    FretSet _fretsInBar;
+    StateVector _states;            // By increasing tick
+};
+
+#endif /* defined(__Reflow__RENoteStateTable__) */
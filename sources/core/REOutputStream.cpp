@@ -8,6 +8,7 @@
 
 #include <cassert>
 #include <string.h>
+#include <algorithm>
 
 #include "REOutputStream.h"
 #include "RETypes.h"
@@ -193,3 +194,194 @@ void REBufferOutputStream::Skip(unsigned long size)
     _pos += size;
 }
 
+void REBufferOutputStream::Reserve(unsigned long size)
+{
+    _buffer.reserve(_pos + size);
+}
+
+
+
+REFileOutputStream::REFileOutputStream()
+: _file(NULL), _pos(0), _size(0), _buffered(0), _error(false)
+{
+    SetVersion(REFLOW_IO_VERSION);
+    SetSubType(REFLOW_IO_REFLOW2);
+    SetEndianness(Reflow::LittleEndian);
+}
+
+REFileOutputStream::~REFileOutputStream()
+{
+    Close();
+}
+
+bool REFileOutputStream::Open(const std::string& filename)
+{
+    Close();
+    _file = ::fopen(filename.c_str(), "w+b");
+    _pos = _size = _buffered = 0;
+    _error = (_file == NULL);
+    return _file != NULL;
+}
+
+bool REFileOutputStream::OpenTemporary()
+{
+    Close();
+    _file = ::tmpfile();
+    _pos = _size = _buffered = 0;
+    _error = (_file == NULL);
+    return _file != NULL;
+}
+
+bool REFileOutputStream::Close()
+{
+    if(_file == NULL) return !_error;
+    
+    _Flush();
+    if(0 != ::fclose(_file)) {
+        _error = true;
+    }
+    _file = NULL;
+    return !_error;
+}
+
+void REFileOutputStream::_Flush()
+{
+    if(_buffered == 0) return;
+    
+    if(_file == NULL || 1 != ::fwrite(_buffer.data(), _buffered, 1, _file)) {
+        _error = true;
+    }
+    _pos += _buffered;
+    _size = std::max(_size, _pos);
+    _buffered = 0;
+}
+
+void REFileOutputStream::Write(const char* bytes, unsigned long size)
+{
+    if(_buffer.empty()) {
+        _buffer.resize(BufferSize);
+    }
+    
+    if(_buffered + size > BufferSize) {
+        _Flush();
+    }
+    
+    if(size >= BufferSize)
+    {
+        if(_file == NULL || 1 != ::fwrite(bytes, size, 1, _file)) {
+            _error = true;
+        }
+        _pos += size;
+        _size = std::max(_size, _pos);
+    }
+    else
+    {
+        memcpy(_buffer.data() + _buffered, bytes, size);
+        _buffered += size;
+    }
+}
+
+const char* REFileOutputStream::Data() const
+{
+    return NULL;
+}
+
+unsigned long REFileOutputStream::Size() const
+{
+    return std::max(_size, _pos + _buffered);
+}
+
+unsigned long REFileOutputStream::Pos() const
+{
+    return _pos + _buffered;
+}
+
+void REFileOutputStream::SeekTo(unsigned long pos)
+{
+    assert(pos <= Size());
+    _Flush();
+    if(_file == NULL || 0 != ::fseek(_file, pos, SEEK_SET)) {
+        _error = true;
+    }
+    _pos = pos;
+}
+
+void REFileOutputStream::Skip(unsigned long nb)
+{
+    unsigned long target = Pos() + nb;
+    unsigned long size = Size();
+    if(target <= size) {
+        SeekTo(target);
+        return;
+    }
+    
+    if(Pos() != size) {
+        SeekTo(size);
+    }
+    const char zeros[256] = {0};
+    for(unsigned long remaining = target - size; remaining > 0; )
+    {
+        unsigned long n = std::min<unsigned long>(remaining, sizeof(zeros));
+        Write(zeros, n);
+        remaining -= n;
+    }
+}
+
+bool REFileOutputStream::CopyTo(REOutputStream& stream)
+{
+    if(_file == NULL) return false;
+    
+    unsigned long pos = Pos();
+    unsigned long size = Size();
+    SeekTo(0);
+    
+    for(unsigned long remaining = size; remaining > 0 && !_error; )
+    {
+        unsigned long n = std::min<unsigned long>(remaining, BufferSize);
+        if(1 != ::fread(_buffer.data(), n, 1, _file)) {
+            _error = true;
+            break;
+        }
+        stream.Write(_buffer.data(), n);
+        remaining -= n;
+    }
+    
+    SeekTo(pos);
+    return !_error;
+}
+
+REJsonOutputBuffer::REJsonOutputBuffer(REOutputStream& stream)
+: _stream(stream), _pos(0)
+{
+}
+
+REJsonOutputBuffer::~REJsonOutputBuffer()
+{
+    Flush();
+}
+
+void REJsonOutputBuffer::PutN(char ch, size_t count)
+{
+    while(count > 0)
+    {
+        if(_pos == ChunkSize) _FlushChunk();
+        
+        size_t n = std::min(count, (size_t)ChunkSize - _pos);
+        memset(_chunk + _pos, ch, n);
+        _pos += n;
+        count -= n;
+    }
+}
+
+void REJsonOutputBuffer::Flush()
+{
+    if(_pos > 0) {
+        _FlushChunk();
+    }
+}
+
+void REJsonOutputBuffer::_FlushChunk()
+{
+    _stream.Write(_chunk, _pos);
+    _pos = 0;
+}
@@ -10,6 +10,7 @@
 #define _RECODER_H_
 
 #include <string>
+#include <cstdio>
 #ifdef WIN32
 #  include <cstdint>
 #endif
@@ -26,6 +27,9 @@ public:
 	virtual void SeekTo(unsigned long pos) = 0;
     virtual void Skip(unsigned long nb) = 0;
     
+    /** Hint that about size more bytes are going to be written */
+    virtual void Reserve(unsigned long /*size*/) {}
+    
 public:
 	void WriteUInt32(uint32_t val);
 	void WriteUInt16(uint16_t val);
@@ -71,6 +75,7 @@ public:
 	virtual unsigned long Pos() const;
 	virtual void SeekTo(unsigned long pos);	
     virtual void Skip(unsigned long nb);
+    virtual void Reserve(unsigned long size);
 	
 private:
 	unsigned long _pos;
@@ -78,4 +83,85 @@ private:
 };
 
 
+/** REFileOutputStream class.
+ *  Buffered output to a file. Seeking flushes pending bytes, so a header can be written
+ *  first and patched once the size of what follows it is known.
+ */
+class REFileOutputStream : public REOutputStream
+{
+public:
+    REFileOutputStream();
+    virtual ~REFileOutputStream();
+    
+    bool Open(const std::string& filename);
+    bool OpenTemporary();
+    bool Close();
+    
+    bool IsOpen() const {return _file != NULL;}
+    bool HasError() const {return _error;}
+    
+    /** Appends everything written so far to another stream */
+    bool CopyTo(REOutputStream& stream);
+    
+public:
+	virtual void Write(const char* bytes, unsigned long size);
+	virtual const char* Data() const;
+	virtual unsigned long Size() const;
+	virtual unsigned long Pos() const;
+	virtual void SeekTo(unsigned long pos);
+    virtual void Skip(unsigned long nb);
+    
+private:
+    void _Flush();
+    
+private:
+    enum {BufferSize = 65536};
+    
+    FILE* _file;
+    unsigned long _pos;         // File position of the first buffered byte
+    unsigned long _size;
+    unsigned long _buffered;
+    bool _error;
+    std::vector<char> _buffer;
+};
+
+
+/** REJsonOutputBuffer class.
+ *  Stream used by REJsonWriter: characters are gathered in a fixed chunk which is handed to
+ *  the underlying REOutputStream in a single Write when full or when flushed.
+ */
+class REJsonOutputBuffer
+{
+public:
+    typedef char Ch;
+    
+public:
+    explicit REJsonOutputBuffer(REOutputStream& stream);
+    ~REJsonOutputBuffer();
+    
+public:
+    inline void Put(char ch) {
+        if(_pos == ChunkSize) _FlushChunk();
+        _chunk[_pos++] = ch;
+    }
+    void PutN(char ch, size_t count);
+    void Flush();
+    
+    REOutputStream& Stream() {return _stream;}
+    
+private:
+    void _FlushChunk();
+    
+private:
+    enum {ChunkSize = 16384};
+    
+    REOutputStream& _stream;
+    size_t _pos;
+    char _chunk[ChunkSize];
+};
+
+// Found through ADL by rapidjson::PrettyWriter for indentation
+inline void PutN(REJsonOutputBuffer& buffer, char ch, size_t count) {buffer.PutN(ch, count);}
+
+
 #endif
@@ -0,0 +1,346 @@
+//
+//  REPatternIndex.cpp
+//  Reflow
+//
+
+#include "REPatternIndex.h"
+#include "RESong.h"
+#include "REBar.h"
+#include "RETrack.h"
+#include "REVoice.h"
+#include "REPhrase.h"
+#include "REChord.h"
+#include "RENote.h"
+
+#include <algorithm>
+
+namespace {
+
+int Interval(const REPatternIndex::Event& from, const REPatternIndex::Event& to)
+{
+    return (int)to.pitch - (int)from.pitch;
+}
+
+}
+
+REPatternIndex::REPatternIndex()
+: _valid(false)
+{
+}
+
+REPatternIndex::~REPatternIndex()
+{
+    _Clear();
+}
+
+void REPatternIndex::_Clear()
+{
+    for(Voice* voice : _voices) {
+        delete voice;
+    }
+    _voices.clear();
+    _barOffsets.clear();
+}
+
+void REPatternIndex::Invalidate()
+{
+    _valid = false;
+}
+
+unsigned int REPatternIndex::EventCount() const
+{
+    unsigned int count = 0;
+    for(const Voice* voice : _voices) {
+        count += (unsigned int)voice->events.size();
+    }
+    return count;
+}
+
+void REPatternIndex::Build(const RESong* song)
+{
+    _Clear();
+
+    REExactTick offset = 0;
+    _barOffsets.reserve(song->BarCount());
+    for(int barIndex=0; barIndex < (int)song->BarCount(); ++barIndex)
+    {
+        _barOffsets.push_back(offset);
+        offset += song->Bar(barIndex)->ExactTheoricDuration();
+    }
+
+    for(int trackIndex=0; trackIndex < (int)song->TrackCount(); ++trackIndex)
+    {
+        const RETrack* track = song->Track(trackIndex);
+        for(int voiceIndex=0; voiceIndex < (int)track->VoiceCount(); ++voiceIndex)
+        {
+            const REVoice* trackVoice = track->Voice(voiceIndex);
+
+            Voice* voice = new Voice;
+            voice->trackIndex = trackIndex;
+            voice->voiceIndex = voiceIndex;
+            voice->bars.resize(trackVoice->PhraseCount());
+            for(unsigned int barIndex=0; barIndex < trackVoice->PhraseCount(); ++barIndex) {
+                _ReadPhrase(trackVoice->Phrase(barIndex), track->IsTablature(), &voice->bars[barIndex]);
+            }
+            _RebuildEvents(voice);
+            _voices.push_back(voice);
+        }
+    }
+
+    _valid = true;
+}
+
+void REPatternIndex::InvalidatePhrases(const REConstPhraseVector& phrases)
+{
+    if(!_valid) return;
+
+    for(const REPhrase* phrase : phrases)
+    {
+        const REVoice* trackVoice = phrase->Voice();
+        const RETrack* track = phrase->Track();
+
+        bool found = false;
+        for(Voice* voice : _voices)
+        {
+            if(voice->trackIndex == track->Index() && voice->voiceIndex == trackVoice->Index()) {
+                voice->dirtyBars.insert(phrase->Index());
+                found = true;
+                break;
+            }
+        }
+
+        // A voice we did not know about
+        if(!found) {
+            _valid = false;
+            return;
+        }
+    }
+}
+
+bool REPatternIndex::_HasSameStructure(const RESong* song) const
+{
+    if(_barOffsets.size() != song->BarCount()) return false;
+
+    unsigned int voiceCount = 0;
+    for(int trackIndex=0; trackIndex < (int)song->TrackCount(); ++trackIndex)
+    {
+        const RETrack* track = song->Track(trackIndex);
+        for(int voiceIndex=0; voiceIndex < (int)track->VoiceCount(); ++voiceIndex, ++voiceCount)
+        {
+            if(voiceCount >= _voices.size()) return false;
+
+            const Voice* voice = _voices[voiceCount];
+            if(voice->trackIndex != trackIndex || voice->voiceIndex != voiceIndex ||
+               voice->bars.size() != track->Voice(voiceIndex)->PhraseCount()) {
+                return false;
+            }
+        }
+    }
+    return voiceCount == _voices.size();
+}
+
+void REPatternIndex::Update(const RESong* song)
+{
+    if(!_valid || !_HasSameStructure(song)) {
+        Build(song);
+        return;
+    }
+
+    for(Voice* voice : _voices)
+    {
+        if(voice->dirtyBars.empty()) continue;
+
+        const RETrack* track = song->Track(voice->trackIndex);
+        const REVoice* trackVoice = track->Voice(voice->voiceIndex);
+        for(int barIndex : voice->dirtyBars)
+        {
+            EventVector& events = voice->bars[barIndex];
+            events.clear();
+            _ReadPhrase(trackVoice->Phrase(barIndex), track->IsTablature(), &events);
+        }
+        voice->dirtyBars.clear();
+
+        _RebuildEvents(voice);
+    }
+}
+
+bool REPatternIndex::_ReadChord(const REChord* chord, bool tablature, Event* event)
+{
+    const RENote* highest = NULL;
+    for(unsigned int i=0; i < chord->NoteCount(); ++i)
+    {
+        const RENote* note = chord->Note(i);
+        if(note->HasFlag(RENote::TieDestination) || note->HasFlag(RENote::DeadNote)) continue;
+
+        if(highest == NULL || note->Pitch().midi > highest->Pitch().midi) {
+            highest = note;
+        }
+    }
+    if(highest == NULL) return false;
+
+    event->barIndex = chord->Phrase()->Index();
+    event->chordIndex = chord->Index();
+    event->onset = chord->ExactOffset();
+    event->pitch = highest->Pitch().midi;
+    event->string = (tablature ? highest->String() : -1);
+    event->fret = (tablature ? highest->Fret() : 0);
+    return true;
+}
+
+void REPatternIndex::_ReadPhrase(const REPhrase* phrase, bool tablature, EventVector* events)
+{
+    Event event;
+    for(const REChord* chord : phrase->Chords())
+    {
+        if(_ReadChord(chord, tablature, &event)) {
+            events->push_back(event);
+        }
+    }
+}
+
+uint32_t REPatternIndex::_GramKey(const EventVector& events, unsigned int start)
+{
+    // One byte per interval, there are no wider intervals between MIDI pitches
+    uint32_t key = 0;
+    for(unsigned int i=start; i < start + GramLength; ++i) {
+        key = (key << 8) | (uint32_t)(Interval(events[i], events[i+1]) + 128);
+    }
+    return key;
+}
+
+void REPatternIndex::_RebuildEvents(Voice* voice)
+{
+    voice->events.clear();
+    for(unsigned int barIndex=0; barIndex < voice->bars.size(); ++barIndex)
+    {
+        REExactTick barOffset = _barOffsets[barIndex];
+        for(const Event& event : voice->bars[barIndex])
+        {
+            voice->events.push_back(event);
+            voice->events.back().onset += barOffset;
+        }
+    }
+
+    voice->grams.clear();
+    const EventVector& events = voice->events;
+    for(unsigned int start=0; start + GramLength < events.size(); ++start) {
+        voice->grams[_GramKey(events, start)].push_back(start);
+    }
+}
+
+bool REPatternIndex::_MatchesAt(const EventVector& events, unsigned int start, const EventVector& pattern, unsigned long flags)
+{
+    if(start + pattern.size() > events.size()) return false;
+
+    for(unsigned int i=1; i < pattern.size(); ++i)
+    {
+        const Event& previous = events[start + i - 1];
+        const Event& event = events[start + i];
+
+        if(Interval(previous, event) != Interval(pattern[i-1], pattern[i])) {
+            return false;
+        }
+
+        if((flags & MatchRhythm) && (event.onset - previous.onset) != (pattern[i].onset - pattern[i-1].onset)) {
+            return false;
+        }
+
+        if(flags & MatchShape)
+        {
+            if(event.string < 0 || pattern[i].string < 0) return false;
+            if(event.string - previous.string != pattern[i].string - pattern[i-1].string ||
+               event.fret - previous.fret != pattern[i].fret - pattern[i-1].fret) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void REPatternIndex::_FindMatchesInVoice(const Voice* voice, const EventVector& pattern, unsigned long flags, MatchVector* matches) const
+{
+    const EventVector& events = voice->events;
+    if(events.size() < pattern.size()) return;
+
+    std::vector<uint32_t> candidates;
+    if(pattern.size() > GramLength)
+    {
+        // Only verify where the rarest run of intervals of the pattern occurs
+        const std::vector<uint32_t>* rarest = NULL;
+        unsigned int rarestStart = 0;
+        for(unsigned int start=0; start + GramLength < pattern.size(); ++start)
+        {
+            auto it = voice->grams.find(_GramKey(pattern, start));
+            if(it == voice->grams.end()) return;
+
+            if(rarest == NULL || it->second.size() < rarest->size()) {
+                rarest = &it->second;
+                rarestStart = start;
+            }
+        }
+
+        candidates.reserve(rarest->size());
+        for(uint32_t position : *rarest) {
+            if(position >= rarestStart) candidates.push_back(position - rarestStart);
+        }
+    }
+    else
+    {
+        // Too short for the table
+        candidates.resize(events.size() - pattern.size() + 1);
+        for(unsigned int i=0; i < candidates.size(); ++i) {
+            candidates[i] = i;
+        }
+    }
+
+    for(uint32_t start : candidates)
+    {
+        if(!_MatchesAt(events, start, pattern, flags)) continue;
+
+        const Event& first = events[start];
+        const Event& last = events[start + pattern.size() - 1];
+
+        Match match;
+        match.trackIndex = voice->trackIndex;
+        match.voiceIndex = voice->voiceIndex;
+        match.firstBarIndex = first.barIndex;
+        match.firstChordIndex = first.chordIndex;
+        match.lastBarIndex = last.barIndex;
+        match.lastChordIndex = last.chordIndex;
+        match.onset = first.onset;
+        matches->push_back(match);
+    }
+}
+
+void REPatternIndex::FindMatches(const EventVector& pattern, unsigned long flags, MatchVector* matches) const
+{
+    if(pattern.size() < 2) return;
+
+    for(const Voice* voice : _voices) {
+        _FindMatchesInVoice(voice, pattern, flags, matches);
+    }
+    std::sort(matches->begin(), matches->end());
+}
+
+void REPatternIndex::EventsOfChords(const REConstChordVector& chords, EventVector* events)
+{
+    // Onsets are counted from the first bar of the song, like those of the index
+    int barIndex = 0;
+    REExactTick barOffset = 0;
+
+    for(const REChord* chord : chords)
+    {
+        const REPhrase* phrase = chord->Phrase();
+        const REBar* bar = phrase->Bar();
+        for(; barIndex < bar->Index(); ++barIndex) {
+            barOffset += bar->Song()->Bar(barIndex)->ExactTheoricDuration();
+        }
+
+        Event event;
+        if(_ReadChord(chord, phrase->Track()->IsTablature(), &event))
+        {
+            event.onset += barOffset;
+            events->push_back(event);
+        }
+    }
+}
@@ -0,0 +1,123 @@
+//
+//  REPatternIndex.h
+//  Reflow
+//
+
+#ifndef __Reflow__REPatternIndex__
+#define __Reflow__REPatternIndex__
+
+#include "RETypes.h"
+
+#include <unordered_map>
+
+/** REPatternIndex class.
+ *  Finds a melodic and rhythmic pattern in every voice of every track of a song.
+ *
+ *  Each voice is read as a stream of note onsets: the highest note struck by every chord, leaving out rests
+ *  and chords that only hold tied notes. Patterns are compared by pitch intervals, so a passage is found in any
+ *  key, and optionally by the durations between onsets and by string and fret moves.
+ *
+ *  Every run of GramLength consecutive intervals is listed in a table per voice, so that a search only verifies
+ *  the places where the rarest run of the pattern occurs. Edited phrases are read again on the next Update, and
+ *  the table of their voice is rebuilt from the onsets kept for the other bars.
+ */
+class REPatternIndex
+{
+public:
+    enum {
+        GramLength = 3              // Intervals per table key
+    };
+
+    enum MatchFlags {
+        MatchRhythm = 0x01,         // Durations between onsets are equal
+        MatchShape  = 0x02          // String and fret moves are equal, on tablature tracks only
+    };
+
+    /** A note onset of a searched pattern or of an indexed voice */
+    struct Event
+    {
+        REExactTick onset;          // From the start of the first bar
+        int barIndex;
+        int chordIndex;
+        int8_t pitch;
+        int8_t string;              // -1 when the track has no tablature
+        int8_t fret;
+    };
+    typedef std::vector<Event> EventVector;
+
+    struct Match
+    {
+        int trackIndex;
+        int voiceIndex;
+        int firstBarIndex;
+        int firstChordIndex;
+        int lastBarIndex;
+        int lastChordIndex;
+        REExactTick onset;
+
+        /** Song order */
+        bool operator<(const Match& rhs) const {
+            if(onset != rhs.onset) return onset < rhs.onset;
+            if(trackIndex != rhs.trackIndex) return trackIndex < rhs.trackIndex;
+            return voiceIndex < rhs.voiceIndex;
+        }
+    };
+    typedef std::vector<Match> MatchVector;
+
+public:
+    REPatternIndex();
+    ~REPatternIndex();
+
+public:
+    /** Reads every phrase of the song */
+    void Build(const RESong* song);
+
+    /** The whole song will be read again by the next Update */
+    void Invalidate();
+
+    /** These phrases will be read again by the next Update */
+    void InvalidatePhrases(const REConstPhraseVector& phrases);
+
+    /** Reads what was invalidated since the last Build or Update */
+    void Update(const RESong* song);
+
+    bool IsValid() const {return _valid;}
+    unsigned int EventCount() const;
+
+public:
+    /** Matches of a pattern of at least two events, in song order */
+    void FindMatches(const EventVector& pattern, unsigned long flags, MatchVector* matches) const;
+
+    /** Pattern made of the onsets of consecutive chords of a voice, in song order */
+    static void EventsOfChords(const REConstChordVector& chords, EventVector* events);
+
+private:
+    struct Voice
+    {
+        int trackIndex;
+        int voiceIndex;
+        std::vector<EventVector> bars;          // Onsets from the start of their bar
+        REIntSet dirtyBars;
+        EventVector events;                     // Onsets of all bars, from the start of the first one
+        std::unordered_map<uint32_t, std::vector<uint32_t> > grams;
+    };
+    typedef std::vector<Voice*> VoiceVector;
+
+private:
+    void _Clear();
+    bool _HasSameStructure(const RESong* song) const;
+    void _RebuildEvents(Voice* voice);
+    void _FindMatchesInVoice(const Voice* voice, const EventVector& pattern, unsigned long flags, MatchVector* matches) const;
+
+    static void _ReadPhrase(const REPhrase* phrase, bool tablature, EventVector* events);
+    static bool _ReadChord(const REChord* chord, bool tablature, Event* event);
+    static bool _MatchesAt(const EventVector& events, unsigned int start, const EventVector& pattern, unsigned long flags);
+    static uint32_t _GramKey(const EventVector& events, unsigned int start);
+
+private:
+    VoiceVector _voices;
+    std::vector<REExactTick> _barOffsets;
+    bool _valid;
+};
+
+#endif /* defined(__Reflow__REPatternIndex__) */
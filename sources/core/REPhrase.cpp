@@ -20,7 +20,7 @@
 #include "REStandardNotationCompiler.h"
 
 REPhrase::REPhrase()
-: _parent(0), _index(-1)
+: _parent(0), _index(-1), _duration(0)
 {
 }
 
@@ -142,7 +142,7 @@ void REPhrase::Refresh(bool fixTieFlags)
 {
     RETrack* track = Track();
     
-    RETimeDiv offset(0);
+    REExactTick offset = 0;
     for(unsigned int i=0; i<_chords.size(); ++i) 
     {
         REChord* chord = _chords[i];
@@ -164,7 +164,7 @@ void REPhrase::Refresh(bool fixTieFlags)
             _CalculatePitchesFromTablature(chord);
         }
         chord->_offset = offset;
-        offset += chord->Duration();
+        offset += chord->ExactDuration();
     }
     _duration = offset;
     
@@ -173,10 +173,18 @@ void REPhrase::Refresh(bool fixTieFlags)
     }
     else {
         _CalculateStandardRepresentation(false);
-        _CalculateStandardRepresentation(true);
+        
+        // Without a transposing interval both representations are the same
+        if(track->TransposingInterval() == REPitchClass::C) {
+            _CopyConcertRepresentation();
+        }
+        else {
+            _CalculateStandardRepresentation(true);
+        }
     }
     _CalculateBeamingGroups();
     _CalculateTupletGroups();
+    _CalculatePitchSummary();
     
     // Fix Tie flags
 	if(fixTieFlags) {
@@ -184,6 +192,29 @@ void REPhrase::Refresh(bool fixTieFlags)
 	}
 }
 
+void REPhrase::_CalculatePitchSummary()
+{
+    REPitchSummary summary;
+    uint32_t hash = 2166136261u;
+    
+    for(const REChord* chord : _chords)
+    {
+        hash = (hash ^ (uint32_t)chord->OffsetInTicks()) * 16777619u;
+        hash = (hash ^ (uint32_t)chord->DurationInTicks()) * 16777619u;
+        
+        for(const RENote* note : chord->Notes())
+        {
+            int8_t midi = note->Pitch().midi;
+            if(midi < summary.minPitch) summary.minPitch = midi;
+            if(midi > summary.maxPitch) summary.maxPitch = midi;
+            ++summary.noteCount;
+            hash = (hash ^ (uint8_t)midi) * 16777619u;
+        }
+    }
+    summary.checksum = hash;
+    _pitchSummary = summary;
+}
+
 bool REPhrase::_FixTieFlags()
 {
     bool modifiedPreviousSibling = false;
@@ -255,9 +286,10 @@ const REChord* REPhrase::ChordAtTick(long tick) const
 
 const REChord* REPhrase::ChordAtTimeDiv(const RETimeDiv& div) const
 {
+    REExactTick offset = Reflow::TimeDivToExactTicks(div);
     for(int i=0; i<_chords.size(); ++i) {
         const REChord* chord = Chord(i);
-        if(chord->Offset() == div) {
+        if(chord->ExactOffset() == offset) {
             return chord;
         }
     }
@@ -374,6 +406,20 @@ void REPhrase::_CalculateStandardRepresentation(bool transposed)
     }
 }
 
+void REPhrase::_CopyConcertRepresentation()
+{
+    for(REChord* chord : _chords)
+    {
+        for(RENote* note : chord->Notes())
+        {
+            for(REGraceNote* graceNote : note->GraceNotes()) {
+                graceNote->Representation(true) = graceNote->Representation(false);
+            }
+            note->Representation(true) = note->Representation(false);
+        }
+    }
+}
+
 RENotePitch REPhrase::PitchFromStd(unsigned int chordIndex_, int lineIndex, bool transposingScore) const
 {
     REStandardNotationCompiler notation;
@@ -599,20 +645,20 @@ void REPhrase::_GroupTupletElements(unsigned int firstIndex, unsigned int lastIn
     lastChord->SetFlag(REChord::TupletGroupEnd);
 }
 
-const RETimeDiv& REPhrase::Duration() const
+RETimeDiv REPhrase::Duration() const
 {
-    return _duration;
+    return Reflow::ExactTicksToTimeDiv(_duration);
 }
 
 unsigned long REPhrase::DurationInTicks() const
 {
-    return Reflow::TimeDivToTicks(Duration());
+    return Reflow::ExactTicksToTicks(_duration);
 }
 
 bool REPhrase::IsBarComplete() const
 {
     if(_parent) {
-        return Locator().Bar()->TheoricDuration() == Duration();
+        return Locator().Bar()->ExactTheoricDuration() == _duration;
     }
     else return false;
 }
@@ -620,7 +666,7 @@ bool REPhrase::IsBarComplete() const
 bool REPhrase::IsBarCompleteOrExceeded() const
 {
     if(_parent) {
-        return Duration() >= Locator().Bar()->TheoricDuration();
+        return _duration >= Locator().Bar()->ExactTheoricDuration();
     }
     else return false;
 }
@@ -19,6 +19,7 @@ class REPhrase
 	friend class REVoice;
     friend class REChord;
 	friend class RESongController;
+    friend class RESong;
     friend class REArchive;
     
 public:
@@ -48,6 +49,8 @@ public:
     bool IsEmpty() const;
     bool IsEmptyOrRest() const;
     
+    const REPitchSummary& PitchSummary() const {return _pitchSummary;}
+    
 	const REVoice* Voice() const {return _parent;}
 	REVoice* Voice() {return _parent;}
     
@@ -70,7 +73,8 @@ public:
     REConstChordPair ChordsSurroundingTick(long tick) const;
     void ChordsSurroundingTick(long tick, const REChord** chordLeft, const REChord** chordRight) const;
     
-    const RETimeDiv& Duration() const;
+    RETimeDiv Duration() const;
+    REExactTick ExactDuration() const {return _duration;}
     unsigned long DurationInTicks() const;
     bool IsBarComplete() const;
     bool IsBarCompleteOrExceeded() const;
@@ -115,11 +119,13 @@ private:
 	void _UpdateIndices();
     void _CalculatePitchesFromTablature(REChord* chord);
     void _CalculateStandardRepresentation(bool transposed=false);
+    void _CopyConcertRepresentation();
     void _CalculateDrumsRepresentation();
     void _CalculateBeamingGroups();
 	void _BeamElements(int firstIndex, int lastIndex);
     void _GroupTupletElements(unsigned int firstIndex, unsigned int lastIndex);
     void _CalculateTupletGroups();
+    void _CalculatePitchSummary();
 	bool _FixTieFlags();
     
 private:
@@ -127,10 +133,11 @@ private:
 	REChordVector _chords;
     REOttaviaRangeModifier _ottaviaModifier;
     REPhraseChordDiagramVector _chordDiagrams;
+    REPitchSummary _pitchSummary;
 	int _index;
     uint32_t _flags;
     
-    mutable RETimeDiv _duration;
+    mutable REExactTick _duration;
 };
 
 
@@ -15,6 +15,7 @@ class REPlaylistBar
 {
     friend class RESong;
     friend class RESequencer;
+    friend class REPlaylistIndex;
     
 public:
     REPlaylistBar();
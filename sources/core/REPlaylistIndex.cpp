@@ -0,0 +1,111 @@
+//
+//  REPlaylistIndex.cpp
+//  Reflow
+//
+
+#include "REPlaylistIndex.h"
+#include "REPlaylistBar.h"
+
+#include <algorithm>
+
+REPlaylistIndex::REPlaylistIndex()
+: _maxExtensionBefore(0), _maxExtensionAfter(0)
+{
+}
+
+void REPlaylistIndex::Clear()
+{
+    _firstOccurences.clear();
+    _nextOccurences.clear();
+    _ticks.clear();
+    _maxExtensionBefore = 0;
+    _maxExtensionAfter = 0;
+}
+
+void REPlaylistIndex::Build(const REPlaylistBarVector& playlist, int barCount)
+{
+    Clear();
+
+    int nbBars = (int)playlist.size();
+    _firstOccurences.resize(barCount, -1);
+    _nextOccurences.resize(nbBars, -1);
+    _ticks.reserve(nbBars + 1);
+
+    // Walk backwards so that each bar links to its following occurrence
+    std::vector<int> lastSeen(barCount, -1);
+    for(int i=nbBars-1; i>=0; --i)
+    {
+        int barIndex = playlist[i].IndexInSong();
+        if(barIndex < 0 || barIndex >= barCount) continue;
+
+        _nextOccurences[i] = lastSeen[barIndex];
+        lastSeen[barIndex] = i;
+    }
+    _firstOccurences.swap(lastSeen);
+
+    for(const REPlaylistBar& pbar : playlist) {
+        _ticks.push_back((int32_t)pbar.Tick());
+    }
+    _ticks.push_back(playlist.empty() ? 0 : (int32_t)(playlist.back().Tick() + playlist.back().Duration()));
+
+    RefreshExtents(playlist);
+}
+
+void REPlaylistIndex::RefreshExtents(const REPlaylistBarVector& playlist)
+{
+    _maxExtensionBefore = 0;
+    _maxExtensionAfter = 0;
+    for(const REPlaylistBar& pbar : playlist)
+    {
+        int32_t before = pbar._tick - pbar._extendedTick;
+        int32_t after = (pbar._extendedTick + pbar._extendedDuration) - (pbar._tick + pbar._duration);
+        if(before > _maxExtensionBefore) _maxExtensionBefore = before;
+        if(after > _maxExtensionAfter) _maxExtensionAfter = after;
+    }
+}
+
+int REPlaylistIndex::FirstOccurenceOfBar(int barIndex) const
+{
+    if(barIndex < 0 || barIndex >= (int)_firstOccurences.size()) return -1;
+    return _firstOccurences[barIndex];
+}
+
+int REPlaylistIndex::NextOccurenceOfBar(int indexInPlaylist) const
+{
+    if(indexInPlaylist < 0 || indexInPlaylist >= (int)_nextOccurences.size()) return -1;
+    return _nextOccurences[indexInPlaylist];
+}
+
+int REPlaylistIndex::IndexInPlaylistAtTick(unsigned long tick) const
+{
+    if(IsEmpty() || tick >= (unsigned long)_ticks.back()) return -1;
+
+    auto it = std::upper_bound(_ticks.begin(), _ticks.end() - 1, (int32_t)tick);
+    return (int)(it - _ticks.begin()) - 1;
+}
+
+bool REPlaylistIndex::FindCandidatesInTickRange(double t0, double t1, int* firstIndex, int* lastIndex) const
+{
+    if(IsEmpty()) return false;
+
+    // One tick of margin absorbs the rounding of the conversion to quarters
+    const double ppq = (double)REFLOW_PULSES_PER_QUARTER;
+    double lowest = t0 - (double)(_maxExtensionAfter + 1) / ppq;
+    double highest = t1 + (double)(_maxExtensionBefore + 1) / ppq;
+
+    // First bar ending at or after lowest, last bar starting before highest
+    auto first = std::lower_bound(_ticks.begin() + 1, _ticks.end(), lowest, [ppq](int32_t tick, double t) {
+        return (double)tick / ppq < t;
+    });
+    auto last = std::lower_bound(_ticks.begin(), _ticks.end() - 1, highest, [ppq](int32_t tick, double t) {
+        return (double)tick / ppq < t;
+    });
+
+    int firstBar = (int)(first - _ticks.begin()) - 1;
+    int lastBar = (int)(last - _ticks.begin()) - 1;
+    if(firstBar > lastBar) return false;
+
+    *firstIndex = firstBar;
+    *lastIndex = lastBar;
+    return true;
+}
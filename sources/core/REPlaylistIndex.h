@@ -0,0 +1,52 @@
+//
+//  REPlaylistIndex.h
+//  Reflow
+//
+
+#ifndef __Reflow__REPlaylistIndex__
+#define __Reflow__REPlaylistIndex__
+
+#include "RETypes.h"
+
+/** REPlaylistIndex class.
+ *  Lookup tables over an unrolled playlist: first and next occurrence of each song bar, and the start
+ *  tick of every playlist bar so that the bar playing at a given tick is found by binary search.
+ *
+ *  Bars of the playlist may have an extended range (notes starting before or ending after the bar); the
+ *  largest extensions are kept so that the bars intersecting a tick range can be bounded the same way.
+ */
+class REPlaylistIndex
+{
+public:
+    REPlaylistIndex();
+
+public:
+    void Build(const REPlaylistBarVector& playlist, int barCount);
+    void RefreshExtents(const REPlaylistBarVector& playlist);
+    void Clear();
+
+    bool IsEmpty() const {return _ticks.size() <= 1;}
+
+    /** Index in playlist of the first occurrence of a song bar, -1 if the bar is never played. */
+    int FirstOccurenceOfBar(int barIndex) const;
+
+    /** Index in playlist of the next occurrence of the same song bar, -1 if it is the last one. */
+    int NextOccurenceOfBar(int indexInPlaylist) const;
+
+    /** Index in playlist of the bar whose nominal range holds tick, -1 if tick is past the end of the playlist. */
+    int IndexInPlaylistAtTick(unsigned long tick) const;
+
+    /** Range of playlist bars whose extended range may intersect [t0, t1], t0 and t1 being in quarters.
+     *  Returns false if there is none.
+     */
+    bool FindCandidatesInTickRange(double t0, double t1, int* firstIndex, int* lastIndex) const;
+
+private:
+    std::vector<int> _firstOccurences;
+    std::vector<int> _nextOccurences;
+    std::vector<int32_t> _ticks;            // start tick of each playlist bar, followed by the end tick
+    int32_t _maxExtensionBefore;
+    int32_t _maxExtensionAfter;
+};
+
+#endif /* defined(__Reflow__REPlaylistIndex__) */
@@ -0,0 +1,358 @@
+//
+//  RERecordingPainter.cpp
+//  Reflow
+//
+
+#include "RERecordingPainter.h"
+#include "REDisplayList.h"
+#include "REBezierPath.h"
+
+#include <cmath>
+
+typedef REDisplayList::Command REDisplayCommand;
+
+RERecordingPainter::RERecordingPainter(REDisplayList* displayList)
+: REPainter(), _displayList(displayList), _pathEmpty(true), _batchedFont(-1), _batchedFlags(0), _batchedSize(0.0)
+{
+}
+
+RERecordingPainter::~RERecordingPainter()
+{
+}
+
+RERect RERecordingPainter::_MapRect(const RERect& rc) const
+{
+    REPoint a = _transform.Transform(rc.origin);
+    REPoint b = _transform.Transform(REPoint(rc.Right(), rc.Bottom()));
+    return RERect::FromPoints(a, b);
+}
+
+RERect RERecordingPainter::_MapPoints(const REPoint* points, int count) const
+{
+    REPoint p0 = _transform.Transform(points[0]);
+    float x0 = p0.x, x1 = p0.x, y0 = p0.y, y1 = p0.y;
+    for(int i=1; i<count; ++i)
+    {
+        REPoint p = _transform.Transform(points[i]);
+        x0 = std::min(x0, p.x); x1 = std::max(x1, p.x);
+        y0 = std::min(y0, p.y); y1 = std::max(y1, p.y);
+    }
+    return RERect(x0, y0, x1 - x0, y1 - y0);
+}
+
+void RERecordingPainter::_AddPathPoint(const REPoint& pt)
+{
+    RERect rc = _MapPoints(&pt, 1);
+    _pathBounds = (_pathEmpty ? rc : _pathBounds.Union(rc));
+    _pathEmpty = false;
+}
+
+#pragma mark - State
+
+void RERecordingPainter::Save()
+{
+    _transformStack.push_back(_transform);
+    _displayList->_AddCommand(REDisplayCommand(REDisplayList::SaveOp));
+}
+
+void RERecordingPainter::Restore()
+{
+    if(!_transformStack.empty()) {
+        _transform = _transformStack.back();
+        _transformStack.pop_back();
+    }
+    _displayList->_AddCommand(REDisplayCommand(REDisplayList::RestoreOp));
+}
+
+void RERecordingPainter::Translate(float dx, float dy)
+{
+    _transform.tx += _transform.m11 * dx;
+    _transform.ty += _transform.m22 * dy;
+
+    REDisplayCommand cmd(REDisplayList::TranslateOp);
+    cmd.v[0] = dx; cmd.v[1] = dy;
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::Scale(float sx, float sy)
+{
+    _transform.m11 *= sx;
+    _transform.m22 *= sy;
+
+    REDisplayCommand cmd(REDisplayList::ScaleOp);
+    cmd.v[0] = sx; cmd.v[1] = sy;
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::SetStrokeColor(const REColor& color)
+{
+    REDisplayCommand cmd(REDisplayList::SetStrokeColorOp);
+    cmd.v[0] = color.r; cmd.v[1] = color.g; cmd.v[2] = color.b; cmd.v[3] = color.a;
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::SetFillColor(const REColor& color)
+{
+    REDisplayCommand cmd(REDisplayList::SetFillColorOp);
+    cmd.v[0] = color.r; cmd.v[1] = color.g; cmd.v[2] = color.b; cmd.v[3] = color.a;
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::SetLineDash(const REReal* lengths, int count, float phase)
+{
+    REDisplayCommand cmd(REDisplayList::SetLineDashOp);
+    cmd.ref0 = _displayList->_AddDashes(lengths, count);
+    cmd.flags = count;
+    cmd.v[0] = phase;
+    _displayList->_AddCommand(cmd);
+}
+
+#pragma mark - Shapes
+
+void RERecordingPainter::FillRect(const RERect& rc)
+{
+    REDisplayCommand cmd(REDisplayList::FillRectOp);
+    cmd.v[0] = rc.origin.x; cmd.v[1] = rc.origin.y; cmd.v[2] = rc.size.w; cmd.v[3] = rc.size.h;
+    cmd.bounds = _MapRect(rc);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::FillQuad(const REPoint* points)
+{
+    REDisplayCommand cmd(REDisplayList::FillQuadOp);
+    for(int i=0; i<4; ++i) {
+        cmd.v[2*i] = points[i].x;
+        cmd.v[2*i+1] = points[i].y;
+    }
+    cmd.bounds = _MapPoints(points, 4);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::StrokeLine(const REPoint& pt1, const REPoint& pt2)
+{
+    REDisplayCommand cmd(REDisplayList::StrokeLineOp);
+    cmd.v[0] = pt1.x; cmd.v[1] = pt1.y; cmd.v[2] = pt2.x; cmd.v[3] = pt2.y;
+
+    REPoint points[2] = {pt1, pt2};
+    cmd.bounds = _MapPoints(points, 2).Inset(-1.0, -1.0, -1.0, -1.0);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::StrokeHorizontalLine(float x0, float x1, float y)
+{
+    StrokeLine(REPoint(x0, y), REPoint(x1, y));
+}
+
+void RERecordingPainter::StrokeVerticalLine(float x, float y0, float y1)
+{
+    StrokeLine(REPoint(x, y0), REPoint(x, y1));
+}
+
+void RERecordingPainter::StrokeRect(const RERect& rc)
+{
+    REDisplayCommand cmd(REDisplayList::StrokeRectOp);
+    cmd.v[0] = rc.origin.x; cmd.v[1] = rc.origin.y; cmd.v[2] = rc.size.w; cmd.v[3] = rc.size.h;
+    cmd.bounds = _MapRect(rc).Inset(-1.0, -1.0, -1.0, -1.0);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::StrokeRect(const RERect& rc, float lineWidth)
+{
+    REDisplayCommand cmd(REDisplayList::StrokeRectWithWidthOp);
+    cmd.v[0] = rc.origin.x; cmd.v[1] = rc.origin.y; cmd.v[2] = rc.size.w; cmd.v[3] = rc.size.h;
+    cmd.v[4] = lineWidth;
+    float m = 0.5 * lineWidth * std::max(fabsf(_transform.m11), fabsf(_transform.m22)) + 1.0;
+    cmd.bounds = _MapRect(rc).Inset(-m, -m, -m, -m);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::StrokePath(const REBezierPath& path)
+{
+    REDisplayCommand cmd(REDisplayList::StrokePathOp);
+    cmd.ref0 = _displayList->_AddPath(path);
+    cmd.bounds = _MapRect(path.BoundingBox()).Inset(-1.0, -1.0, -1.0, -1.0);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::FillPath(const REBezierPath& path)
+{
+    REDisplayCommand cmd(REDisplayList::FillPathOp);
+    cmd.ref0 = _displayList->_AddPath(path);
+    cmd.bounds = _MapRect(path.BoundingBox());
+    _displayList->_AddCommand(cmd);
+}
+
+#pragma mark - Path Construction
+
+void RERecordingPainter::PathBegin()
+{
+    _pathEmpty = true;
+    _displayList->_AddCommand(REDisplayCommand(REDisplayList::PathBeginOp));
+}
+
+void RERecordingPainter::PathClose()
+{
+    _displayList->_AddCommand(REDisplayCommand(REDisplayList::PathCloseOp));
+}
+
+void RERecordingPainter::PathStroke()
+{
+    REDisplayCommand cmd(REDisplayList::PathStrokeOp);
+    if(!_pathEmpty) cmd.bounds = _pathBounds.Inset(-1.0, -1.0, -1.0, -1.0);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::PathFill()
+{
+    REDisplayCommand cmd(REDisplayList::PathFillOp);
+    if(!_pathEmpty) cmd.bounds = _pathBounds;
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::PathMoveToPoint(const REPoint &pt)
+{
+    PathMoveToPoint(pt.x, pt.y);
+}
+
+void RERecordingPainter::PathMoveToPoint(float x, float y)
+{
+    REDisplayCommand cmd(REDisplayList::PathMoveToOp);
+    cmd.v[0] = x; cmd.v[1] = y;
+    _AddPathPoint(REPoint(x, y));
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::PathLineToPoint(const REPoint& pt)
+{
+    PathLineToPoint(pt.x, pt.y);
+}
+
+void RERecordingPainter::PathLineToPoint(float x, float y)
+{
+    REDisplayCommand cmd(REDisplayList::PathLineToOp);
+    cmd.v[0] = x; cmd.v[1] = y;
+    _AddPathPoint(REPoint(x, y));
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::PathCurveToPoint(const REPoint& pt, const REPoint& cp1, const REPoint& cp2)
+{
+    REDisplayCommand cmd(REDisplayList::PathCurveToOp);
+    cmd.v[0] = pt.x; cmd.v[1] = pt.y;
+    cmd.v[2] = cp1.x; cmd.v[3] = cp1.y;
+    cmd.v[4] = cp2.x; cmd.v[5] = cp2.y;
+
+    // The control points hull contains the curve
+    _AddPathPoint(pt);
+    _AddPathPoint(cp1);
+    _AddPathPoint(cp2);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::PathQuadCurveToPoint(const REPoint& pt, const REPoint& cp)
+{
+    REDisplayCommand cmd(REDisplayList::PathQuadCurveToOp);
+    cmd.v[0] = pt.x; cmd.v[1] = pt.y;
+    cmd.v[2] = cp.x; cmd.v[3] = cp.y;
+    _AddPathPoint(pt);
+    _AddPathPoint(cp);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::PathAddEllipseInRect(const RERect& rect)
+{
+    REDisplayCommand cmd(REDisplayList::PathAddEllipseOp);
+    cmd.v[0] = rect.origin.x; cmd.v[1] = rect.origin.y; cmd.v[2] = rect.size.w; cmd.v[3] = rect.size.h;
+    _AddPathPoint(rect.origin);
+    _AddPathPoint(REPoint(rect.Right(), rect.Bottom()));
+    _displayList->_AddCommand(cmd);
+}
+
+#pragma mark - Text
+
+void RERecordingPainter::DrawText(const std::string& textUTF8, const REPoint& pt, const std::string& fontNameUTF8, unsigned int flags, float size, const REColor& color)
+{
+    REDisplayCommand cmd(REDisplayList::DrawTextOp);
+    cmd.ref0 = _displayList->_InternString(textUTF8);
+    cmd.ref1 = _displayList->_InternString(fontNameUTF8);
+    cmd.flags = flags;
+    cmd.v[0] = pt.x; cmd.v[1] = pt.y; cmd.v[2] = size;
+    cmd.v[3] = color.r; cmd.v[4] = color.g; cmd.v[5] = color.b; cmd.v[6] = color.a;
+
+    RESize textSize = SizeOfText(textUTF8, fontNameUTF8, flags, size);
+    cmd.bounds = _MapRect(RERect(pt, textSize));
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::DrawTextInRect(const std::string& textUTF8, const RERect& rect, const std::string& fontNameUTF8, unsigned int flags, float size, const REColor& color)
+{
+    REDisplayCommand cmd(REDisplayList::DrawTextInRectOp);
+    cmd.ref0 = _displayList->_InternString(textUTF8);
+    cmd.ref1 = _displayList->_InternString(fontNameUTF8);
+    cmd.flags = flags;
+    cmd.v[0] = rect.origin.x; cmd.v[1] = rect.origin.y; cmd.v[2] = rect.size.w; cmd.v[3] = rect.size.h;
+    cmd.v[4] = size;
+    cmd.v[5] = color.r; cmd.v[6] = color.g; cmd.v[7] = color.b; cmd.v[8] = color.a;
+    cmd.bounds = _MapRect(rect);
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::BeginTextBatched(const std::string& fontNameUTF8, unsigned int flags, float size, const REColor& color)
+{
+    _batchedFont = _displayList->_InternString(fontNameUTF8);
+    _batchedFontName = fontNameUTF8;
+    _batchedFlags = flags;
+    _batchedSize = size;
+
+    REDisplayCommand cmd(REDisplayList::BeginTextBatchedOp);
+    cmd.ref1 = _batchedFont;
+    cmd.flags = flags;
+    cmd.v[0] = size;
+    cmd.v[1] = color.r; cmd.v[2] = color.g; cmd.v[3] = color.b; cmd.v[4] = color.a;
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::DrawTextBatched(const std::string& textUTF8, const REPoint& pt)
+{
+    REDisplayCommand cmd(REDisplayList::DrawTextBatchedOp);
+    cmd.ref0 = _displayList->_InternString(textUTF8);
+    cmd.ref1 = _batchedFont;
+    cmd.v[0] = pt.x; cmd.v[1] = pt.y;
+
+    RESize textSize = SizeOfText(textUTF8, _batchedFontName, _batchedFlags, _batchedSize);
+    cmd.bounds = _MapRect(RERect(pt, textSize));
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::EndTextBatched()
+{
+    _displayList->_AddCommand(REDisplayCommand(REDisplayList::EndTextBatchedOp));
+}
+
+#pragma mark - Musical Symbols
+
+void RERecordingPainter::DrawMusicSymbol(const char* symbol, const REPoint& pt, float size)
+{
+    DrawMusicSymbol(symbol, pt.x, pt.y, size);
+}
+
+void RERecordingPainter::DrawMusicSymbol(const char* symbol, float x, float y, float size)
+{
+    REDisplayCommand cmd(REDisplayList::DrawMusicSymbolOp);
+    cmd.ref0 = _displayList->_InternString(symbol);
+    cmd.v[0] = x; cmd.v[1] = y; cmd.v[2] = size;
+    cmd.bounds = _MapRect(BoundingBoxOfMusicSymbol(symbol, size).Translated(x, y));
+    _displayList->_AddCommand(cmd);
+}
+
+void RERecordingPainter::DrawMusicSymbolFlipped(const char* symbol, float x, float y, float size)
+{
+    REDisplayCommand cmd(REDisplayList::DrawMusicSymbolFlippedOp);
+    cmd.ref0 = _displayList->_InternString(symbol);
+    cmd.v[0] = x; cmd.v[1] = y; cmd.v[2] = size;
+
+    RERect box = BoundingBoxOfMusicSymbol(symbol, size);
+    RERect flipped(box.origin.x, -box.Bottom(), box.size.w, box.size.h);
+    cmd.bounds = _MapRect(box.Union(flipped).Translated(x, y));
+    _displayList->_AddCommand(cmd);
+}
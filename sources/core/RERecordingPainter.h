@@ -0,0 +1,93 @@
+//
+//  RERecordingPainter.h
+//  Reflow
+//
+
+#ifndef __Reflow__RERecordingPainter__
+#define __Reflow__RERecordingPainter__
+
+#include "REPainter.h"
+
+class REDisplayList;
+
+/** RERecordingPainter class.
+ *  Painter without any device: drawing calls are appended to a REDisplayList, which can later be
+ *  replayed to any painter. Transforms are tracked so that each command gets its bounds in list space.
+ */
+class RERecordingPainter : public REPainter
+{
+public:
+    RERecordingPainter(REDisplayList* displayList);
+    virtual ~RERecordingPainter();
+
+public:
+    virtual void FillRect(const RERect& rc);
+    virtual void FillQuad(const REPoint* points);
+
+    virtual void StrokeLine(const REPoint& pt1, const REPoint& pt2);
+    virtual void StrokeHorizontalLine(float x0, float x1, float y);
+    virtual void StrokeVerticalLine(float x, float y0, float y1);
+
+    virtual void SetStrokeColor(const REColor& color);
+    virtual void SetFillColor(const REColor& color);
+
+    virtual void DrawMusicSymbol(const char* symbol, float x, float y, float size);
+    virtual void DrawMusicSymbol(const char* symbol, const REPoint& pt, float size);
+    virtual void DrawMusicSymbolFlipped(const char* symbol, float x, float y, float size);
+
+    virtual void Save();
+    virtual void Restore();
+
+    virtual void Translate(float dx, float dy);
+    virtual void Scale(float sx, float sy);
+
+    virtual void StrokePath(const REBezierPath& path);
+    virtual void FillPath(const REBezierPath& path);
+
+    virtual void PathBegin();
+    virtual void PathClose();
+    virtual void PathStroke();
+    virtual void PathFill();
+    virtual void PathMoveToPoint(const REPoint &pt);
+    virtual void PathMoveToPoint(float x, float y);
+    virtual void PathLineToPoint(const REPoint& pt);
+    virtual void PathLineToPoint(float x, float y);
+    virtual void PathCurveToPoint(const REPoint& pt, const REPoint& cp1, const REPoint& cp2);
+    virtual void PathQuadCurveToPoint(const REPoint& pt, const REPoint& cp);
+    virtual void PathAddEllipseInRect(const RERect& rect);
+
+    virtual void SetLineDash(const REReal* lengths, int count, float phase);
+
+    virtual void StrokeRect(const RERect& rc);
+    virtual void StrokeRect(const RERect& rc, float lineWidth);
+
+    virtual void DrawText(const std::string& textUTF8, const REPoint& pt, const std::string& fontNameUTF8, unsigned int flags, float size, const REColor& color);
+    virtual void DrawTextInRect(const std::string& textUTF8, const RERect& rect, const std::string& fontNameUTF8, unsigned int flags, float size, const REColor& color);
+
+    virtual void BeginTextBatched(const std::string& fontNameUTF8, unsigned int flags, float size, const REColor& color);
+    virtual void DrawTextBatched(const std::string& textUTF8, const REPoint& pt);
+    virtual void EndTextBatched();
+
+public:
+    const REDisplayList* DisplayList() const {return _displayList;}
+
+private:
+    RERect _MapRect(const RERect& rc) const;
+    RERect _MapPoints(const REPoint* points, int count) const;
+    void _AddPathPoint(const REPoint& pt);
+
+private:
+    REDisplayList* _displayList;
+    REAffineTransform _transform;
+    std::vector<REAffineTransform> _transformStack;
+
+    RERect _pathBounds;
+    bool _pathEmpty;
+
+    int _batchedFont;
+    unsigned int _batchedFlags;
+    float _batchedSize;
+    std::string _batchedFontName;
+};
+
+#endif /* defined(__Reflow__RERecordingPainter__) */
@@ -55,6 +55,8 @@ void REScore::Clear()
         delete _systems[i];
     }
     _systems.clear();
+    _systemIndexOfBar.clear();
+    _sliceIndexOfBar.clear();
 }
 
 const RESystem* REScore::System(int idx) const
@@ -121,6 +123,10 @@ void REScore::SetTrackSet(const RETrackSet& trackSet)
 
 const RESystem* REScore::SystemWithBarIndex(int barIndex) const
 {
+    if(barIndex >= 0 && barIndex < (int)_systemIndexOfBar.size() && _systemIndexOfBar[barIndex] != -1) {
+        return _systems[_systemIndexOfBar[barIndex]];
+    }
+    
     for(unsigned int i=0; i<_systems.size(); ++i) {
         const RERange rg = _systems[i]->BarRange();
         if(barIndex >= rg.FirstIndex() && barIndex <= rg.LastIndex()) {
@@ -132,6 +138,10 @@ const RESystem* REScore::SystemWithBarIndex(int barIndex) const
 
 RESystem* REScore::SystemWithBarIndex(int barIndex)
 {
+    if(barIndex >= 0 && barIndex < (int)_systemIndexOfBar.size() && _systemIndexOfBar[barIndex] != -1) {
+        return _systems[_systemIndexOfBar[barIndex]];
+    }
+    
     int nbSystems = SystemCount();
     for(int systemIndex=0; systemIndex<nbSystems; ++systemIndex)
     {
@@ -144,6 +154,51 @@ RESystem* REScore::SystemWithBarIndex(int barIndex)
     return NULL;
 }
 
+int REScore::SliceIndexOfBar(int barIndex) const
+{
+    if(barIndex >= 0 && barIndex < (int)_sliceIndexOfBar.size()) {
+        return _sliceIndexOfBar[barIndex];
+    }
+    return -1;
+}
+
+const RESlice* REScore::SliceWithBarIndex(int barIndex) const
+{
+    const RESystem* system = SystemWithBarIndex(barIndex);
+    return (system ? system->SystemBarWithBarIndex(barIndex) : NULL);
+}
+
+void REScore::_RefreshLookupTables()
+{
+    int nbBars = (_parent ? (int)_parent->BarCount() : 0);
+    _systemIndexOfBar.assign(nbBars, -1);
+    _sliceIndexOfBar.assign(nbBars, -1);
+    
+    for(RESystem* system : _systems)
+    {
+        const RERange& range = system->BarRange();
+        for(int barIndex = range.FirstIndex(); barIndex <= range.LastIndex() && barIndex < nbBars; ++barIndex) {
+            _systemIndexOfBar[barIndex] = system->Index();
+        }
+        
+        int barIndex = range.FirstIndex();
+        for(RESlice* slice : system->Slices())
+        {
+            for(int i=0; i<slice->BarCount(); ++i, ++barIndex)
+            {
+                if(barIndex >= nbBars) break;
+                _systemIndexOfBar[barIndex] = system->Index();
+                _sliceIndexOfBar[barIndex] = slice->Index();
+            }
+        }
+        
+        // Slices of the system are final, we can cache their tick to x tables
+        for(RESlice* slice : system->Slices()) {
+            slice->_RefreshTickOffsets();
+        }
+    }
+}
+
 void REScore::FindSystemsWithBarIndexSet(RESystemSet* systemSet, const REIntSet& barIndexSet)
 {
     REIntSet::const_iterator it = barIndexSet.begin();
@@ -295,6 +350,8 @@ void REScore::Refresh()
         layout.CalculateSystems(this);
         layout.DispatchSystems(this);
     }
+    
+    _RefreshLookupTables();
 }
 
 void REScore::RefreshSingleBar(int barIndex)
@@ -75,6 +75,8 @@ public:
 
     const RESystem* SystemWithBarIndex(int barIndex) const;
     RESystem* SystemWithBarIndex(int barIndex);
+    const RESlice* SliceWithBarIndex(int barIndex) const;
+    int SliceIndexOfBar(int barIndex) const;
     void FindSystemsWithBarIndexSet(RESystemSet* systemSet, const REIntSet& barIndexSet);
     void FindSystemsWithBarIndexSet(REConstSystemSet* systemSet, const REIntSet& barIndexSet) const;
     
@@ -116,6 +118,7 @@ private:
     void _RefreshFrames();
     void _CreateFrames();
     void _DispatchSystemsInScreenMode();
+    void _RefreshLookupTables();
     
 private:
     const RESong* _parent;
@@ -125,6 +128,10 @@ private:
     RESystemVector _systems;
     REConstTrackVector _tracks;
     
+    // Bar -> (system, slice) lookup, rebuilt with layout
+    REIntVector _systemIndexOfBar;
+    REIntVector _sliceIndexOfBar;
+    
     RESize _contentSize;
     Reflow::ScoreLayoutType _layoutType;
     Reflow::PageLayoutType _pageLayoutType;
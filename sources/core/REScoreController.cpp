@@ -22,6 +22,7 @@
 #include "REScore.h"
 #include "REViewport.h"
 #include "RESystem.h"
+#include "REStandardStaff.h"
 #include "RESlice.h"
 #include "REBarMetrics.h"
 #include "RETable.h"
@@ -34,7 +35,7 @@
 using namespace std;
 
 REScoreController::REScoreController(RESongController* songController)
-: _songController(songController), _scoreIndex(-1), _score(songController->Song()), _delegate(NULL), _viewport(NULL),_typingSecondDigit(false), _preferredSelection(REScoreController::CursorSelection), _inferredSelection(REScoreController::CursorSelection), _layoutType(Reflow::PageScoreLayout), _pageLayoutType(Reflow::VerticalPageLayout), _tool(Reflow::TablatureTool), _selectionEndPoint(REPoint(0,0)), _selectionStartPoint(REPoint(0,0)), _selectionRectVisible(false), _inspector(nullptr)
+: _songController(songController), _scoreIndex(-1), _score(songController->Song()), _delegate(NULL), _viewport(NULL),_typingSecondDigit(false), _preferredSelection(REScoreController::CursorSelection), _inferredSelection(REScoreController::CursorSelection), _layoutType(Reflow::PageScoreLayout), _pageLayoutType(Reflow::VerticalPageLayout), _tool(Reflow::TablatureTool), _selectionEndPoint(REPoint(0,0)), _selectionStartPoint(REPoint(0,0)), _selectionRectVisible(false), _inspector(nullptr), _searchFlags(0), _occurrenceCount(0)
 {
     _songController->_scoreControllers.push_back(this);
     
@@ -520,19 +521,22 @@ void REScoreController::PerformTaskOnSelectedNotes(RENoteOperation op, const std
         if(chords.first && chords.second)
         {
             const REStaff* staff = _currentCursor.Staff();
-            RELockSongControllerForTask task(_songController, taskName, flags);
+            REBulkEditTask task(_songController, taskName, flags);
             
             int firstLine = FirstSelectedLine();
-            int lastLine = LastSelectedLine();            
+            int lastLine = LastSelectedLine();
+            bool tablature = (staff->Type() == Reflow::TablatureStaff);
+            bool transposing = _score.IsTransposing();
             const REChord* chord = chords.first;
             while(chord) {
-                REChord* lockedChord = task.LockChord(chord);
-                if(staff->Type() == Reflow::TablatureStaff) {
-                    lockedChord->PerformOperationOnNotesInStringRange(op, firstLine, lastLine);
-                }
-                else {
-                    lockedChord->PerformOperationOnNotesInLineRange(op, firstLine, lastLine, _score.IsTransposing());
-                }
+                task.AddChordOperation(chord, [op, firstLine, lastLine, tablature, transposing](REChord* lockedChord) {
+                    if(tablature) {
+                        lockedChord->PerformOperationOnNotesInStringRange(op, firstLine, lastLine);
+                    }
+                    else {
+                        lockedChord->PerformOperationOnNotesInLineRange(op, firstLine, lastLine, transposing);
+                    }
+                });
                 
                 if(chord == chords.second) break;
                 else chord = chord->NextSiblingOverMultipleBarlines();
@@ -575,11 +579,11 @@ void REScoreController::PerformTaskOnSelectedChords(REChordOperation op, const s
             REGlobalTimeDiv t1 = _originCursor.Beat();
             REGlobalTimeDiv lastBeat = (t0 <= t1 ? t1 : t0);
             
-            RELockSongControllerForTask task(_songController, taskName, flags);
+            REBulkEditTask task(_songController, taskName, flags);
             
             const REChord* chord = chords.first;
             while(chord) {
-                op(task.LockChord(chord));
+                task.AddChordOperation(chord, op);
                 
                 if(chord == chords.second) break;
                 else chord = chord->NextSiblingOverMultipleBarlines();
@@ -603,7 +607,7 @@ void REScoreController::PerformTaskOnSelectedChords(REChordOperation op, const s
     else if(_inferredSelection == REScoreController::BarRangeSelection ||
             _inferredSelection == REScoreController::SingleTrackBarRangeSelection)
     {
-        RELockSongControllerForTask task(_songController, taskName, flags);
+        REBulkEditTask task(_songController, taskName, flags);
         
         int firstBarIndex = FirstSelectedBarIndex();
         int lastBarIndex = LastSelectedBarIndex();
@@ -611,14 +615,14 @@ void REScoreController::PerformTaskOnSelectedChords(REChordOperation op, const s
         REConstTrackVector tracks = SelectedTracks();
         for(const RETrack* track : tracks)
         {
-            RETrack* lockedTrack = task.LockTrack(track);
-            
             for(int barIndex = firstBarIndex; barIndex <= lastBarIndex; ++barIndex)
             {
                 for(int voiceIndex = 0; voiceIndex < track->VoiceCount(); ++voiceIndex)
                 {
-                    REPhrase* phrase = lockedTrack->Voice(voiceIndex)->Phrase(barIndex);
-                    std::for_each(phrase->Chords().begin(), phrase->Chords().end(), op);
+                    const REPhrase* phrase = track->Voice(voiceIndex)->Phrase(barIndex);
+                    for(const REChord* chord : phrase->Chords()) {
+                        task.AddChordOperation(chord, op);
+                    }
                 }
             }
         }
@@ -1130,7 +1134,7 @@ void REScoreController::RefreshInspectorTable()
         else
         {
             REConstNoteSet notes;
-            if(_score.Song()->FindSelectedNotes(&notes))
+            if(_songController->NoteSelection().FindSelectedNotes(&notes))
             {
                 std::ostringstream oss; oss << notes.size() << " note(s)";
                 RETableSection* noteSection = new RETableSection(oss.str());
@@ -1328,6 +1332,131 @@ void REScoreController::SelectBarsInRange(const RERange& range)
     }
 }
 
+bool REScoreController::FindOccurrencesOfSelection(unsigned long matchFlags)
+{
+    // The pattern is read in the voice of the cursor only, chords of other voices are not in sequence
+    const REVoice* voice = _currentCursor.Voice();
+    if(voice == NULL) return false;
+    
+    REConstChordVector selectedChords;
+    FindSelectedChords(&selectedChords);
+    
+    REConstChordVector chords;
+    for(const REChord* chord : selectedChords) {
+        if(chord->Phrase()->Voice() == voice) chords.push_back(chord);
+    }
+    
+    REPatternIndex::EventVector pattern;
+    REPatternIndex::EventsOfChords(chords, &pattern);
+    if(pattern.size() < 2) return false;
+    
+    _searchPattern = pattern;
+    _searchFlags = matchFlags;
+    
+    // The selection is an occurrence itself, the search starts right after it
+    const REPatternIndex::Event& first = pattern.front();
+    _lastOccurrence.trackIndex = voice->Track()->Index();
+    _lastOccurrence.voiceIndex = voice->Index();
+    _lastOccurrence.firstBarIndex = first.barIndex;
+    _lastOccurrence.firstChordIndex = first.chordIndex;
+    _lastOccurrence.lastBarIndex = pattern.back().barIndex;
+    _lastOccurrence.lastChordIndex = pattern.back().chordIndex;
+    _lastOccurrence.onset = first.onset;
+    
+    return SelectNextOccurrence(false);
+}
+
+bool REScoreController::SelectNextOccurrence(bool backwards)
+{
+    _occurrenceCount = 0;
+    if(_searchPattern.size() < 2) return false;
+    
+    REPatternIndex::MatchVector matches;
+    _songController->PatternIndex().FindMatches(_searchPattern, _searchFlags, &matches);
+    
+    // Tracks without a staff in this score are left out
+    REPatternIndex::MatchVector visibleMatches;
+    visibleMatches.reserve(matches.size());
+    for(const REPatternIndex::Match& match : matches)
+    {
+        const RETrack* track = _songController->Song()->Track(match.trackIndex);
+        if(_StaffIndexOfVoice(match.firstBarIndex, track, match.voiceIndex) != -1) {
+            visibleMatches.push_back(match);
+        }
+    }
+    _occurrenceCount = (int)visibleMatches.size();
+    if(visibleMatches.empty()) return false;
+    
+    const REPatternIndex::Match* occurrence = NULL;
+    if(backwards)
+    {
+        auto it = std::lower_bound(visibleMatches.begin(), visibleMatches.end(), _lastOccurrence);
+        occurrence = (it == visibleMatches.begin() ? &visibleMatches.back() : &*(it - 1));
+    }
+    else
+    {
+        auto it = std::upper_bound(visibleMatches.begin(), visibleMatches.end(), _lastOccurrence);
+        occurrence = (it == visibleMatches.end() ? &visibleMatches.front() : &*it);
+    }
+    
+    _lastOccurrence = *occurrence;
+    return _SelectOccurrence(_lastOccurrence);
+}
+
+int REScoreController::_StaffIndexOfVoice(int barIndex, const RETrack* track, int voiceIndex) const
+{
+    const RESystem* system = _score.SystemWithBarIndex(barIndex);
+    if(system == NULL) return -1;
+    
+    for(unsigned int staffIndex=0; staffIndex < system->StaffCount(); ++staffIndex)
+    {
+        const REStaff* staff = system->Staff(staffIndex);
+        if(staff->Track() != track) continue;
+        
+        // Voices 2 and 3 are the left hand of a grand staff
+        if(staff->Type() == Reflow::StandardStaff && static_cast<const REStandardStaff*>(staff)->Hand() != voiceIndex / 2) {
+            continue;
+        }
+        return staffIndex;
+    }
+    return -1;
+}
+
+bool REScoreController::_SelectOccurrence(const REPatternIndex::Match& match)
+{
+    const RETrack* track = _songController->Song()->Track(match.trackIndex);
+    const REVoice* voice = track->Voice(match.voiceIndex);
+    const REChord* firstChord = voice->Phrase(match.firstBarIndex)->Chord(match.firstChordIndex);
+    const REChord* lastChord = voice->Phrase(match.lastBarIndex)->Chord(match.lastChordIndex);
+    
+    int firstStaffIndex = _StaffIndexOfVoice(match.firstBarIndex, track, match.voiceIndex);
+    int lastStaffIndex = _StaffIndexOfVoice(match.lastBarIndex, track, match.voiceIndex);
+    if(firstStaffIndex == -1 || lastStaffIndex == -1) return false;
+    
+    RECursor::VoiceSelectionType voiceSelection = (match.voiceIndex % 2 == 0 ? RECursor::HighVoiceSelection : RECursor::LowVoiceSelection);
+    
+    _typingSecondDigit = false;
+    _editingGraceNote = false;
+    _graceNoteIndex = 0;
+    
+    _originCursor.SetStaffIndex(firstStaffIndex);
+    _originCursor.SetBeat(REGlobalTimeDiv(match.firstBarIndex, firstChord->Offset()));
+    _originCursor.SetVoiceSelection(voiceSelection);
+    _originCursor.ForceValidPosition(false);
+    
+    _currentCursor.SetStaffIndex(lastStaffIndex);
+    _currentCursor.SetBeat(REGlobalTimeDiv(match.lastBarIndex, lastChord->Offset()));
+    _currentCursor.SetVoiceSelection(voiceSelection);
+    _currentCursor.ForceValidPosition(false);
+    
+    // New selection kind (will refresh the score)
+    SetPreferredSelectionKind(REScoreController::TickRangeSelection);
+    
+    if(_delegate) {
+        _delegate->OnShouldCenterOnCursor(this);
+    }
+    return true;
+}
 
 RERect REScoreController::SelectionRect() const
 {
@@ -251,6 +251,15 @@ public:
     
     void SelectBarsInRange(const RERange& range);
     
+    /** Takes the notes selected in the cursor voice as the searched pattern, then selects its next occurrence in any track */
+    bool FindOccurrencesOfSelection(unsigned long matchFlags);
+    
+    /** Selects the occurrence of the searched pattern after or before the last one selected, wrapping around the song */
+    bool SelectNextOccurrence(bool backwards=false);
+    
+    /** Occurrences of the searched pattern found by the last search */
+    int OccurrenceCount() const {return _occurrenceCount;}
+    
 public:
     void MouseDown(const REPoint& point, unsigned long flags);
     void MouseUp(const REPoint& point, unsigned long flags);
@@ -379,6 +388,9 @@ protected:
     void _MoveCursorLeft();
     void _MoveCursorRight();
     
+    int _StaffIndexOfVoice(int barIndex, const RETrack* track, int voiceIndex) const;
+    bool _SelectOccurrence(const REPatternIndex::Match& match);
+    
     void _PasteAllTracksPartialSongTo(const RESong* song, int barInsertIndex, bool pasteOver=false, bool includeBarInfo=true);
     void _PasteSingleTrackPartialSongTo(const RESong* song, int barInsertIndex, int trackIndex, bool pasteOver=false, bool includeBarInfo=true);
     
@@ -412,6 +424,12 @@ private:
     bool _editingGraceNote;
     int _graceNoteIndex;
     
+    // Pattern search
+    REPatternIndex::EventVector _searchPattern;
+    unsigned long _searchFlags;
+    REPatternIndex::Match _lastOccurrence;
+    int _occurrenceCount;
+    
     // Select (Arrow) Tool
     REPoint _selectionStartPoint;
     REPoint _selectionEndPoint;
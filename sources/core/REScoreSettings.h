@@ -18,6 +18,7 @@ class REScoreSettings
     friend class RESong;
     friend class REScore;
     friend class REArchive;
+    friend class REChunkedArchive;
     
 public:
     enum ScoreFlag {
@@ -12,7 +12,10 @@
 #include "REBar.h"
 #include "REVoice.h"
 #include "REPhrase.h"
+#include "REChord.h"
+#include "RENote.h"
 #include "REPlaylistBar.h"
+#include "REPlaylistIndex.h"
 #include "REMidiClip.h"
 #include "REMusicDevice.h"
 #ifdef REFLOW_QT
@@ -25,6 +28,11 @@
 #include "REMusicRack.h"
 #include "RESoundFontManager.h"
 #include "REFunctions.h"
+#include "REOutputStream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 class RESequencerImpl
 {
@@ -89,7 +97,7 @@ RESequencerTrack::~RESequencerTrack()
 
 RESequencer::RESequencer()
 : _d(new RESequencerImpl), _audioEngine(NULL), _song(0), _rack(NULL), _tempoTimeline(NULL),
-  _playlist(NULL), _tracks(NULL), _nextUUID(1), _mergeChannelsOnExport(false)
+  _playlist(NULL), _playlistIndex(NULL), _tracks(NULL), _nextUUID(1), _defaultSoundFont(NULL), _mergeChannelsOnExport(false), _exportThreadCount(0)
 {
     _d->running = false;
     _d->loopPlayback = false;
@@ -125,6 +133,7 @@ int RESequencer::PreclickBarCount() const
 RESequencer::~RESequencer()
 {
     delete _playlist;
+    delete _playlistIndex;
     
     if(_tracks) {
         for(RESequencerTrack* track : *_tracks) {delete track;}
@@ -134,22 +143,19 @@ RESequencer::~RESequencer()
     delete _d;
 }
 
-void RESequencer::_ApplyDeltaTicksToPlaylistForBarIndex(REPlaylistBarVector& playlist, int barIndex, int deltaTicksBefore, int deltaTicksAfter)
+void RESequencer::_ApplyDeltaTicksToPlaylistForBarIndex(REPlaylistBarVector& playlist, const REPlaylistIndex& playlistIndex, int barIndex, int deltaTicksBefore, int deltaTicksAfter)
 {
-    for(int pbarIndex = 0; pbarIndex < playlist.size(); ++pbarIndex)
+    for(int pbarIndex = playlistIndex.FirstOccurenceOfBar(barIndex); pbarIndex != -1; pbarIndex = playlistIndex.NextOccurenceOfBar(pbarIndex))
     {
         REPlaylistBar& pbar = playlist[pbarIndex];
-        if(pbar.IndexInSong() == barIndex)
-        {
-            if(pbar._tick - deltaTicksBefore < pbar._extendedTick) {
-                pbar._extendedTick = pbar._tick - deltaTicksBefore;
-            }
-            
-            int extraTicksBefore = pbar._tick - pbar._extendedTick;
-            int newDuration = (extraTicksBefore + pbar._duration + deltaTicksAfter);
-            if(newDuration > pbar._extendedDuration) {
-                pbar._extendedDuration = newDuration;
-            }
+        if(pbar._tick - deltaTicksBefore < pbar._extendedTick) {
+            pbar._extendedTick = pbar._tick - deltaTicksBefore;
+        }
+        
+        int extraTicksBefore = pbar._tick - pbar._extendedTick;
+        int newDuration = (extraTicksBefore + pbar._duration + deltaTicksAfter);
+        if(newDuration > pbar._extendedDuration) {
+            pbar._extendedDuration = newDuration;
         }
     }
 }
@@ -222,14 +228,67 @@ void RESequencer::SetTrackCapo(int trackIndex, int capo)
     }        
 }
 
-void RESequencer::_RebuildSequencer(const RESong* song)
+void RESequencer::SetTrackSoundFont(int trackIndex, const std::string& sf2Path)
+{
+    if(_tracks == NULL) return;
+    
+    if(trackIndex >= 0 && trackIndex < _tracks->size()) {
+        RESequencerTrack* track = _tracks->at(trackIndex);
+        if(track) {
+            // Picked up by the audio thread once the file is loaded
+            track->_soundFontEntry = (sf2Path.empty() ? NULL : RESoundFontManager::Instance().SoundFontEntry(sf2Path));
+        }
+    }
+}
+
+std::string RESequencer::TrackSoundFontPath(int trackIndex) const
+{
+    if(_tracks == NULL || trackIndex < 0 || trackIndex >= (int)_tracks->size()) return "";
+    
+    const RESoundFontManager::Entry* entry = _tracks->at(trackIndex)->_soundFontEntry;
+    return (entry ? entry->Path() : "");
+}
+
+bool RESequencer::TrackLevels(int trackIndex, REAudioMeter::Levels* levels) const
+{
+    // Tracks and their devices are only swapped on the main thread, meters are read without locking the rack
+    if(_tracks == NULL || trackIndex < 0 || trackIndex >= (int)_tracks->size()) return false;
+    const REMusicDevice* device = _tracks->at(trackIndex)->_device;
+    if(device == NULL) return false;
+    
+    *levels = device->Meter().Snapshot();
+    return true;
+}
+
+void RESequencer::ResetTrackClip(int trackIndex)
+{
+    if(_tracks == NULL || trackIndex < 0 || trackIndex >= (int)_tracks->size()) return;
+    REMusicDevice* device = _tracks->at(trackIndex)->_device;
+    if(device) device->Meter().ResetClip();
+}
+
+const RENoteStateTable* RESequencer::TrackNoteStates(int trackIndex, int barIndex) const
+{
+    // Tracks are only swapped on the main thread
+    if(_tracks == NULL || trackIndex < 0 || trackIndex >= (int)_tracks->size()) return NULL;
+    return _tracks->at(trackIndex)->NoteStates(barIndex);
+}
+
+void RESequencer::_RebuildSequencer(const RESong* song, const std::vector<REIntSet>* modifiedBars)
 {
     if(!IsInitialized()) return;
     
+    // Clips of unmodified bars are copied from the current tracks, as long as the song kept its shape
+    const RESequencerTrackVector* oldTracks = NULL;
+    if(modifiedBars && _tracks && (int)_tracks->size() == song->TrackCount() && (int)modifiedBars->size() == song->TrackCount()) {
+        oldTracks = _tracks;
+    }
+    
     REPrintf("_RebuildSequencer\n");
     
     // Calculate New Playlist
     REPlaylistBarVector* playlist = song->ClonePlaylist();
+    REPlaylistIndex* playlistIndex = new REPlaylistIndex(song->PlaylistIndex());
     
     // Clone the tempo timeline
     RETempoTimeline* tempoTimeline = song->TempoTimeline().Clone();
@@ -251,18 +310,34 @@ void RESequencer::_RebuildSequencer(const RESong* song)
             seqTrack->_initialMidiProgram = track->MIDIProgram();
             seqTrack->_midiProgramChangeRequested = false;
             seqTrack->_trackName = track->Name();
+            seqTrack->_soundFontEntry = NULL;
             
             if(track->_deviceUUID == -1 && _audioEngine != NULL) {
                 track->_deviceUUID = _nextUUID++;
             }
             seqTrack->_deviceUUID = track->_deviceUUID;
             
-            // Calculate Clips
+            // Calculate Clips and the notes shown while they play
+            seqTrack->_noteStates.reserve(song->BarCount());
             for(int barIndex=0; barIndex<song->BarCount(); ++barIndex)
             {
                 const REBar* bar = song->Bar(barIndex);
                 
-                REMidiClip* clip = track->CalculateMidiClipForBar(barIndex);
+                REMidiClip* clip = NULL;
+                if(oldTracks && modifiedBars->at(trackIndex).count(barIndex) == 0)
+                {
+                    const RESequencerTrack* oldTrack = oldTracks->at(trackIndex);
+                    const REMidiClipVector& oldClips = oldTrack->_clips;
+                    if(barIndex < (int)oldClips.size() && (int)oldClips.size() == song->BarCount()) {
+                        clip = new REMidiClip(*oldClips[barIndex]);
+                        seqTrack->_noteStates.push_back(oldTrack->_noteStates[barIndex]);
+                    }
+                }
+                if(clip == NULL) {
+                    clip = track->CalculateMidiClipForBar(barIndex);
+                    seqTrack->_noteStates.push_back(RENoteStateTable());
+                    seqTrack->_noteStates.back().Build(track, barIndex);
+                }
                 int deltaTicksBefore = 0;
                 int deltaTicksAfter = 0;
                 if(clip->MinTick() < 0) {
@@ -272,7 +347,7 @@ void RESequencer::_RebuildSequencer(const RESong* song)
                     deltaTicksAfter = (clip->MaxTick() - bar->TheoricDurationInTicks());
                 }
                 if(deltaTicksBefore || deltaTicksAfter) {
-                    _ApplyDeltaTicksToPlaylistForBarIndex(*playlist, barIndex, deltaTicksBefore, deltaTicksAfter);
+                    _ApplyDeltaTicksToPlaylistForBarIndex(*playlist, *playlistIndex, barIndex, deltaTicksBefore, deltaTicksAfter);
                 }
                 seqTrack->_clips.push_back(clip);
             }
@@ -284,15 +359,20 @@ void RESequencer::_RebuildSequencer(const RESong* song)
             if(deviceIndex != -1){
                 seqTrack->_device = static_cast<RESynthMusicDevice*>(_rack->Device(deviceIndex));
                 REPrintf("  > found device at index %d\n", deviceIndex);
+                
+                // The device keeps the SoundFont its track was given
+                if(_tracks) {
+                    for(const RESequencerTrack* oldTrack : *_tracks) {
+                        if(oldTrack->_deviceUUID == seqTrack->_deviceUUID) {
+                            seqTrack->_soundFontEntry = oldTrack->_soundFontEntry;
+                            break;
+                        }
+                    }
+                }
             }
             else {
                 seqTrack->_device = static_cast<RESynthMusicDevice*>(_rack->_NewMusicDevice(seqTrack->_deviceUUID));
-                if(_audioEngine) {
-                    seqTrack->_device->SetSoundFont(_audioEngine->SoundFont());
-                }
-                else {
-                    seqTrack->_device->SetSoundFont(RESoundFontManager::Instance().DefaultSoundFont());
-                }
+                seqTrack->_device->SetSoundFont(_defaultSoundFont);
 
                 REPrintf("  > did not found any device\n");
             }
@@ -315,6 +395,9 @@ void RESequencer::_RebuildSequencer(const RESong* song)
         tracks->push_back(seqTrack);
     }
     
+    // Extended bars widen the tick ranges searched while rendering
+    playlistIndex->RefreshExtents(*playlist);
+    
     // Delete Old Devices
     REMusicDeviceVector devicesToDelete;
     for(int deviceIndex=0; deviceIndex < _rack->DeviceCount(); ++deviceIndex)
@@ -339,6 +422,7 @@ void RESequencer::_RebuildSequencer(const RESong* song)
         REMusicRack::MutexLocker lock_the_rack_(_rack->Mutex());
         
         std::swap(_playlist, playlist);
+        std::swap(_playlistIndex, playlistIndex);
         std::swap(_tempoTimeline, tempoTimeline);
         std::swap(_tracks, tracks);
         
@@ -351,6 +435,7 @@ void RESequencer::_RebuildSequencer(const RESong* song)
     
     // Delete old stuff
     delete playlist;
+    delete playlistIndex;
     delete tempoTimeline;
     if(tracks) {
         for(RESequencerTrack* track : *tracks) {delete track;}
@@ -378,18 +463,55 @@ void RESequencer::SongControllerDidModifyPhrase(const RESongController* controll
 	SongControllerDidModifySong(controller, phrase->Voice()->Track()->Song(), successfully);
 }
 
-const REPlaylistBar* RESequencer::FirstOccurenceOfBarInPlaylist(int barIndex) const
+void RESequencer::SongControllerDidModifyPhrases(const RESongController* controller, const REConstPhraseVector& phrases, bool successfully)
 {
-    if(!_playlist) return NULL;
+    const RESong* song = controller->Song();
+    std::vector<REIntSet> modifiedBars(song->TrackCount());
     
-    for(unsigned int i=0; i<_playlist->size(); ++i) 
+    for(const REPhrase* phrase : phrases)
     {
-        const REPlaylistBar* pbar = &_playlist->at(i);
-        if(pbar->IndexInSong() == barIndex) {
-            return pbar;
+        const RETrack* track = phrase->Track();
+        const REVoice* voice = phrase->Voice();
+        REIntSet& bars = modifiedBars[track->Index()];
+        
+        // Neighbour bars may slide or bend into the modified one
+        int barIndex = phrase->Index();
+        bars.insert(barIndex);
+        if(barIndex + 1 < song->BarCount()) bars.insert(barIndex + 1);
+        
+        // Clips hold tied notes with their whole duration, from the bar where the tie starts
+        for(int i = barIndex; i > 0; --i)
+        {
+            bars.insert(i - 1);
+            const REPhrase* tiedPhrase = voice->Phrase(i);
+            const REChord* firstChord = (tiedPhrase ? tiedPhrase->FirstChord() : NULL);
+            bool tied = false;
+            if(firstChord) {
+                for(const RENote* note : firstChord->Notes()) {
+                    if(note->HasFlag(RENote::TieDestination)) {tied = true; break;}
+                }
+            }
+            if(!tied) break;
         }
     }
-    return NULL;
+    
+    _RebuildSequencer(song, &modifiedBars);
+}
+
+const REPlaylistBar* RESequencer::FirstOccurenceOfBarInPlaylist(int barIndex) const
+{
+    if(!_playlist) return NULL;
+    
+    int indexInPlaylist = _playlistIndex->FirstOccurenceOfBar(barIndex);
+    return (indexInPlaylist != -1 ? &_playlist->at(indexInPlaylist) : NULL);
+}
+
+const REPlaylistBar* RESequencer::PlaylistBarAtTick(unsigned long tick) const
+{
+    if(!_playlist) return NULL;
+    
+    int indexInPlaylist = _playlistIndex->IndexInPlaylistAtTick(tick);
+    return (indexInPlaylist != -1 ? &_playlist->at(indexInPlaylist) : NULL);
 }
 
 unsigned long RESequencer::PlaylistDurationInTicks() const
@@ -427,7 +549,8 @@ void RESequencer::Build(const RESong *song, REAudioEngine* audioEngine)
     
     // Create the rack device for playing metronome ticks
     RESynthMusicDevice* metronomeDevice = _rack->CreateMetronomeDevice();
-    metronomeDevice->SetSoundFont(_audioEngine ? _audioEngine->SoundFont() : RESoundFontManager::Instance().DefaultSoundFont());
+    _defaultSoundFont = (_audioEngine ? _audioEngine->SoundFont() : RESoundFontManager::Instance().DefaultSoundFont());
+    metronomeDevice->SetSoundFont(_defaultSoundFont);
     metronomeDevice->SetMidiProgramOfAllChannels(0, 128);
     
 	// Rebuild the Sequencer from song
@@ -511,8 +634,8 @@ void RESequencer::JumpTo(int barIndex, int tickInBar)
 
     if(_tempoTimeline)
     {
-        RETimeDiv timeDiv = Reflow::TicksToTimeDiv(_d->currentTickInBar);
-        int itemIdx = _tempoTimeline->IndexOfItemAt(_d->currentBarIndexInSong, timeDiv, NULL);
+        REExactTick tick = Reflow::TicksToExactTicks(_d->currentTickInBar);
+        int itemIdx = _tempoTimeline->IndexOfItemAt(_d->currentBarIndexInSong, tick, NULL);
         if(itemIdx != -1) {
             _d->bpm = _d->newBpm = (double)(_tempoTimeline->Item(itemIdx)->tempo);
         }
@@ -589,6 +712,14 @@ const REMidiClip* RESequencerTrack::Clip(int barIndex) const
     return NULL;
 }
 
+const RENoteStateTable* RESequencerTrack::NoteStates(int barIndex) const
+{
+    if(barIndex >= 0 && barIndex < (int)_noteStates.size()) {
+        return &_noteStates[barIndex];
+    }
+    return NULL;
+}
+
 void RESequencer::_RenderMetronomeSubclicks(double ratio, double volume, double t0, double t1, REMusicDevice *metronomeDevice, REIntSet& clickDelays, int sampleDelay)
 {
     const int clickMidi = 33;
@@ -689,9 +820,13 @@ void RESequencer::_RenderTickRange(double t0, double t1, int sampleDelay)
 {
     if(!_playlist) return;
     
+    // Only the bars around the rendered range can intersect it
+    int firstIndex = 0;
+    int lastIndex = -1;
+    if(!_playlistIndex->FindCandidatesInTickRange(t0, t1, &firstIndex, &lastIndex)) return;
+    
     const REPlaylistBarVector& playlist = *_playlist;
-    unsigned int playlistSize = playlist.size();
-    for(unsigned int barIndexInPlaylist=0; barIndexInPlaylist<playlistSize; ++barIndexInPlaylist)
+    for(int barIndexInPlaylist=firstIndex; barIndexInPlaylist<=lastIndex; ++barIndexInPlaylist)
     {
         const REPlaylistBar& pbar = playlist[barIndexInPlaylist];
         bool extended = false;
@@ -780,8 +915,8 @@ void RESequencer::_RenderTickRange(double t0, double t1, int sampleDelay)
             // Look for a Tempo marker in this tick range
             if(_tempoTimeline)
             {
-                RETimeDiv timeDiv = Reflow::TicksToTimeDiv(_d->currentTickInBar);
-                int itemIdx = _tempoTimeline->IndexOfItemAt(_d->currentBarIndexInSong, timeDiv, NULL);
+                REExactTick tick = Reflow::TicksToExactTicks(_d->currentTickInBar);
+                int itemIdx = _tempoTimeline->IndexOfItemAt(_d->currentBarIndexInSong, tick, NULL);
                 if(itemIdx != -1)
                 {
                     const RETempoItem* tempoItem = _tempoTimeline->Item(itemIdx);
@@ -956,6 +1091,15 @@ void RESequencer::WillRenderDevice (REMusicRack* rack, REMusicDevice* device, un
             track->_initialMidiProgram = track->_midiProgram;
             track->_midiProgramChangeRequested = false;
         }
+        
+        // Devices play the default SoundFont until the one of their track is loaded
+        RESoundFont* soundfont = (track->_soundFontEntry ? track->_soundFontEntry->SoundFont() : NULL);
+        if(soundfont == NULL) {
+            soundfont = _defaultSoundFont;
+        }
+        if(soundfont && track->_device->SoundFont() != soundfont) {
+            track->_device->ChangeSoundFont(soundfont);
+        }
     }
 }
 void RESequencer::DidRenderDevice (REMusicRack* rack, REMusicDevice* device, unsigned int nbFrames, float* workBufferL, float* workBufferR)
@@ -1016,21 +1160,20 @@ class REMidiPacket
 {
 public:
     int32_t tick;
-    std::string data;
+    char data[3];
+    uint8_t size;
     
 public:
-    REMidiPacket() : tick(0), data() {}
-    REMidiPacket(const REMidiPacket& rhs) {*this=rhs;}
+    REMidiPacket() : tick(0), size(0) {}
     
     explicit REMidiPacket(const REMidiEvent& midiEvent)
     {
         tick = midiEvent.tick;
         
-        data += (char)midiEvent.data[0];
-        data += (char)midiEvent.data[1];
-        if(midiEvent.Type() != 0xC && midiEvent.Type() != 0xD) {
-            data += (char)(midiEvent.Velocity());
-        }
+        data[0] = (char)midiEvent.data[0];
+        data[1] = (char)midiEvent.data[1];
+        data[2] = (char)(midiEvent.Velocity());
+        size = (midiEvent.Type() != 0xC && midiEvent.Type() != 0xD) ? 3 : 2;
     }
     
     REMidiPacket(const REMidiEvent& midiEvent, bool overrideChannel)
@@ -1038,21 +1181,14 @@ public:
         tick = midiEvent.tick;
         
         if(overrideChannel) {
-            data += (char)midiEvent.data[0] & 0xF0;
+            data[0] = (char)(midiEvent.data[0] & 0xF0);
         }
         else {
-            data += (char)midiEvent.data[0];
+            data[0] = (char)midiEvent.data[0];
         }
-        data += (char)midiEvent.data[1];
-        if(midiEvent.Type() != 0xC && midiEvent.Type() != 0xD) {
-            data += (char)(midiEvent.Velocity());
-        }
-    }
-    
-    REMidiPacket& operator=(const REMidiPacket& rhs) {
-        tick = rhs.tick;
-        data = rhs.data;
-        return *this;
+        data[1] = (char)midiEvent.data[1];
+        data[2] = (char)(midiEvent.Velocity());
+        size = (midiEvent.Type() != 0xC && midiEvent.Type() != 0xD) ? 3 : 2;
     }
     
     bool operator<(const REMidiPacket& rhs) const {
@@ -1088,6 +1224,33 @@ public:
         return (data[0] & 0x0F);
     }
 };
+typedef std::vector<REMidiPacket> REMidiPacketVector;
+
+/** REMidiPacketCursor struct.
+ *  Position in the sorted packets of one playlist bar, used by the k-way merge of GenerateMidiTrackData.
+ */
+struct REMidiPacketCursor
+{
+    const REMidiPacketVector* packets;
+    unsigned int index;
+    int32_t tickOffset;
+    int order;
+    
+    REMidiPacket Current() const {
+        REMidiPacket packet = (*packets)[index];
+        packet.tick += tickOffset;
+        return packet;
+    }
+    
+    // Heap ordering: the cursor with the earliest packet comes out first, playlist order breaks ties
+    bool operator<(const REMidiPacketCursor& rhs) const {
+        REMidiPacket a = Current();
+        REMidiPacket b = rhs.Current();
+        if(b < a) return true;
+        if(a < b) return false;
+        return order > rhs.order;
+    }
+};
 
 void RESequencer::GenerateMidiTempoData(REOutputStream& data) const
 {
@@ -1144,7 +1307,7 @@ void RESequencer::GenerateMidiTempoData(REOutputStream& data) const
             for(int itemIndex=firstItemIndex; itemIndex <= lastItemIndex; ++itemIndex)
             {
                 const RETempoItem* item = _tempoTimeline->Item(itemIndex);
-                int32_t itemTickInPlaylist = pbarTick + Reflow::TimeDivToTicks(item->beat);
+                int32_t itemTickInPlaylist = pbarTick + Reflow::ExactTicksToTicks(item->tick);
                 
                 int32_t deltaTicks = std::max<int32_t>(0, itemTickInPlaylist - currentTick);
                 currentTick = pbarTick;
@@ -1177,6 +1340,11 @@ void RESequencer::SetMergeChannelsOnExport(bool merge)
     _mergeChannelsOnExport = merge;
 }
 
+void RESequencer::SetExportThreadCount(int threadCount)
+{
+    _exportThreadCount = threadCount;
+}
+
 void RESequencer::GenerateMidiTrackData(REOutputStream& data, const RESequencerTrack* track) const
 {
     // Track name
@@ -1187,57 +1355,87 @@ void RESequencer::GenerateMidiTrackData(REOutputStream& data, const RESequencerT
 	data.WriteVLV(name.length());
     data.Write(name.data(), name.length());
     
-    // Aggregate Packets of all bars
-    std::vector<REMidiPacket> packets;
-    RETimeSignature lastTimeSignature(0,0);
+    // Packets of each clip are sorted once, however many times the bar is repeated in the playlist
+    std::map<const REMidiClip*, REMidiPacketVector> sortedClips;
+    std::vector<REMidiPacketCursor> pending;
     for(int pbarIndex=0; pbarIndex < _playlist->size(); ++pbarIndex)
     {
         const REPlaylistBar& pbar = _playlist->at(pbarIndex);
-        int pbarTick = pbar.Tick();
         int barIndex = pbar.IndexInSong();
         const REMidiClip* clip = track->Clip(barIndex);
         if(clip == NULL) continue;
         
-        // Note Events
-        for(int i=0; i<clip->NoteEventCount(); ++i)
+        auto it = sortedClips.find(clip);
+        if(it == sortedClips.end())
         {
-            const REMidiNoteEvent& midiNoteEvent = clip->NoteEvent(i);
-            REMidiEventPair events = midiNoteEvent.SplitIntoNoteOnAndNoteOffEvents(_mergeChannelsOnExport && midiNoteEvent.channel != 0x09);
-        
-            // Note On
-            REMidiPacket noteOn (events.first);
-            noteOn.tick += pbarTick;
-            packets.push_back(noteOn);
+            REMidiPacketVector& packets = sortedClips[clip];
+            packets.reserve(2 * clip->NoteEventCount() + clip->EventCount());
+            
+            // Note Events
+            for(int i=0; i<clip->NoteEventCount(); ++i)
+            {
+                const REMidiNoteEvent& midiNoteEvent = clip->NoteEvent(i);
+                REMidiEventPair events = midiNoteEvent.SplitIntoNoteOnAndNoteOffEvents(_mergeChannelsOnExport && midiNoteEvent.channel != 0x09);
+                packets.push_back(REMidiPacket(events.first));
+                packets.push_back(REMidiPacket(events.second));
+            }
+            
+            // All other Events
+            for(int i=0; i<clip->EventCount(); ++i)
+            {
+                const REMidiEvent &midiEvent = clip->Event(i);
+                REMidiPacket event (midiEvent, _mergeChannelsOnExport && midiEvent.Channel() != 0x09);
+                if(event.Channel())
+                packets.push_back(event);
+            }
             
-            // Note Off
-            REMidiPacket noteOff (events.second);
-            noteOff.tick += pbarTick;
-            packets.push_back(noteOff);
+            std::sort(packets.begin(), packets.end());
+            it = sortedClips.find(clip);
         }
+        if(it->second.empty()) continue;
         
-        // All other Events
-        for(int i=0; i<clip->EventCount(); ++i)
-        {
-            const REMidiEvent &midiEvent = clip->Event(i);
-            REMidiPacket event (midiEvent, _mergeChannelsOnExport && midiEvent.Channel() != 0x09);
-            event.tick += pbarTick;
-            if(event.Channel())
-            packets.push_back(event);
-        }
+        REMidiPacketCursor cursor;
+        cursor.packets = &it->second;
+        cursor.index = 0;
+        cursor.tickOffset = pbar.Tick();
+        cursor.order = (int)pending.size();
+        pending.push_back(cursor);
     }
     
-    // Sort Midi packet events
-    std::sort(packets.begin(), packets.end());
+    // Bars enter the merge when the output reaches their first packet, so the heap only
+    // holds the bars whose events overlap the current tick.
+    std::stable_sort(pending.begin(), pending.end(), [](const REMidiPacketCursor& a, const REMidiPacketCursor& b) {
+        return a.Current().tick < b.Current().tick;
+    });
     
-    // Write Packets as raw Midi Data
+    std::vector<REMidiPacketCursor> heap;
+    unsigned int nextPending = 0;
     int32_t currentTick = 0;
-    for(const REMidiPacket& packet : packets)
+    while(nextPending < pending.size() || !heap.empty())
     {
+        while(nextPending < pending.size() &&
+              (heap.empty() || pending[nextPending].Current().tick <= heap.front().Current().tick))
+        {
+            heap.push_back(pending[nextPending++]);
+            std::push_heap(heap.begin(), heap.end());
+        }
+        
+        std::pop_heap(heap.begin(), heap.end());
+        REMidiPacketCursor& cursor = heap.back();
+        REMidiPacket packet = cursor.Current();
+        
+        // Write Packet as raw Midi Data
         int32_t deltaTicks = (packet.tick - currentTick);
         currentTick = packet.tick;
         data.WriteVLV(deltaTicks);
+        data.Write(packet.data, packet.size);
         
-        data.Write(packet.data.data(), packet.data.size());
+        if(++cursor.index < cursor.packets->size()) {
+            std::push_heap(heap.begin(), heap.end());
+        }
+        else {
+            heap.pop_back();
+        }
     }
     
     // Add Track finished data
@@ -1253,10 +1451,34 @@ void RESequencer::GenerateMidiTrackData(REOutputStream& data, const RESequencerT
     }
 }
 
-void RESequencer::ExportMidiToFile(const std::string& filename) const
+void RESequencer::WriteMidiTrackChunk(REOutputStream& data, const RESequencerTrack* track) const
 {
-    // Write the MIDI File data to a temporary buffer first
-    REBufferOutputStream data;
+    // The chunk length is patched once the events have been streamed
+    char magic[] = "MTrk";
+    data.Write(magic, 4);
+    unsigned long lengthPos = data.Pos();
+    data.WriteInt32(0);
+    
+    if(track) {
+        GenerateMidiTrackData(data, track);
+    }
+    else {
+        GenerateMidiTempoData(data);
+    }
+    
+    unsigned long endPos = data.Pos();
+    data.SeekTo(lengthPos);
+    data.WriteInt32(endPos - lengthPos - 4);
+    data.SeekTo(endPos);
+}
+
+bool RESequencer::ExportMidiToFile(const std::string& filename) const
+{
+    // Tracks are written straight to the file, no intermediate buffer
+    REFileOutputStream data;
+    if(!data.Open(filename)) {
+        return false;
+    }
     data.SetEndianness(Reflow::BigEndian);
     
     char magic[] = "MThd";
@@ -1272,35 +1494,63 @@ void RESequencer::ExportMidiToFile(const std::string& filename) const
     data.WriteInt16(headerDivisions);
     
     // Tempo track
-	{
-        REBufferOutputStream midiData;
-        midiData.SetEndianness(Reflow::BigEndian);
-        GenerateMidiTempoData(midiData);
-		
-		char magic[] = "MTrk";
-		data.Write(magic, 4);
-        data.WriteInt32(midiData.Size());
-        data.Write(midiData.Data(), midiData.Size());
-	}
-	
-	// Append content for each track
-    for(const RESequencerTrack* track : *_tracks)
+    WriteMidiTrackChunk(data, NULL);
+    
+    int trackCount = (int)_tracks->size();
+    int threadCount = _exportThreadCount;
+    if(threadCount <= 0) {
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, trackCount);
+    
+    if(threadCount <= 1)
+    {
+        for(const RESequencerTrack* track : *_tracks) {
+            WriteMidiTrackChunk(data, track);
+        }
+        return data.Close();
+    }
+    
+    // Parallel export: each track goes to its own temporary chunk, appended in track order.
+    // A track whose temporary file can't be created is written directly when its turn comes.
+    std::vector<REFileOutputStream*> chunks(trackCount, NULL);
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for(int i = next++; i < trackCount; i = next++)
+        {
+            REFileOutputStream* chunk = new REFileOutputStream;
+            chunk->SetEndianness(Reflow::BigEndian);
+            if(chunk->OpenTemporary()) {
+                WriteMidiTrackChunk(*chunk, _tracks->at(i));
+                chunks[i] = chunk;
+            }
+            else {
+                delete chunk;
+            }
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for(int i=1; i<threadCount; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    bool ok = true;
+    for(int i=0; i<trackCount; ++i)
     {
-        REBufferOutputStream midiData;
-        midiData.SetEndianness(Reflow::BigEndian);
-        GenerateMidiTrackData(midiData, track);
-		
-		char magic[] = "MTrk";
-		data.Write(magic, 4);
-        data.WriteInt32(midiData.Size());
-        data.Write(midiData.Data(), midiData.Size());
-	}
-    
-    // Write to a File
-    FILE* file = fopen(filename.c_str(), "wb");
-    if(file != NULL){
-        fwrite(data.Data(), data.Size(), 1, file);
-        fclose(file);
+        REFileOutputStream* chunk = chunks[i];
+        if(chunk == NULL) {
+            WriteMidiTrackChunk(data, _tracks->at(i));
+            continue;
+        }
+        ok = chunk->CopyTo(data) && ok;
+        delete chunk;
     }
+    
+    return data.Close() && ok;
 }
 
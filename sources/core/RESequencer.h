@@ -13,6 +13,9 @@
 #include "RESongController.h"
 #include "RETimeline.h"
 #include "REMidiClip.h"
+#include "REAudioMeter.h"
+#include "RENoteStateTable.h"
+#include "RESoundFontManager.h"
 
 #include <mutex>
 
@@ -52,6 +55,7 @@ public:
     int32_t DeviceUUID() const {return _deviceUUID;}
     
     const REMidiClip* Clip(int barIndex) const;
+    const RENoteStateTable* NoteStates(int barIndex) const;
     
 private:
     int32_t _index;
@@ -66,7 +70,9 @@ private:
     int8_t _capo;
     std::string _trackName;
     REMidiClipVector _clips;
+    std::vector<RENoteStateTable> _noteStates;
     RESynthMusicDevice* _device;
+    const RESoundFontManager::Entry* _soundFontEntry;
 };
 
 typedef std::vector<RESequencerTrack*> RESequencerTrackVector;
@@ -118,9 +124,12 @@ public:
     unsigned long TickInBarPlaying() const;
     unsigned long TickInPlaylist() const;
     
-    void ExportMidiToFile(const std::string& filename) const;
+    bool ExportMidiToFile(const std::string& filename) const;
     void SetMergeChannelsOnExport(bool merge);
     
+    /** Tracks are exported to temporary chunks on this many threads, 0 for one per core */
+    void SetExportThreadCount(int threadCount);
+    
     float SampleRate() const;
     double CurrentBPM() const;
     
@@ -139,6 +148,17 @@ public:
     void SetTrackMidiProgram(int trackIndex, int midiProgram);
     void SetTrackCapo(int trackIndex, int capo);
     
+    /** SoundFont file played by a track, empty for the default one. The default bank plays until the file is loaded. */
+    void SetTrackSoundFont(int trackIndex, const std::string& sf2Path);
+    std::string TrackSoundFontPath(int trackIndex) const;
+    
+    /** Levels of the device playing a track, false if the track has no device yet */
+    bool TrackLevels(int trackIndex, REAudioMeter::Levels* levels) const;
+    void ResetTrackClip(int trackIndex);
+    
+    /** Notes of a bar of a track as of the last rebuild, NULL if there is no such bar */
+    const RENoteStateTable* TrackNoteStates(int trackIndex, int barIndex) const;
+    
 public: // [[CALLED FROM AUDIO RT THREAD]]
     virtual void WillRenderRack (REMusicRack* rack, unsigned int nbFrames, float* workBufferL, float* workBufferR);
     virtual void DidRenderRack (REMusicRack* rack, unsigned int nbFrames, float* workBufferL, float* workBufferR);
@@ -150,15 +170,17 @@ public: // [[CALLED FROM MAIN UI THREAD]]
     virtual void SongControllerWillModifySong(const RESongController* controller, const RESong* song);
     virtual void SongControllerDidModifySong(const RESongController* controller, const RESong* song, bool successfully);
     virtual void SongControllerDidModifyPhrase(const RESongController* controller, const REPhrase* phrase, bool successfully);
+    virtual void SongControllerDidModifyPhrases(const RESongController* controller, const REConstPhraseVector& phrases, bool successfully);
     
 protected:
     REMusicDevice* DeviceForTrack(const RETrack* track);
     
     const REPlaylistBar* FirstOccurenceOfBarInPlaylist(int barIndex) const;
+    const REPlaylistBar* PlaylistBarAtTick(unsigned long tick) const;
     unsigned long PlaylistDurationInTicks() const;
     
-    void _ApplyDeltaTicksToPlaylistForBarIndex(REPlaylistBarVector& playlist, int barIndex, int deltaTicksBefore, int deltaTicksAfter);
-    void _RebuildSequencer(const RESong*);
+    void _ApplyDeltaTicksToPlaylistForBarIndex(REPlaylistBarVector& playlist, const REPlaylistIndex& playlistIndex, int barIndex, int deltaTicksBefore, int deltaTicksAfter);
+    void _RebuildSequencer(const RESong*, const std::vector<REIntSet>* modifiedBars=NULL);
     void _RenderTickRange(double t0, double t1, int sampleDelay);
     void _RenderMetronomeClicks(double t0, double t1, const RETimeSignature& ts, REMusicDevice* metronomeDevice, int sampleDelay);
     void _RenderMetronomeSubclicks(double ratio, double volume, double t0, double t1,  REMusicDevice *metronomeDevice, REIntSet& clickDelays, int sampleDelay);
@@ -166,6 +188,7 @@ protected:
     
     void GenerateMidiTempoData(REOutputStream& data) const;
     void GenerateMidiTrackData(REOutputStream& data, const RESequencerTrack* track) const;
+    void WriteMidiTrackChunk(REOutputStream& data, const RESequencerTrack* track) const;
     
 private:
     const RESong* _song;
@@ -174,11 +197,14 @@ private:
     std::mutex _renderMutex;
     int32_t _nextUUID;
     RESequencerImpl* const _d;
+    RESoundFont* _defaultSoundFont;
     bool _mergeChannelsOnExport;
+    int _exportThreadCount;
     
     // Calculated from Song
     RETempoTimeline* _tempoTimeline;
     REPlaylistBarVector* _playlist;
+    REPlaylistIndex* _playlistIndex;
     RESequencerTrackVector* _tracks;
 };
 
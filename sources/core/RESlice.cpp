@@ -12,7 +12,10 @@
 #include "REScore.h"
 #include "REBarMetrics.h"
 
+#include "REBar.h"
+
 #include <cmath>
+#include <algorithm>
 
 RESlice::RESlice()
 : _index(-1), _metrics(new REBarMetrics)
@@ -95,6 +98,17 @@ float RESlice::StretchFactor() const
 
 float RESlice::XOffsetOfTick(unsigned int tick) const
 {
+    // Lookup table is available once the score layout is complete
+    if(!_tickOffsets.empty())
+    {
+        RETickOffsetVector::const_iterator last = _tickOffsets.begin() + _metrics->ColumnCount();
+        RETickOffsetVector::const_iterator it = std::lower_bound(_tickOffsets.begin(), last, tick,
+            [](const RETickOffset& to, unsigned int t) {return to.tick < t;});
+        if(it != last && it->tick == tick) {
+            return it->x;
+        }
+    }
+    
     unsigned long flags = 0;
     if(IsFirstInSystem()) flags |= REFLOW_BAR_METRICS_FIRST;
     if(IsLastInSystem()) flags |= REFLOW_BAR_METRICS_LAST;
@@ -212,6 +226,69 @@ RESlice::QueryColumnResult RESlice::QueryColumnAtX(float x, int* columnIndex, fl
     }
 }
 
+float RESlice::InterpolatedXOffsetOfTick(double tick) const
+{
+    if(_tickOffsets.empty()) return 0.0;
+    
+    // First entry strictly after tick
+    RETickOffsetVector::const_iterator it = std::upper_bound(_tickOffsets.begin(), _tickOffsets.end(), tick,
+        [](double t, const RETickOffset& to) {return t < to.tick;});
+    
+    if(it == _tickOffsets.begin()) {
+        return it->x;
+    }
+    if(it == _tickOffsets.end()) {
+        return _tickOffsets.back().x;
+    }
+    
+    const RETickOffset& prev = *(it-1);
+    const RETickOffset& next = *it;
+    float t = (float)((tick - prev.tick) / (double)(next.tick - prev.tick));
+    return prev.x + t * (next.x - prev.x);
+}
+
+void RESlice::_RefreshTickOffsets()
+{
+    _tickOffsets.clear();
+    
+    unsigned int nbColumns = _metrics->ColumnCount();
+    if(nbColumns == 0) return;
+    
+    unsigned long flags = 0;
+    if(IsFirstInSystem()) flags |= REFLOW_BAR_METRICS_FIRST;
+    if(IsLastInSystem()) flags |= REFLOW_BAR_METRICS_LAST;
+    
+    float contentWidth = _metrics->ContentWidth();
+    float leadingSpace = _metrics->LeadingSpace(flags);
+    float trailingSpace = _metrics->TrailingSpace(flags);
+    float realWidth = (Width() - leadingSpace - trailingSpace);
+    float stretch = (contentWidth != 0.0 ? realWidth / contentWidth : 1.0);
+    
+    _tickOffsets.reserve(nbColumns + 1);
+    for(unsigned int i=0; i<nbColumns; ++i)
+    {
+        const REBarMetrics::REBMColumn& column = _metrics->Column(i);
+        RETickOffset to = {column.tick, roundf(leadingSpace + column.xOffset * stretch)};
+        _tickOffsets.push_back(to);
+    }
+    
+    // Last column is interpolated up to the first column of the next slice
+    float endX;
+    if(IsLastInSystem()) {
+        endX = Width();
+    }
+    else {
+        const RESlice* next = NextSibling();
+        endX = next->XOffset() + next->XOffsetOfTick(0) - XOffset();
+    }
+    
+    uint32_t endTick = (uint32_t)Bar()->TheoricDurationInTicks();
+    if(endTick > _tickOffsets.back().tick) {
+        RETickOffset to = {endTick, endX};
+        _tickOffsets.push_back(to);
+    }
+}
+
 const RESlice* RESlice::NextSibling() const
 {
     if(_parent == NULL) return NULL;
@@ -62,11 +62,27 @@ public:
     float XOffsetBeforeTrailingSpace() const;
     QueryColumnResult QueryColumnAtX(float x, int* columnIndex, float* snapX) const;
     
+    float InterpolatedXOffsetOfTick(double tick) const;
+    
     virtual bool IsMultiRest() const {return false;}
     
+public:
+    /** Precomputed x offset of a column (or of the end of the bar), in slice space.
+     */
+    struct RETickOffset {
+        uint32_t tick;
+        float x;
+    };
+    typedef std::vector<RETickOffset> RETickOffsetVector;
+    
+    const RETickOffsetVector& TickOffsets() const {return _tickOffsets;}
+    
+    void _RefreshTickOffsets();
+    
 public:
     int _index;
     REBarMetrics* _metrics;
+    RETickOffsetVector _tickOffsets;
 };
 
 /** REMultiRestSlice
@@ -25,9 +25,13 @@
 #include "REPlaylistCompiler.h"
 #include "REFunctions.h"
 #include "REException.h"
+#include "REJsonStreamReader.h"
+
+#include <atomic>
+#include <thread>
 
 RESong::RESong()
-: _defaultTempo(90)
+: _playlistSignature(0), _playlistCompiled(false), _defaultTempo(90), _refreshThreadCount(0)
 {
     
 }
@@ -262,8 +266,9 @@ void RESong::Refresh(bool refreshTracksToo)
                     bot->GenerateBar(track, barIndex);
                 }
             }
-            track->Refresh();
+            track->RefreshTimelines();
         }
+        _RefreshPhrases();
     }
     
     _tempoTimeline.RemoveIdenticalSiblingItems();
@@ -271,6 +276,47 @@ void RESong::Refresh(bool refreshTracksToo)
     RefreshPlaylist();
 }
 
+void RESong::_RefreshPhrases()
+{
+    REPhraseVector phrases;
+    for(RETrack* track : _tracks) {
+        for(REVoice* voice : track->Voices()) {
+            phrases.insert(phrases.end(), voice->Phrases().begin(), voice->Phrases().end());
+        }
+    }
+    
+    // Below a few dozen phrases per thread, starting the threads costs more than the refresh
+    const int minPhrasesPerThread = 32;
+    int count = (int)phrases.size();
+    int threadCount = _refreshThreadCount;
+    if(threadCount <= 0) {
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threadCount = std::max(1, std::min(threadCount, count / minPhrasesPerThread));
+    
+    // A phrase refresh only reads its own chords and the track settings
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for(int i = next++; i < count; i = next++) {
+            phrases[i]->Refresh(false);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for(int i=1; i<threadCount; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    // Ties cross barlines, fix them in song order once every phrase is refreshed
+    for(REPhrase* phrase : phrases) {
+        phrase->_FixTieFlags();
+    }
+}
+
 const REBar* RESong::FindBarAtTick(int tick) const
 {
     if(_bars.empty()) return NULL;
@@ -474,6 +520,58 @@ void RESong::ReadJson(const REJsonDocument& document, uint32_t version)
     }
 }
 
+void RESong::WriteJson(REOutputStream& stream, uint32_t version) const
+{
+    stream.Reserve(EstimatedJsonSize());
+    
+    REJsonOutputBuffer buffer(stream);
+    REJsonWriter writer(buffer);
+    WriteJson(writer, version);
+    buffer.Flush();
+}
+
+bool RESong::ReadJson(REInputStream& stream, uint32_t version)
+{
+    Clear();
+    
+    REJsonStreamReader reader;
+    reader.SetElementHandler("bars", [this, version](const std::string&, const REJsonValue& obj) {
+        REBar* bar = new REBar;
+        bar->_index = _bars.size();
+        bar->_parent = this;
+        _bars.push_back(bar);
+        bar->ReadJson(obj, version);
+    });
+    reader.SetElementHandler("tracks", [this, version](const std::string&, const REJsonValue& obj) {
+        RETrack* track = new RETrack;
+        track->_index = _tracks.size();
+        track->_parent = this;
+        _tracks.push_back(track);
+        track->ReadJson(obj, version);
+    });
+    reader.SetMemberHandler([this, version](const std::string& key, const REJsonValue& value) {
+        if(key == "tempo_changes" && value.IsArray()) {
+            _tempoTimeline.ReadJson(value, version);
+        }
+    });
+    
+    if(!reader.Read(stream)) {
+        REPrintf("JSON Error: %s\n", reader.Error().c_str());
+        return false;
+    }
+    return true;
+}
+
+unsigned long RESong::EstimatedJsonSize() const
+{
+    // Rough per object sizes of the output, only used as a reserve hint
+    unsigned long size = 256 + 64 * _bars.size() + 256 * _scores.size();
+    for(const RETrack* track : _tracks) {
+        size += 512 + track->VoiceCount() * (16 + 4 * _bars.size());
+    }
+    return size;
+}
+
 void RESong::EncodeTo(REOutputStream& coder) const
 {
     coder.WriteString(_title);
@@ -665,6 +763,8 @@ void RESong::CalculateTickSet(unsigned int barIndex, const RETrackSet& tracks, R
 void RESong::_ClearPlaylist()
 {
     _playlist.clear();
+    _playlistIndex.Clear();
+    _playlistCompiled = false;
 }
 
 REPlaylistBarVector* RESong::ClonePlaylist() const
@@ -672,8 +772,29 @@ REPlaylistBarVector* RESong::ClonePlaylist() const
     return new REPlaylistBarVector(_playlist);
 }
 
+uint64_t RESong::_PlaylistSignature() const
+{
+    // Everything the playlist compiler and the bar ticks depend on
+    std::vector<uint32_t> data;
+    data.reserve(1 + 4 * _bars.size());
+    data.push_back((uint32_t)_bars.size());
+    for(const REBar* bar : _bars)
+    {
+        data.push_back((bar->HasFlag(REBar::RepeatStart) ? 1 : 0) | (bar->HasFlag(REBar::RepeatEnd) ? 2 : 0) | (bar->RepeatCount() << 8));
+        data.push_back(bar->_alternateEndings | (bar->_directionTarget << 8) | (bar->_directionJump << 16));
+        data.push_back(bar->TimeSignature().numerator);
+        data.push_back(bar->TimeSignature().denominator);
+    }
+    return Reflow::Checksum64((const char*)data.data(), data.size() * sizeof(uint32_t));
+}
+
 void RESong::RefreshPlaylist()
 {
+    uint64_t signature = _PlaylistSignature();
+    if(_playlistCompiled && signature == _playlistSignature) {
+        return;
+    }
+    
     _ClearPlaylist();
     
     RESongErrorVector errors;
@@ -683,7 +804,7 @@ void RESong::RefreshPlaylist()
     const std::vector<int>& pl = playlistCompiler.Playlist();
     
     unsigned int nbBars = pl.size();
-    unsigned int barIndex = 0;
+    _playlist.reserve(nbBars);
     uint32_t tick = 0;
     for(int i=0; i<nbBars; ++i)
     {
@@ -702,21 +823,23 @@ void RESong::RefreshPlaylist()
         tick += duration;
         
         _playlist.push_back(pbar);
-        
-        ++barIndex;
     }
+    
+    _playlistIndex.Build(_playlist, (int)_bars.size());
+    _playlistSignature = signature;
+    _playlistCompiled = true;
 }
 
 const REPlaylistBar* RESong::FirstOccurenceOfBarInPlaylist(int barIndex) const
 {
-    for(unsigned int i=0; i<_playlist.size(); ++i) 
-    {
-        const REPlaylistBar* pbar = &_playlist[i];
-        if(pbar->IndexInSong() == barIndex) {
-            return pbar;
-        }
-    }
-    return NULL;
+    int indexInPlaylist = _playlistIndex.FirstOccurenceOfBar(barIndex);
+    return (indexInPlaylist != -1 ? &_playlist[indexInPlaylist] : NULL);
+}
+
+const REPlaylistBar* RESong::PlaylistBarAtTick(unsigned long tick) const
+{
+    int indexInPlaylist = _playlistIndex.IndexInPlaylistAtTick(tick);
+    return (indexInPlaylist != -1 ? &_playlist[indexInPlaylist] : NULL);
 }
 
 unsigned long RESong::PlaylistDurationInTicks() const
@@ -11,10 +11,12 @@
 
 #include "RETypes.h"
 #include "RETimeline.h"
+#include "REPlaylistIndex.h"
 
 class RESong
 {
     friend class REArchive;
+    friend class REChunkedArchive;
     
 public:
     RESong();
@@ -65,6 +67,10 @@ public:
     
 	void Clear();
     void Refresh(bool refreshTracksToo=false);
+    
+    /** Phrases are refreshed on this many threads, 0 for one per core */
+    void SetRefreshThreadCount(int n) {_refreshThreadCount = std::max(0, n);}
+    int RefreshThreadCount() const {return _refreshThreadCount;}
 	
 	void InsertTrack(RETrack* track, int idx);
 	void RemoveTrack(int idx);
@@ -105,10 +111,15 @@ public:
     bool IsBarCollapsibleWithNextSibling(int barIndex) const;
     
     const REPlaylistBarVector& Playlist() const {return _playlist;}
+    const REPlaylistIndex& PlaylistIndex() const {return _playlistIndex;}
+    
+    /** Compiles the playlist again, unless none of the repeats, directions and time signatures changed since the last call */
     void RefreshPlaylist();
+    
     std::string PlaylistAsString() const;
     unsigned long PlaylistDurationInTicks() const;
     const REPlaylistBar* FirstOccurenceOfBarInPlaylist(int barIndex) const;
+    const REPlaylistBar* PlaylistBarAtTick(unsigned long tick) const;
     REPlaylistBarVector* ClonePlaylist() const;
     
     const REBar* FindBarAtTick(int tick) const;
@@ -131,6 +142,14 @@ public:
     void WriteJson(REJsonWriter& writer, uint32_t version) const;
     void ReadJson(const REJsonDocument& document, uint32_t version);
     
+    /** Writes JSON through a buffered writer, reserving room in the stream up front */
+    void WriteJson(REOutputStream& stream, uint32_t version) const;
+    
+    /** Reads JSON without building a DOM of the whole document: bars and tracks are decoded one at a time */
+    bool ReadJson(REInputStream& stream, uint32_t version);
+    
+    unsigned long EstimatedJsonSize() const;
+    
 public:
     static RESong* CreateDefaultSong();
     
@@ -140,13 +159,18 @@ public:
 	
 private:
 	void _UpdateIndices();
+    void _RefreshPhrases();
     void _ClearPlaylist();
+    uint64_t _PlaylistSignature() const;
 	
 private:
     RETrackVector _tracks;
     REBarVector _bars;
     REScoreSettingsVector _scores;
     REPlaylistBarVector _playlist;
+    REPlaylistIndex _playlistIndex;
+    uint64_t _playlistSignature;
+    bool _playlistCompiled;
     RETempoTimeline _tempoTimeline;
     std::string _title;
     std::string _subtitle;
@@ -158,6 +182,7 @@ private:
     std::string _copyright;
     std::string _notice;
     int _defaultTempo;
+    int _refreshThreadCount;
     
     
     unsigned long _totalDurationInTicks;
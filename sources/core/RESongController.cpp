@@ -26,6 +26,35 @@
 #include "RETimer.h"
 #include "REViewport.h"
 
+#include <algorithm>
+
+namespace {
+    
+bool ChordHasNoteWithFlag(const REChord* chord, RENote::NoteFlag flag)
+{
+    if(chord == NULL) return false;
+    for(const RENote* note : chord->Notes()) {
+        if(note->HasFlag(flag)) return true;
+    }
+    return false;
+}
+
+bool PhraseOrder(const REPhrase* a, const REPhrase* b)
+{
+    int ta = a->Track()->Index(), tb = b->Track()->Index();
+    if(ta != tb) return ta < tb;
+    int va = a->Voice()->Index(), vb = b->Voice()->Index();
+    if(va != vb) return va < vb;
+    return a->Index() < b->Index();
+}
+    
+}
+
+void RESongControllerDelegate::SongControllerDidModifyPhrases(const RESongController* controller, const REConstPhraseVector& /*phrases*/, bool successfully)
+{
+    SongControllerDidModifySong(controller, controller->Song(), successfully);
+}
+
 RECreateTrackOptions::RECreateTrackOptions()
 {
     type = Reflow::StandardTrack;
@@ -77,7 +106,7 @@ RECreateTrackOptions& RECreateTrackOptions::operator=(const RECreateTrackOptions
 }
 
 RESongController::RESongController(RESong* song) 
-	: _song(nullptr), _sequencer(nullptr), _updateSinglePhrase(false), _updatedPhrase(nullptr)
+	: _song(nullptr), _sequencer(nullptr), _updateSinglePhrase(false), _updatedPhrase(nullptr), _updatePhrasesOnly(false), _bulkEdit(false), _noteSelection(song)
 {
     _song = song;
     _sequencer = new RESequencer;
@@ -135,6 +164,9 @@ RESongControllerTask* RESongController::PushTask(const std::string& taskName, un
 
 		_updateSinglePhrase = true;
 		_updatedPhrase = NULL;
+        _updatePhrasesOnly = true;
+        _bulkEdit = false;
+        _updatedPhrases.clear();
     }
     _tasks.push_back(task);
     return task;
@@ -151,7 +183,10 @@ void RESongController::CommitTask(RESongControllerTask* task)
 {
     if(_tasks.empty())
     {   
-		if(_updateSinglePhrase && _updatedPhrase != nullptr) {
+		if(_bulkEdit && _updatePhrasesOnly && !_updatedPhrases.empty()) {
+			PhrasesWereUpdated(task->IsFinished());
+		}
+		else if(_updateSinglePhrase && _updatedPhrase != nullptr) {
 			PhraseWasUpdated(_updatedPhrase, task->IsFinished());
 		}
 		else {
@@ -205,6 +240,9 @@ void RESongController::RestoreFromSongDataStream(REInputStream& stream)
 
 void RESongController::SongWillUpdate()
 {
+    // Notes may be deleted or moved, the selection index is rebuilt from the note flags once done
+    _noteSelection.Invalidate();
+    
     for(RESongControllerDelegate* delegate : _delegates) {
         delegate->SongControllerWillModifySong(this, _song);
     }
@@ -221,6 +259,7 @@ void RESongController::SongWasUpdated(bool success)
     
     // Refresh song
     _song->Refresh(true);
+    _patternIndex.Invalidate();
     double deltaTimeForRefresh = timer.DeltaTimeInMilliseconds();
     /*for(int i=0; i<_song->ScoreCount(); ++i) {
         _song->Score(i)->SetDirty();
@@ -233,26 +272,7 @@ void RESongController::SongWasUpdated(bool success)
     
     for(REScoreController* scoreController : _scoreControllers)
     {
-        REScore& score = scoreController->_score;
-        int scoreIndex = scoreController->ScoreIndex();
-        if(scoreIndex >= _song->ScoreCount()) scoreIndex = _song->ScoreCount()-1;
-        const REScoreSettings* scoreSettings = _song->Score(scoreIndex);
-        RETimer timer2; timer2.Start();
-//        score->Refresh();
-        
-        scoreController->ClearViewport(); // <<---
-        score.SetLayoutType(scoreController->LayoutType());
-        score.SetPageLayoutType(scoreController->PageLayoutType());
-        score.Rebuild(*scoreSettings);
-
-        scoreController->_currentCursor.ForceValidPosition();
-        scoreController->_originCursor.ForceValidPosition();
-        
-        scoreController->RebuildViewport();
-        timer2.Stop();
-        REPrintf("[runtime] score rebuild: %1.4f\n", timer2.DeltaTimeInMilliseconds());
-        
-        scoreController->UpdateActions();
+        _RebuildScoreController(scoreController);
         scoreController->SongControllerDidModifySong(this, _song, success);
     }
     
@@ -260,6 +280,107 @@ void RESongController::SongWasUpdated(bool success)
     REPrintf("[runtime] %1.4f ms (song refresh: %1.4f)\n", timer.DeltaTimeInMilliseconds(), deltaTimeForRefresh);
 }
 
+void RESongController::PhrasesWereUpdated(bool success)
+{
+    // Bots generate their bars during a full refresh only
+    for(int trackIndex=0; trackIndex < _song->TrackCount(); ++trackIndex) {
+        if(_song->Track(trackIndex)->Bot()) {
+            SongWasUpdated(success);
+            return;
+        }
+    }
+    
+    RETimer timer;
+    timer.Start();
+    
+    // A tie origin at the end of a phrase may have changed the destination in the next one,
+    // and a destination removed at the start of a phrase leaves a stale origin in the previous one
+    REPhraseVector phrases(_updatedPhrases.begin(), _updatedPhrases.end());
+    for(REPhrase* phrase : phrases)
+    {
+        REPhrase* next = phrase->NextSibling();
+        if(next && ChordHasNoteWithFlag(phrase->LastChord(), RENote::TieOrigin)) {
+            _updatedPhrases.insert(next);
+        }
+        
+        REPhrase* previous = phrase->PreviousSibling();
+        if(previous && ChordHasNoteWithFlag(previous->LastChord(), RENote::TieOrigin)) {
+            _updatedPhrases.insert(previous);
+        }
+    }
+    
+    // Refresh phrases in song order, so that tie flags are fixed from the origin onwards
+    phrases.assign(_updatedPhrases.begin(), _updatedPhrases.end());
+    std::sort(phrases.begin(), phrases.end(), PhraseOrder);
+    
+    REConstPhraseVector modifiedPhrases;
+    modifiedPhrases.reserve(phrases.size() + 1);
+    for(REPhrase* phrase : phrases)
+    {
+        phrase->Refresh(false);
+        if(phrase->_FixTieFlags())
+        {
+            // Tie origins were flagged in the previous phrase
+            REPhrase* previous = phrase->PreviousSibling();
+            if(previous) {
+                previous->Refresh(false);
+                if(_updatedPhrases.find(previous) == _updatedPhrases.end()) {
+                    modifiedPhrases.push_back(previous);
+                }
+            }
+        }
+        modifiedPhrases.push_back(phrase);
+    }
+    
+    // Bar offsets and playlist only, tracks are left untouched
+    _song->Refresh(false);
+    _patternIndex.InvalidatePhrases(modifiedPhrases);
+    double deltaTimeForRefresh = timer.DeltaTimeInMilliseconds();
+    
+    for(RESongControllerDelegate* delegate : _delegates) {
+        delegate->SongControllerDidModifyPhrases(this, modifiedPhrases, success);
+    }
+    
+    for(REScoreController* scoreController : _scoreControllers)
+    {
+        _RebuildScoreController(scoreController);
+        scoreController->SongControllerDidModifyPhrases(this, modifiedPhrases, success);
+    }
+    
+    timer.Stop();
+    REPrintf("[runtime] %1.4f ms for %d phrases (phrase refresh: %1.4f)\n", timer.DeltaTimeInMilliseconds(), (int)modifiedPhrases.size(), deltaTimeForRefresh);
+}
+
+void RESongController::_RebuildScoreController(REScoreController* scoreController)
+{
+    REScore& score = scoreController->_score;
+    int scoreIndex = scoreController->ScoreIndex();
+    if(scoreIndex >= _song->ScoreCount()) scoreIndex = _song->ScoreCount()-1;
+    const REScoreSettings* scoreSettings = _song->Score(scoreIndex);
+    RETimer timer2; timer2.Start();
+//        score->Refresh();
+    
+    scoreController->ClearViewport(); // <<---
+    score.SetLayoutType(scoreController->LayoutType());
+    score.SetPageLayoutType(scoreController->PageLayoutType());
+    score.Rebuild(*scoreSettings);
+    
+    scoreController->_currentCursor.ForceValidPosition();
+    scoreController->_originCursor.ForceValidPosition();
+    
+    scoreController->RebuildViewport();
+    timer2.Stop();
+    REPrintf("[runtime] score rebuild: %1.4f\n", timer2.DeltaTimeInMilliseconds());
+    
+    scoreController->UpdateActions();
+}
+
+const REPatternIndex& RESongController::PatternIndex()
+{
+    _patternIndex.Update(_song);
+    return _patternIndex;
+}
+
 void RESongController::PhraseWasUpdated(REPhrase* phrase, bool success)
 {
 #if 1
@@ -296,6 +417,7 @@ void RESongController::BackupSongStateToStream(REOutputStream& stream)
 
 void RESongController::RestoreSongStateFromStream(REInputStream& stream)
 {
+    _noteSelection.Invalidate();
     _song->DecodeFrom(stream);
 }
 
@@ -335,24 +457,28 @@ RELockSongControllerForTask::~RELockSongControllerForTask()
 RESong* RELockSongControllerForTask::LockSong()
 {
 	_controller->_updateSinglePhrase = false;
+	_controller->_updatePhrasesOnly = false;
     return _controller->_song;
 }
 
 REScoreSettings* RELockSongControllerForTask::LockScore(const REScoreSettings* score)
 {
 	_controller->_updateSinglePhrase = false;
+	_controller->_updatePhrasesOnly = false;
     return (score ? _controller->_song->Score(score->Index()) : NULL);
 }
 
 RETrack* RELockSongControllerForTask::LockTrack(const RETrack* track)
 {
 	_controller->_updateSinglePhrase = false;
+	_controller->_updatePhrasesOnly = false;
     return (track ? _controller->_song->Track(track->Index()) : NULL);
 }
 
 REBar* RELockSongControllerForTask::LockBar(const REBar* bar)
 {
 	_controller->_updateSinglePhrase = false;
+	_controller->_updatePhrasesOnly = false;
     return bar ? _controller->_song->Bar(bar->Index()) : NULL;
 }
 
@@ -370,7 +496,9 @@ REPhrase* RELockSongControllerForTask::LockPhrase(const REPhrase* phrase)
 		}
 	}
 
-    return _controller->_song->PhraseAtLocator(phrase->Locator());
+    REPhrase* lockedPhrase = _controller->_song->PhraseAtLocator(phrase->Locator());
+    if(lockedPhrase) _controller->_updatedPhrases.insert(lockedPhrase);
+    return lockedPhrase;
 }
 
 REChord* RELockSongControllerForTask::LockChord(const REChord* chord)
@@ -393,6 +521,54 @@ RENote* RELockSongControllerForTask::LockNote(const RENote* note)
     return _controller->_song->NoteAtLocator(note->Locator());
 }
 
+
+
+
+
+REBulkEditTask::REBulkEditTask(RESongController* controller, const std::string& name, unsigned long flags)
+: _controller(controller), _lock(controller, name, flags)
+{
+}
+
+REBulkEditTask::OperationVector& REBulkEditTask::_OperationsOfPhrase(const REPhrase* phrase)
+{
+    std::map<const REPhrase*, int>::const_iterator it = _phraseIndices.find(phrase);
+    if(it != _phraseIndices.end()) {
+        return _phrases[it->second];
+    }
+    
+    int index = (int)_phrases.size();
+    _phraseIndices[phrase] = index;
+    _phrases.push_back(OperationVector());
+    return _phrases.back();
+}
+
+void REBulkEditTask::AddChordOperation(const REChord* chord, REChordOperation op)
+{
+    REChord* lockedChord = _lock.LockChord(chord);
+    if(lockedChord == NULL) return;
+    
+    _OperationsOfPhrase(lockedChord->Phrase()).push_back([lockedChord, op]() {op(lockedChord);});
+}
+
+void REBulkEditTask::AddNoteOperation(const RENote* note, RENoteOperation op)
+{
+    RENote* lockedNote = _lock.LockNote(note);
+    if(lockedNote == NULL) return;
+    
+    _OperationsOfPhrase(lockedNote->Chord()->Phrase()).push_back([lockedNote, op]() {op(lockedNote);});
+}
+
+void REBulkEditTask::Commit()
+{
+    for(const OperationVector& operations : _phrases) {
+        for(const std::function<void()>& op : operations) op();
+    }
+    
+    _controller->_bulkEdit = true;
+    _lock.Commit();
+}
+
 void RESongController::DoSomethingWithReflowError(REException& err)
 {
     assert(false);
@@ -822,7 +998,7 @@ void RESongController::SetTrackClefOfBarRange(int trackIndex, int firstBar, int
         clefItemAfter.clef = (clefItemAfterPtr == NULL ? Reflow::TrebleClef : clefItemAfterPtr->clef);
         clefItemAfter.ottavia = (clefItemAfterPtr == NULL ? Reflow::NoOttavia : clefItemAfterPtr->ottavia);
         clefItemAfter.bar = lastBar+1;
-        clefItemAfter.beat = RETimeDiv(0);
+        clefItemAfter.tick = 0;
         
         // Clean items
         clefTimeline.RemoveItemsInBarRange(firstBar, lastBar);
@@ -1223,14 +1399,10 @@ void RESongController::PerformOperationsOnSong(const RESongOperationVector& oper
 
 void RESongController::UnselectAllNotes(REIntSet* affectedBars)
 {
-    _song->UnselectAllNotes(affectedBars);
+    _noteSelection.UnselectAll(affectedBars);
 }
 
 void RESongController::SelectNotes(const RENoteSet& notes)
 {
-    RENoteSet::const_iterator it = notes.begin();
-    for(; it != notes.end(); ++it) {
-        RENote* note = *it;
-        note->SetSelected(true);
-    }
+    _noteSelection.SelectNotes(notes);
 }
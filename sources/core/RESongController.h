@@ -11,6 +11,8 @@
 
 #include "RETypes.h"
 #include "REScore.h"
+#include "RENoteSelection.h"
+#include "REPatternIndex.h"
 
 #include <mutex>
 
@@ -58,6 +60,9 @@ public:
     virtual void SongControllerDidModifySong(const RESongController* controller, const RESong* song, bool successfully) = 0;
 	virtual void SongControllerDidModifyPhrase(const RESongController* controller, const REPhrase* phrase, bool successfully) = 0;
     virtual void SongControllerWantsToBackup(const RESongController* controller, const RESong* song) {};
+    
+    /** Called instead of SongControllerDidModifySong when a bulk edit modified nothing but these phrases */
+    virtual void SongControllerDidModifyPhrases(const RESongController* controller, const REConstPhraseVector& phrases, bool successfully);
 };
 
 typedef std::vector<RESongControllerDelegate*> RESongControllerDelegateVector;
@@ -93,6 +98,7 @@ class RESongController : public RESequencerListener
 {
     friend class RESongControllerTask;
     friend class RELockSongControllerForTask;
+    friend class REBulkEditTask;
     friend class REScoreController;
     
 public:
@@ -125,6 +131,10 @@ public:
 public:
     void UnselectAllNotes(REIntSet* affectedBars=NULL);
     void SelectNotes(const RENoteSet& notes);
+    const RENoteSelection& NoteSelection() const {return _noteSelection;}
+    
+    /** Pattern index of the song, brought up to date with the edits made since the last call */
+    const REPatternIndex& PatternIndex();
     
 public:
     void CreateTrack(const RECreateTrackOptions& opts);
@@ -202,6 +212,8 @@ protected:
     void SongWillUpdate();
     void SongWasUpdated(bool success);
 	void PhraseWasUpdated(REPhrase* phrase, bool success);
+    void PhrasesWereUpdated(bool success);
+    void _RebuildScoreController(REScoreController* scoreController);
     
     void BackupSongStateToStream(REOutputStream& stream);
     void RestoreSongStateFromStream(REInputStream& stream);
@@ -218,7 +230,12 @@ protected:
     RESongControllerDelegateVector _delegates;
 	bool _updateSinglePhrase;
 	REPhrase* _updatedPhrase;
+    bool _updatePhrasesOnly;
+    bool _bulkEdit;
+    std::set<REPhrase*> _updatedPhrases;
     MutexType _dataMutex;
+    RENoteSelection _noteSelection;
+    REPatternIndex _patternIndex;
 };
 
 
@@ -247,4 +264,37 @@ private:
     RESongControllerTask* _task;
 };
 
+
+
+
+/** REBulkEditTask class.
+ *  Collects chord and note operations grouped by phrase and applies them as a single task. If nothing
+ *  else is locked during the task, the song, scores and sequencer are then updated once for the modified
+ *  phrases only, instead of the whole song.
+ */
+class REBulkEditTask
+{
+public:
+    REBulkEditTask(RESongController* controller, const std::string& name, unsigned long flags);
+    
+    void AddChordOperation(const REChord* chord, REChordOperation op);
+    void AddNoteOperation(const RENote* note, RENoteOperation op);
+    REPhrase* LockPhrase(const REPhrase* phrase) {return _lock.LockPhrase(phrase);}
+    
+    int PhraseCount() const {return (int)_phrases.size();}
+    
+    /** Applies the operations, the update happens when the task goes out of scope */
+    void Commit();
+    
+private:
+    typedef std::vector<std::function<void()> > OperationVector;
+    OperationVector& _OperationsOfPhrase(const REPhrase* phrase);
+    
+private:
+    RESongController* _controller;
+    RELockSongControllerForTask _lock;
+    std::vector<OperationVector> _phrases;
+    std::map<const REPhrase*, int> _phraseIndices;
+};
+
 #endif
@@ -12,7 +12,7 @@
 RESoundFontManager* RESoundFontManager::_instance = NULL;
 
 RESoundFontManager::RESoundFontManager()
-: _defaultSoundFont(NULL), _defaultSoundFontPath("")
+: _defaultSoundFont(NULL), _defaultSoundFontPath(""), _idleLoaderCount(0), _stopping(false)
 {
 }
 
@@ -31,3 +31,116 @@ RESoundFont* RESoundFontManager::DefaultSoundFont()
     }
     return _defaultSoundFont;
 }
+
+RESoundFontManager::Entry::Entry(const std::string& path)
+: _path(path), _soundfont(NULL), _state(Loading)
+{
+}
+
+const RESoundFontManager::Entry* RESoundFontManager::SoundFontEntry(const std::string& sf2Path)
+{
+    std::lock_guard<std::mutex> lock(_entriesMutex);
+    return _EntryWithPath(sf2Path);
+}
+
+const RESoundFontManager::Entry* RESoundFontManager::FindSoundFontEntry(const std::string& sf2Path) const
+{
+    std::lock_guard<std::mutex> lock(_entriesMutex);
+    for(const Entry* entry : _entries) {
+        if(entry->_path == sf2Path) return entry;
+    }
+    return NULL;
+}
+
+RESoundFontManager::Entry* RESoundFontManager::_EntryWithPath(const std::string& sf2Path)
+{
+    for(Entry* entry : _entries) {
+        if(entry->_path == sf2Path) return entry;
+    }
+
+    Entry* entry = new Entry(sf2Path);
+    _entries.push_back(entry);
+
+    // The default SoundFont is not read twice
+    if(_defaultSoundFont != NULL && sf2Path == _defaultSoundFontPath) {
+        entry->_soundfont.store(_defaultSoundFont, std::memory_order_release);
+        entry->_state.store(Entry::Loaded, std::memory_order_release);
+    }
+    else if(_stopping) {
+        entry->_state.store(Entry::Failed, std::memory_order_release);
+    }
+    else {
+        // Files are read independently, a new loader is only started when none is waiting for work
+        _pendingEntries.push_back(entry);
+        int maxLoaderCount = std::max(1, (int)std::thread::hardware_concurrency());
+        if(_idleLoaderCount < (int)_pendingEntries.size() && (int)_loaders.size() < maxLoaderCount) {
+            _loaders.push_back(std::thread(&RESoundFontManager::_LoadEntries, this));
+        }
+        _pendingCondition.notify_one();
+    }
+    return entry;
+}
+
+void RESoundFontManager::_LoadEntries()
+{
+    for(;;)
+    {
+        Entry* entry = NULL;
+        {
+            std::unique_lock<std::mutex> lock(_entriesMutex);
+            ++_idleLoaderCount;
+            _pendingCondition.wait(lock, [this] {return _stopping || !_pendingEntries.empty();});
+            --_idleLoaderCount;
+            if(_stopping) return;
+
+            entry = _pendingEntries.front();
+            _pendingEntries.pop_front();
+        }
+
+        // Read without holding the lock, entries can still be asked for meanwhile
+        _LoadEntry(entry);
+    }
+}
+
+void RESoundFontManager::_LoadEntry(Entry* entry)
+{
+    // A truncated file throws from the input stream, it must not take its loader thread down
+    RESoundFont* soundfont = NULL;
+    try {
+        soundfont = LoadSoundFont(entry->_path);
+    }
+    catch(std::exception& e) {
+        REPrintf("Failed to load %s: %s\n", entry->_path.c_str(), e.what());
+        entry->_state.store(Entry::Failed, std::memory_order_release);
+        return;
+    }
+
+    // A file that could not be read has no preset
+    if(soundfont->PresetHeaderCount() == 0) {
+        delete soundfont;
+        entry->_state.store(Entry::Failed, std::memory_order_release);
+        return;
+    }
+
+    entry->_soundfont.store(soundfont, std::memory_order_release);
+    entry->_state.store(Entry::Loaded, std::memory_order_release);
+}
+
+void RESoundFontManager::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(_entriesMutex);
+        _stopping = true;
+        for(Entry* entry : _pendingEntries) {
+            entry->_state.store(Entry::Failed, std::memory_order_release);
+        }
+        _pendingEntries.clear();
+    }
+    _pendingCondition.notify_all();
+
+    // No loader is started once stopping is set, so the pool can be joined without the lock
+    for(std::thread& loader : _loaders) {
+        loader.join();
+    }
+    _loaders.clear();
+}
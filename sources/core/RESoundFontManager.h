@@ -11,26 +11,91 @@
 
 #include "RETypes.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
+
+/** RESoundFontManager class.
+ *  Owns every SoundFont loaded by the application. Each file is loaded once and shared by all the devices
+ *  that play it, so tracks using the same bank share its samples.
+ *
+ *  Besides the default SoundFont, files are only loaded when first asked for, on a small pool of loader threads
+ *  that grows with the files waiting, up to one per core. Devices play the default bank until the SoundFont they
+ *  were given is ready.
+ */
 class RESoundFontManager
 {
+public:
+    /** A SoundFont file, loaded or being loaded. Entries live as long as the manager. */
+    class Entry
+    {
+        friend class RESoundFontManager;
+
+    public:
+        enum State {
+            Loading,
+            Loaded,
+            Failed
+        };
+
+    public:
+        const std::string& Path() const {return _path;}
+        State LoadState() const {return (State)_state.load(std::memory_order_acquire);}
+
+        /** NULL until the file is loaded, may be called from the audio thread */
+        RESoundFont* SoundFont() const {return _soundfont.load(std::memory_order_acquire);}
+
+    private:
+        Entry(const std::string& path);
+
+    private:
+        std::string _path;
+        std::atomic<RESoundFont*> _soundfont;
+        std::atomic<int> _state;
+    };
+
 public:
     static RESoundFontManager& Instance();
-    
+
     RESoundFont* DefaultSoundFont();
 
-    void SetDefaultSoundFontPath(const std::string& sf2Path) {_defaultSoundFontPath = sf2Path;}    
-    
+    void SetDefaultSoundFontPath(const std::string& sf2Path) {_defaultSoundFontPath = sf2Path;}
+    const std::string& DefaultSoundFontPath() const {return _defaultSoundFontPath;}
+
+    /** Entry of a file, queuing it for loading in the background the first time it is asked for */
+    const Entry* SoundFontEntry(const std::string& sf2Path);
+
+    /** Entry of a file already asked for, NULL otherwise */
+    const Entry* FindSoundFontEntry(const std::string& sf2Path) const;
+
+    /** Stops the loader threads once the files being read are done, files still queued are marked as failed */
+    void Shutdown();
+
 private:
     RESoundFontManager();
-    
+
     void LoadDefaultSoundFont();
     RESoundFont* LoadSoundFont(const std::string& sf2Filename);
-    
+
+    Entry* _EntryWithPath(const std::string& sf2Path);
+    void _LoadEntries();
+    void _LoadEntry(Entry* entry);
+
 private:
     RESoundFont* _defaultSoundFont;
     std::string _defaultSoundFontPath;
-    
+
+    std::vector<Entry*> _entries;
+    std::deque<Entry*> _pendingEntries;
+    std::vector<std::thread> _loaders;
+    int _idleLoaderCount;
+    bool _stopping;
+    mutable std::mutex _entriesMutex;
+    std::condition_variable _pendingCondition;
+
 private:
     static RESoundFontManager* _instance;
 };
@@ -38,10 +38,43 @@ static int alteration_for_key_step [15][7] = {
 	{1,1,1,1,1,1,1}
 };
 
+namespace {
+
+int StepOfLine(int line, Reflow::ClefType clef)
+{
+    int step = (clef == Reflow::TrebleClef ? REFLOW_STEP_F1 - line : REFLOW_STEP_A_minus_1 - line) % 7;
+    return (step < 0 ? step + 7 : step);
+}
+
+// Accidentals of every key signature on every line, for the treble clef and the others
+struct KeySignatureAccidentals
+{
+    int8_t lines[2][15][256];
+    
+    KeySignatureAccidentals() {
+        for(int key=0; key<15; ++key) {
+            for(int i=0; i<256; ++i) {
+                lines[0][key][i] = alteration_for_key_step[key][StepOfLine(i - 127, Reflow::TrebleClef)];
+                lines[1][key][i] = alteration_for_key_step[key][StepOfLine(i - 127, Reflow::BassClef)];
+            }
+        }
+    }
+};
+
+const KeySignatureAccidentals& KeyAccidentals()
+{
+    static const KeySignatureAccidentals table;
+    return table;
+}
+    
+}
+
 REStandardNotationCompiler::REStandardNotationCompiler()
-: _transposed(false)
+: _transposed(false), _firstLine(256), _lastLine(-1)
 {
     memset(_accidentalOnLine, 0, sizeof(_accidentalOnLine));
+    memset(_accidentedNoteOnLine, 0, sizeof(_accidentedNoteOnLine));
+    memset(_noteOnLine, 0, sizeof(_noteOnLine));
 }
 
 void REStandardNotationCompiler::InitializeWithPhrase(const REPhrase* phrase, bool transposed)
@@ -51,12 +84,12 @@ void REStandardNotationCompiler::InitializeWithPhrase(const REPhrase* phrase, bo
     _transposingInterval = (transposed ? track->TransposingInterval() : REPitchClass::C);
     
     bool leftHand = phrase->OnLeftHandStaff();
-    const REClefItem* clefAtBar = track->ClefTimeline(leftHand).ItemAt(phrase->Index(), RETimeDiv(0));
+    const REClefItem* clefAtBar = track->ClefTimeline(leftHand).ItemAt(phrase->Index(), (REExactTick)0);
     _clef = (clefAtBar ? clefAtBar->clef : Reflow::TrebleClef);
     _ottavia = (clefAtBar ? clefAtBar->ottavia : Reflow::NoOttavia);
     
     // Initialize accidentals of the key signature
-    const REBar* bar = phrase->Locator().Bar();
+    const REBar* bar = phrase->Bar();
     _key = (bar != NULL ? bar->KeySignature().key : REFLOW_KEY_Cmajor);
     InitializeKeySignatureAccidentals(_key);
 }
@@ -65,15 +98,7 @@ RENotePitch REStandardNotationCompiler::FindPitchInPhrase(const REPhrase* phrase
 {
     Reflow::Accidental accidentalOnLine = Reflow::NoAccidental;
     
-    int step;
-    if(_clef == Reflow::TrebleClef) {
-        step = (REFLOW_STEP_F1 - lineIndex) % 7;
-    }
-    else {
-        step = (REFLOW_STEP_A_minus_1 - lineIndex) % 7;
-    }
-    
-    accidentalOnLine = (Reflow::Accidental) alteration_for_key_step[_key][step];
+    accidentalOnLine = (Reflow::Accidental) alteration_for_key_step[_key][StepOfLine(lineIndex, _clef)];
     
     int maxChordIndex = std::min<unsigned int>(phrase->ChordCount(), chordIndex_+1);
     for(unsigned int chordIndex=0; chordIndex<maxChordIndex; ++chordIndex)
@@ -151,7 +176,7 @@ void REStandardNotationCompiler::CalculateStandardRepresentationOfNote(RENote* n
         }
         
         // There is an accidental on this line
-        if(!graceNote) _accidentedNotesMappedByLine[rep.line] = note;
+        if(!graceNote) _accidentedNoteOnLine[rep.line + 127] = note;
     }
     else {
         rep.accidental = Reflow::NoAccidental;
@@ -163,13 +188,28 @@ void REStandardNotationCompiler::CalculateStandardRepresentationOfNote(RENote* n
     }
     
     // Add Line to our Line set
-    if(!graceNote) _lines.insert(rep.line);
+    if(!graceNote)
+    {
+        int index = rep.line + 127;
+        _noteOnLine[index] = true;
+        if(index < _firstLine) _firstLine = index;
+        if(index > _lastLine) _lastLine = index;
+    }
+}
+
+void REStandardNotationCompiler::ClearLines()
+{
+    for(int i=_firstLine; i<=_lastLine; ++i) {
+        _accidentedNoteOnLine[i] = NULL;
+        _noteOnLine[i] = false;
+    }
+    _firstLine = 256;
+    _lastLine = -1;
 }
 
 void REStandardNotationCompiler::ProcessChord(REChord* chord)
 {
-    _accidentedNotesMappedByLine.clear();
-    _lines.clear();
+    ClearLines();
     
     for(unsigned int noteIndex=0; noteIndex<chord->NoteCount(); ++noteIndex)
     {
@@ -195,29 +235,19 @@ void REStandardNotationCompiler::ProcessChord(REChord* chord)
 
 void REStandardNotationCompiler::InitializeKeySignatureAccidentals(int key)
 {
-    for(int i=0; i<256; ++i)
-    {
-        int line = i - 127;
-        int step;
-        if(_clef == Reflow::TrebleClef) {
-            step = (REFLOW_STEP_F1 - line) % 7;
-        }
-        else {
-            step = (REFLOW_STEP_A_minus_1 - line) % 7;
-        }
-        
-        _accidentalOnLine[i] = alteration_for_key_step[key][step];
-    }
+    const KeySignatureAccidentals& table = KeyAccidentals();
+    memcpy(_accidentalOnLine, table.lines[_clef == Reflow::TrebleClef ? 0 : 1][key], sizeof(_accidentalOnLine));
 }
 
 void REStandardNotationCompiler::CalculateAccidentalOffsets()
 {
     int lineOfAccidentalOffset[6] = {-1000, -1000, -1000, -1000, -1000, -1000};
-    std::map<int, RENote*>::const_iterator it = _accidentedNotesMappedByLine.begin();
-    for(; it != _accidentedNotesMappedByLine.end(); ++it)
+    for(int i=_firstLine; i<=_lastLine; ++i)
     {
-        int line = it->first;
-        RENote* note = it->second;
+        RENote* note = _accidentedNoteOnLine[i];
+        if(note == NULL) continue;
+        
+        int line = i - 127;
         RENote::REStandardRep& rep = note->Representation(_transposed);
         
         rep.accidentalOffset = 0;
@@ -235,63 +265,57 @@ void REStandardNotationCompiler::CalculateAccidentalOffsets()
 
 void REStandardNotationCompiler::CalculateSecondIntervalStacking(REChord* chord)
 {
-    int lineCount = _lines.size();
-    if(lineCount > 1)
+    if(_firstLine >= _lastLine) return;
+    
+    // When stem is down
     {
-        // When stem is down
+        bool lastReversed = false;
+        int last = _firstLine;
+        for(int i=_firstLine+1; i<=_lastLine; ++i)
         {
-            bool lastReversed = false;
-            REIntSet::const_iterator it = _lines.begin();
-            int last = *it;
-            ++it;
-            while(it != _lines.end())
+            if(!_noteOnLine[i]) continue;
+            
+            if((i - last) == 1)
             {
-                int line = *it;
-                if((line - last) == 1)
+                RENote* note = chord->NoteOnStaffLine(i - 127, _transposed);
+                if(note && !lastReversed)
                 {
-                    RENote* note = chord->NoteOnStaffLine(line, _transposed);
-                    if(note && !lastReversed)
-                    {
-                        RENote::REStandardRep& rep = note->Representation(_transposed);
-                        rep.flags |= RENote::StackedSecondOnOppositeSideWithStemDown;
-                        lastReversed = true;
-                    }
-                    else lastReversed = false;
-                }
-                else {
-                    lastReversed = false;
+                    RENote::REStandardRep& rep = note->Representation(_transposed);
+                    rep.flags |= RENote::StackedSecondOnOppositeSideWithStemDown;
+                    lastReversed = true;
                 }
-                last = line;
-                ++it;
+                else lastReversed = false;
             }
+            else {
+                lastReversed = false;
+            }
+            last = i;
         }
-        
-        // When stem is up
+    }
+    
+    // When stem is up
+    {
+        bool lastReversed = false;
+        int last = _lastLine;
+        for(int i=_lastLine-1; i>=_firstLine; --i)
         {
-            bool lastReversed = false;
-            REIntSet::const_reverse_iterator it = _lines.rbegin();
-            int last = *it;
-            ++it;
-            while(it != _lines.rend())
+            if(!_noteOnLine[i]) continue;
+            
+            if((last - i) == 1)
             {
-                int line = *it;
-                if((last - line) == 1)
+                RENote* note = chord->NoteOnStaffLine(i - 127, _transposed);
+                if(note && !lastReversed)
                 {
-                    RENote* note = chord->NoteOnStaffLine(line, _transposed);
-                    if(note && !lastReversed)
-                    {
-                        RENote::REStandardRep& rep = note->Representation(_transposed);
-                        rep.flags |= RENote::StackedSecondOnOppositeSideWithStemUp;
-                        lastReversed = true;
-                    }
-                    else lastReversed = false;
-                }
-                else {
-                    lastReversed = false;
+                    RENote::REStandardRep& rep = note->Representation(_transposed);
+                    rep.flags |= RENote::StackedSecondOnOppositeSideWithStemUp;
+                    lastReversed = true;
                 }
-                last = line;
-                ++it;
+                else lastReversed = false;
             }
+            else {
+                lastReversed = false;
+            }
+            last = i;
         }
     }
-}
\ No newline at end of file
+}
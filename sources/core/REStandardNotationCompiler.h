@@ -30,6 +30,7 @@ protected:
     void CalculateStandardRepresentationOfNote(RENote* note, bool graceNote);
     void CalculateAccidentalOffsets();
     void CalculateSecondIntervalStacking(REChord* chord);
+    void ClearLines();
     
 protected:
     int8_t _accidentalOnLine[256];
@@ -39,9 +40,11 @@ protected:
     Reflow::ClefType _clef;
     Reflow::OttaviaType _ottavia;
     
-    // Reset these for each chord
-    std::map<int, RENote*> _accidentedNotesMappedByLine;
-    REIntSet _lines;
+    // Reset these for each chord, indexed like _accidentalOnLine
+    RENote* _accidentedNoteOnLine[256];
+    bool _noteOnLine[256];
+    int _firstLine;
+    int _lastLine;
 };
 
 #endif /* defined(__Reflow__REStandardNotationCompiler__) */
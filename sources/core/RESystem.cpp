@@ -23,6 +23,7 @@
 
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 
 #include <boost/format.hpp>
 
@@ -160,6 +161,11 @@ float RESystem::ContentWidth() const
 
 const RESlice* RESystem::SystemBarWithBarIndex(int barIndex) const
 {
+    if(_score != NULL && _barRange.IsInRange(barIndex)) {
+        int sliceIndex = _score->SliceIndexOfBar(barIndex);
+        if(sliceIndex != -1) return SystemBar(sliceIndex);
+    }
+    
     for(unsigned int i=0; i<_systemBars.size(); ++i)
     {   
         const RESlice* systemBar = SystemBar(i);
@@ -172,6 +178,11 @@ const RESlice* RESystem::SystemBarWithBarIndex(int barIndex) const
 
 RESlice* RESystem::SliceWithBarIndex(int barIndex)
 {
+    if(_score != NULL && _barRange.IsInRange(barIndex)) {
+        int sliceIndex = _score->SliceIndexOfBar(barIndex);
+        if(sliceIndex != -1) return SystemBar(sliceIndex);
+    }
+    
     for(unsigned int i=0; i<_systemBars.size(); ++i)
     {   
         RESlice* systemBar = SystemBar(i);
@@ -416,18 +427,39 @@ const REStaff* RESystem::StaffAtY(float y, int* lineIndex) const
 
 const RESlice* RESystem::SystemBarAtX(float x, float* relativeX) const
 {
-    for(unsigned int i=0; i<_systemBars.size(); ++i)
-    {
-        const RESlice* systemBar = SystemBar(i);
-        float dx = x - systemBar->XOffset();
-        if(dx >= 0.0 && dx < systemBar->Width()) {
-            *relativeX = dx;
-            return systemBar;
-        }
+    int sliceIndex = SliceIndexAtX(x);
+    if(sliceIndex == -1) return NULL;
+    
+    const RESlice* systemBar = SystemBar(sliceIndex);
+    float dx = x - systemBar->XOffset();
+    if(dx >= 0.0 && dx < systemBar->Width()) {
+        *relativeX = dx;
+        return systemBar;
     }
     return NULL;
 }
 
+int RESystem::SliceIndexAtX(float x) const
+{
+    // Slices are laid out left to right, so we can binary search them
+    RESystemBarVector::const_iterator it = std::upper_bound(_systemBars.begin(), _systemBars.end(), x,
+        [](float x, const RESlice* slice) {return x < slice->XOffset();});
+    
+    if(it == _systemBars.begin()) return -1;
+    return (int)(it - _systemBars.begin()) - 1;
+}
+
+RERange RESystem::SliceRangeInXInterval(float x0, float x1) const
+{
+    if(_systemBars.empty() || x1 < x0) return RERange(0, 0);
+    
+    int first = std::max<int>(0, SliceIndexAtX(x0));
+    int last = SliceIndexAtX(x1);
+    if(last < first) return RERange(0, 0);
+    
+    return RERange(first, last - first + 1);
+}
+
 unsigned int RESystem::ListGizmos(Reflow::GizmoType type, REGizmoVector& gizmos) const
 {
     
@@ -638,7 +670,7 @@ void RESystem::DrawSlice(REPainter& painter, int sliceIndex) const
             for(int idx = firstIdx; idx <= lastIdx; ++idx)
             {
                 const RETempoItem* item = tempoMarkers.Item(idx);
-                int tick = Reflow::TimeDivToTicks(item->beat);
+                int tick = Reflow::ExactTicksToTicks(item->tick);
                 float x = (tick == 0 ? 0 : systemBar->XOffsetOfTick(tick));
                 REPoint pt = REPoint(x+0.5, _tempoMarkerYOffset);
                 
@@ -70,6 +70,8 @@ public:
     
     const REStaff* StaffAtY(float y, int* lineIndex) const;
     const RESlice* SystemBarAtX(float x, float* relativeX) const;
+    int SliceIndexAtX(float x) const;
+    RERange SliceRangeInXInterval(float x0, float x1) const;
     
     const RESlice* SystemBarWithBarIndex(int barIndex) const;
     RESlice* SliceWithBarIndex(int barIndex);
@@ -31,6 +31,10 @@ public:
     
     // Returns the (index,exact) pair for the event that is applied at given <bar,beat>.
     int IndexOfItemAt(int bar, const RETimeDiv& beat, bool* exact) const {
+        return IndexOfItemAt(bar, Reflow::TimeDivToExactTicks(beat), exact);
+    }
+    
+    int IndexOfItemAt(int bar, REExactTick tick, bool* exact) const {
         int idx=0;
         for(; idx<ItemCount(); ++idx)
         {
@@ -40,14 +44,14 @@ public:
             }
             else if (it->bar == bar) 
             {
-                if(it->beat > beat) {
+                if(it->tick > tick) {
                     break;
                 }
-                else if(it->beat == beat) {
+                else if(it->tick == tick) {
                     if(exact != 0) *exact = true;
                     return idx;
                 }
-                else { // it->beat < beat
+                else { // it->tick < tick
                 }
             }
             else {  // (it->bar < bar)
@@ -63,10 +67,15 @@ public:
         return Item(IndexOfItemAt(bar,beat,exact));
     }
     
+    const T* ItemAt(int bar, REExactTick tick, bool* exact=0) const
+    {
+        return Item(IndexOfItemAt(bar,tick,exact));
+    }
+    
     void InsertItem(const T& val) 
     {
         bool exact;
-        int index = IndexOfItemAt(val.bar, val.beat, &exact);
+        int index = IndexOfItemAt(val.bar, val.tick, &exact);
         if(exact) {
             _items[index] = val;
         }
@@ -109,7 +118,7 @@ public:
             }
         }
         
-        if(barIndex == 0 && NULL == ItemAt(barIndex, RETimeDiv(0))) {
+        if(barIndex == 0 && NULL == ItemAt(barIndex, (REExactTick)0)) {
             _items.insert(_items.begin(), first);
         }
     }
@@ -128,7 +137,7 @@ public:
             }
         }
         
-        if(barIndex == 0 && NULL == ItemAt(barIndex, RETimeDiv(0))) {
+        if(barIndex == 0 && NULL == ItemAt(barIndex, (REExactTick)0)) {
             _items.insert(_items.begin(), first);
         }
     }
@@ -268,15 +277,17 @@ private:
 class RETimelineItem
 {
 public:    
-    RETimeDiv beat;
+    REExactTick tick;       // position in bar, RETimeDiv once serialized
     int bar;
     
-    RETimelineItem() {}
+    RETimelineItem() : tick(0), bar(0) {}
     
     RETimelineItem(int bar_, const RETimeDiv& beat_) 
-    : beat(beat_), bar(bar_)
+    : tick(Reflow::TimeDivToExactTicks(beat_)), bar(bar_)
     {}
     
+    RETimeDiv Beat() const {return Reflow::ExactTicksToTimeDiv(tick);}
+    
     virtual ~RETimelineItem() {}
     
     virtual void WriteContentsToJson(REJsonWriter& writer, uint32_t version) const
@@ -285,7 +296,7 @@ public:
         writer.StartObject();
         {
             writer.String("bar"); writer.Int(bar);
-            writer.String("div"); Reflow::WriteTimeDivToJson(beat, writer, version);
+            writer.String("div"); Reflow::WriteTimeDivToJson(Beat(), writer, version);
         }
         writer.EndObject();
     }
@@ -299,12 +310,17 @@ public:
             if(bar_.IsInt()) {bar = bar_.GetInt();}
             
             const REJsonValue& beat_ = at["div"];
-            if(!beat_.IsNull()) {Reflow::ReadTimeDivFromJson(beat, beat_, version);}
+            if(!beat_.IsNull()) {
+                RETimeDiv beat = Beat();
+                Reflow::ReadTimeDivFromJson(beat, beat_, version);
+                tick = Reflow::TimeDivToExactTicks(beat);
+            }
         }
     }
     
     virtual void EncodeTo(REOutputStream& coder) const
     {
+        RETimeDiv beat = Beat();
         coder.WriteUInt32(beat.numerator());
         coder.WriteUInt32(beat.denominator());
         coder.WriteUInt16(bar);
@@ -314,7 +330,7 @@ public:
     {
         uint32_t num = decoder.ReadUInt32();
         uint32_t den = decoder.ReadUInt32();
-        beat = RETimeDiv(num,den);
+        tick = Reflow::TimeDivToExactTicks(RETimeDiv(num,den));
         bar = decoder.ReadUInt16();
     }  
 };
@@ -57,14 +57,19 @@ void RETrack::SetBot(REBot* bot)
 
 void RETrack::Refresh()
 {
-    _clefTimeline.RemoveIdenticalSiblingItems();
-    _clefTimelineLeftHand.RemoveIdenticalSiblingItems();
+    RefreshTimelines();
     
     for(REVoiceVector::const_iterator it = _voices.begin(); it != _voices.end(); ++it) {
         (*it)->Refresh();
     }
 }
 
+void RETrack::RefreshTimelines()
+{
+    _clefTimeline.RemoveIdenticalSiblingItems();
+    _clefTimelineLeftHand.RemoveIdenticalSiblingItems();
+}
+
 const REVoice* RETrack::Voice(int idx) const
 {
     if(idx >= 0 && idx < _voices.size()) {
@@ -209,6 +214,18 @@ bool RETrack::IsBarEmptyAndCollapsibleWithNextSibling(int barIndex) const
     return firstIsEmpty && secondIsEmpty;
 }
 
+REPitchSummary RETrack::PitchSummaryOfBar(int barIndex) const
+{
+    REPitchSummary summary;
+    for(unsigned int i=0; i<_voices.size(); ++i) {
+        const REPhrase* phrase = _voices[i]->Phrase(barIndex);
+        if(phrase) {
+            summary.Merge(phrase->PitchSummary());
+        }
+    }
+    return summary;
+}
+
 // Since we have Grand Staff, this method is not called anymore
 unsigned int RETrack::VoiceCountOfBar(int barIndex) const
 {
@@ -23,6 +23,7 @@ class RETrack
     friend class REGuitarProParser;
     friend class RESequencer;
     friend class REArchive;
+    friend class REChunkedArchive;
     friend class REScoreController;
 	
 public:
@@ -96,6 +97,7 @@ public:
     
 	void Clear();
     void Refresh();
+    void RefreshTimelines();
     RETrack* Clone();
 	
 	int Index() const {return _index;}
@@ -108,6 +110,7 @@ public:
     int MaxDurationInTicksOfBar(int barIndex) const;
     unsigned int VoiceCountOfBar(int barIndex) const;
     unsigned int VoiceCountOfBarInGrandStaff(int barIndex, int grandStaff) const;
+    REPitchSummary PitchSummaryOfBar(int barIndex) const;
 	
     bool HasClefChangeAtBar(int barIndex) const;
     bool HasClefChangeAtBarOnHand(int barIndex, bool leftHand) const;
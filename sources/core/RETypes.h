@@ -78,6 +78,7 @@
 #define REFLOW_MAX_TRACKS           (8*16)
 #define REFLOW_MAX_VOICES           (4)
 #define REFLOW_PULSES_PER_QUARTER   (480)
+#define REFLOW_EXACT_TICKS_PER_QUARTER  (46126080)     // 2^10 * lcm(1..16) / 16
 #define REFLOW_STEP_F1              (45)
 #define REFLOW_STEP_C1              (42)
 #define REFLOW_STEP_C0              (35)
@@ -155,6 +156,7 @@ class RECursor;
 class RELocator;
 class REOutputStream;
 class REBufferOutputStream;
+class REJsonOutputBuffer;
 class REInputStream;
 class REBufferInputStream;
 class REConstBufferInputStream;
@@ -178,6 +180,7 @@ class REMusicRack;
 class REMusicRackDelegate;
 class REMusicDevice;
 class REPlaylistBar;
+class REPlaylistIndex;
 class REMidiClip;
 class REMonoSample;
 class RESamplePlayer;
@@ -283,9 +286,9 @@ typedef std::vector<RESongOperation>				RESongOperationVector;
 typedef std::vector<REBarOperation>					REBarOperationVector;
 
 #ifdef DEBUG
-typedef rapidjson::PrettyWriter<REOutputStream> REJsonWriter;
+typedef rapidjson::PrettyWriter<REJsonOutputBuffer> REJsonWriter;
 #else
-typedef rapidjson::Writer<REOutputStream> REJsonWriter;
+typedef rapidjson::Writer<REJsonOutputBuffer> REJsonWriter;
 #endif
 typedef rapidjson::Document REJsonDocument;
 typedef rapidjson::Value REJsonValue;
@@ -917,6 +920,13 @@ public:
  */
 typedef boost::rational<int32_t> RETimeDiv;
 
+/** REExactTick type.
+ *  Time in ticks at REFLOW_EXACT_TICKS_PER_QUARTER. Every note value down to the double dotted 64th,
+ *  in tuplets of up to 16 notes, is a whole number of exact ticks, so chord offsets and durations are
+ *  summed and compared as plain integers. RETimeDiv remains the serialized representation.
+ */
+typedef int64_t REExactTick;
+
 
 /** REIndexPair class.
  */
@@ -1138,6 +1148,34 @@ public:
     RENotePitch Transposed(const REPitchClass& interval) const;
 };
 
+/** REPitchSummary class.
+ *  Pitch range, note count and content checksum of a phrase or bar, cheap enough to be compared on every refresh.
+ */
+class REPitchSummary
+{
+public:
+    int8_t minPitch;
+    int8_t maxPitch;
+    uint16_t noteCount;
+    uint32_t checksum;
+    
+    REPitchSummary() : minPitch(127), maxPitch(0), noteCount(0), checksum(0) {}
+    
+    bool IsEmpty() const {return noteCount == 0;}
+    
+    void Merge(const REPitchSummary& rhs) {
+        if(rhs.minPitch < minPitch) minPitch = rhs.minPitch;
+        if(rhs.maxPitch > maxPitch) maxPitch = rhs.maxPitch;
+        noteCount += rhs.noteCount;
+        checksum = (checksum * 16777619u) ^ rhs.checksum;
+    }
+    
+    bool operator==(const REPitchSummary& rhs) const {
+        return minPitch == rhs.minPitch && maxPitch == rhs.maxPitch && noteCount == rhs.noteCount && checksum == rhs.checksum;
+    }
+    bool operator!=(const REPitchSummary& rhs) const {return !(*this == rhs);}
+};
+
 /** REStringFretPair class.
  */
 class REStringFretPair
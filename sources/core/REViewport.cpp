@@ -95,13 +95,8 @@ void REViewport::Build()
 
         case Reflow::HorizontalScoreLayout:
         {
-            RESystem* hsystem = score->System(0);
-            for(RESlice* slice : hsystem->Slices())
-            {
-                REViewportSliceItem* sliceItem = CreateSliceItem(slice);
-                if(!sliceItem) continue;
-                slice->SetViewportItem(sliceItem);
-            }
+            // Slice items are materialized on demand by UpdateVisibleViews
+            _materializedSliceRange = RERange(0, 0);
             break;
         }
     }
@@ -224,9 +219,20 @@ void REViewport::Clear()
                     slice->SetViewportItem(NULL);
                 }
             }
+            _materializedSliceRange = RERange(0, 0);
             break;
         }
     }
+    
+    _DestroyRecycledSliceItems();
+}
+
+void REViewport::_DestroyRecycledSliceItems()
+{
+    for(REViewportSliceItem* sliceItem : _recycledSliceItems) {
+        DestroySliceItem(sliceItem);
+    }
+    _recycledSliceItems.clear();
 }
 
 const REScore* REViewport::Score() const
@@ -549,7 +555,7 @@ void REViewport::RepositionTabCursor()
 void REViewport::UpdateVisibleViews()
 {
     REScore* score = Score();
-    if(score == NULL) return;
+    if(score == NULL || score->Root() == NULL) return;
     
     RERect visRect = ViewportVisibleRect();
     
@@ -565,10 +571,7 @@ void REViewport::UpdateVisibleViews()
         }
         case Reflow::HorizontalScoreLayout:
         {
-            for(RESlice* slice : score->System(0)->Slices()) {
-                REViewportItem* item = slice->ViewportItem();
-                if(item) item->AttachToViewport(RERect::Intersects(slice->SceneFrame(), visRect));
-            }
+            _MaterializeVisibleSlices(visRect);
             break;
         }
     }
@@ -580,6 +583,56 @@ void REViewport::UpdateVisibleViews()
     }
 }
 
+void REViewport::_MaterializeVisibleSlices(const RERect& visRect)
+{
+    RESystem* hsystem = Score()->System(0);
+    if(hsystem == NULL) return;
+    
+    // Keep a margin of one viewport on each side so that scrolling does not expose empty slices
+    float margin = std::max<float>(visRect.Width(), 400.0f);
+    float systemX = hsystem->SceneFrame().origin.x;
+    RERange range = hsystem->SliceRangeInXInterval(visRect.Left() - margin - systemX, visRect.Right() + margin - systemX);
+    
+    // Recycle items of slices that left the window
+    for(int sliceIndex = _materializedSliceRange.FirstIndex(); sliceIndex <= _materializedSliceRange.LastIndex(); ++sliceIndex)
+    {
+        if(range.IsInRange(sliceIndex)) continue;
+        
+        RESlice* slice = hsystem->SystemBar(sliceIndex);
+        if(slice == NULL) continue;
+        
+        REViewportSliceItem* sliceItem = static_cast<REViewportSliceItem*>(slice->ViewportItem());
+        if(sliceItem) {
+            sliceItem->AttachToViewport(false);
+            slice->SetViewportItem(NULL);
+            _recycledSliceItems.push_back(sliceItem);
+        }
+    }
+    
+    // Materialize slices of the window, reusing recycled items first
+    for(int sliceIndex = range.FirstIndex(); sliceIndex <= range.LastIndex(); ++sliceIndex)
+    {
+        RESlice* slice = hsystem->SystemBar(sliceIndex);
+        REViewportSliceItem* sliceItem = static_cast<REViewportSliceItem*>(slice->ViewportItem());
+        if(sliceItem == NULL)
+        {
+            if(!_recycledSliceItems.empty()) {
+                sliceItem = _recycledSliceItems.back();
+                _recycledSliceItems.pop_back();
+                sliceItem->SetSlice(slice);
+            }
+            else {
+                sliceItem = CreateSliceItem(slice);
+                if(sliceItem == NULL) continue;
+            }
+            slice->SetViewportItem(sliceItem);
+        }
+        sliceItem->AttachToViewport(RERect::Intersects(slice->SceneFrame(), visRect));
+    }
+    
+    _materializedSliceRange = range;
+}
+
 void REViewport::Update()
 {
     // Update playback cursor
@@ -629,7 +682,7 @@ void REViewport::UpdatePlaybackCursor(float dt)
         
         const REScore* score = _scoreController->Score();
         const RESystem* system = score->SystemWithBarIndex(_barPlaying);
-        const RESlice* slice = (system ? system->SystemBarWithBarIndex(_barPlaying) : NULL);
+        const RESlice* slice = score->SliceWithBarIndex(_barPlaying);
         if(system != NULL && slice != NULL)
         {
             RERect systemRect = system->SceneFrame();
@@ -638,37 +691,11 @@ void REViewport::UpdatePlaybackCursor(float dt)
             systemRect.origin.y -= 40.0;
             systemRect.size.h += 80.0;
             RERect sliceRect = slice->SceneFrame();
-            const REBarMetrics& metrics = slice->Metrics();
             
             const RESystem* nextSystem = score->System(1 + system->Index());
             RERect nextSystemRect = (nextSystem ? nextSystem->SceneFrame() : systemRect);
             
-            float playbackIndicatorX = 0.0;
-            unsigned long prevTick, nextTick;
-            int columnIndex = metrics.ColumnIndexAtOrBeforeTick(_tickInBarPlaying, &prevTick, &nextTick);
-            if(columnIndex == -1) {
-            }
-            else if(columnIndex == metrics.ColumnCount()-1)
-            {
-                nextTick = slice->Bar()->TheoricDurationInTicks();
-                float t = (float)((long)_tickInBarPlaying - (long)prevTick) / (float)(nextTick-prevTick);
-                float x0, x1;
-                x0 = slice->XOffsetOfTick(prevTick);
-                if(slice->IsLastInSystem()) {
-                    x1 = slice->Width();
-                }
-                else {
-                    const RESlice* sbarNext = slice->NextSibling();
-                    x1 = sbarNext->XOffset() + sbarNext->XOffsetOfTick(0) - slice->XOffset();
-                }
-                playbackIndicatorX = x0 + t * (x1-x0);
-            }
-            else {
-                float t = (float)((long)_tickInBarPlaying - (long)prevTick) / (float)(nextTick-prevTick);
-                float x0 = slice->XOffsetOfTick(prevTick);
-                float x1 = slice->XOffsetOfTick(nextTick);
-                playbackIndicatorX = x0 + t * (x1-x0);
-            }
+            float playbackIndicatorX = slice->InterpolatedXOffsetOfTick(_tickInBarPlaying);
             
             float x = sliceRect.origin.x + playbackIndicatorX;
             float y = sliceRect.origin.y;
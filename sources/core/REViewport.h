@@ -80,12 +80,18 @@ public:
 protected:
     void SmoothUpdatePlayback(float dt);
     void _UpdatePlaybackRT(const RESequencer* sequencer);
+    void _MaterializeVisibleSlices(const RERect& visRect);
+    void _DestroyRecycledSliceItems();
     
 protected:
     REScoreController* _scoreController;
     RESize _size;
     REPoint _offset;
     
+    // Horizontal Layout: only slices around the visible rect own a viewport item
+    RERange _materializedSliceRange;
+    std::vector<REViewportSliceItem*> _recycledSliceItems;
+    
     // Tab Input Tool
     bool _tabInputCursorVisible;
     bool _tabInputGraceCursorVisible;
@@ -202,6 +208,9 @@ public:
 
     virtual void UpdateFrame() = 0;    
     
+    const RESlice* Slice() const {return _slice;}
+    virtual void SetSlice(const RESlice* slice) {_slice = slice;}
+    
 protected:
     const RESlice* _slice;
 };
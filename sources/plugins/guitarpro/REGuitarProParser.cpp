@@ -21,7 +21,7 @@
 #include "REException.h"
 
 REGuitarProParser::REGuitarProParser()
-: _decoder(0), _error(""), _trackCount(0), _barCount(0), _version(0), _currentBarIndex(0), _currentTrackIndex(0), _ownSong(false)
+: _decoder(0), _song(0), _error(""), _trackCount(0), _barCount(0), _version(0), _currentBarIndex(0), _currentTrackIndex(0), _ownSong(false), _songRefreshEnabled(true)
 {
     
 }
@@ -180,6 +180,16 @@ bool REGuitarProParser::Parse(REInputStream *decoder, RESong* song)
         }
         _decoder = decoder;
         
+        // A parser may be reused for several files
+        if(_ownSong && _song) {
+            delete _song;
+        }
+        _error = "";
+        _trackCount = 0;
+        _barCount = 0;
+        _currentBarIndex = 0;
+        _currentTrackIndex = 0;
+        
         if(song == 0) {
             _song = new RESong;
             _ownSong = true;
@@ -355,7 +365,9 @@ bool REGuitarProParser::Parse(REInputStream *decoder, RESong* song)
             }
         }
         
-        _song->Refresh(true);
+        if(_songRefreshEnabled) {
+            _song->Refresh(true);
+        }
     }
     catch(REException& e)
     {
@@ -373,6 +385,16 @@ bool REGuitarProParser::Parse(REInputStream *decoder, RESong* song)
     return true;
 }
 
+bool REGuitarProParser::ParseFile(const std::string& filename, RESong* song)
+{
+    REMappedFileInputStream decoder;
+    if(!decoder.Open(filename)) {
+        _error = "Failed to open " + filename;
+        return false;
+    }
+    decoder.SetVersion(REFLOW_IO_VERSION);
+    return Parse(&decoder, song);
+}
 
 void REGuitarProParser::ParseTrack()
 {
@@ -22,6 +22,11 @@ public:
     
 public:
     bool Parse(REInputStream* decoder, RESong* song=0);
+    bool ParseFile(const std::string& filename, RESong* song=0);
+    
+    /** When disabled, the song is left unrefreshed after parsing so that callers can time or batch the refresh themselves */
+    void SetSongRefreshEnabled(bool enabled) {_songRefreshEnabled = enabled;}
+    bool IsSongRefreshEnabled() const {return _songRefreshEnabled;}
     
     static bool IsHeaderValid(const char*data, int length);
     
@@ -63,6 +68,7 @@ private:
     RESong* _song;
     std::string _error;
     bool _ownSong;
+    bool _songRefreshEnabled;
     unsigned int _version;
     
     unsigned int _trackCount;
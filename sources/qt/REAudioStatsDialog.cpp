@@ -0,0 +1,93 @@
+#include "REAudioStatsDialog.h"
+#include "ui_REAudioStatsDialog.h"
+
+#include "REAudioEngine.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QPushButton>
+
+REAudioStatsDialog::REAudioStatsDialog(REAudioEngine* engine, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::REAudioStatsDialog),
+    _engine(engine)
+{
+    ui->setupUi(this);
+
+    QPushButton* resetButton = ui->buttonBox->addButton(tr("Reset"), QDialogButtonBox::ResetRole);
+    QPushButton* saveButton = ui->buttonBox->addButton(tr("Save..."), QDialogButtonBox::ActionRole);
+    connect(resetButton, SIGNAL(clicked()), this, SLOT(ResetStats()));
+    connect(saveButton, SIGNAL(clicked()), this, SLOT(SaveStats()));
+
+    Refresh();
+    startTimer(500);
+}
+
+REAudioStatsDialog::~REAudioStatsDialog()
+{
+    delete ui;
+}
+
+void REAudioStatsDialog::timerEvent(QTimerEvent *)
+{
+    Refresh();
+}
+
+void REAudioStatsDialog::Refresh()
+{
+    REAudioEngineStats::Report report = _engine->Stats().Snapshot();
+
+    double bufferPeriod = (report.sampleRate > 0 ? report.bufferFrames / report.sampleRate : 0.0);
+
+    QString text;
+    text += tr("Buffer: %1 frames @ %2 Hz (%3 ms)\n")
+            .arg(report.bufferFrames).arg(report.sampleRate, 0, 'f', 0).arg(1000.0 * bufferPeriod, 0, 'f', 2);
+    text += tr("Callbacks: %1\n").arg((qulonglong)report.callbacks);
+    text += tr("Xruns: %1\n").arg((qulonglong)report.xruns);
+    text += tr("DSP load: %1% last, %2% average, %3% max\n")
+            .arg(100.0 * report.lastLoad, 0, 'f', 1)
+            .arg(100.0 * report.averageLoad, 0, 'f', 1)
+            .arg(100.0 * report.maxLoad, 0, 'f', 1);
+    text += tr("Longest callback: %1 ms\n").arg(1000.0 * report.maxCallbackTime, 0, 'f', 3);
+    text += tr("Lock wait: %1 ms total, %2 ms max\n")
+            .arg(1000.0 * report.totalLockWait, 0, 'f', 3)
+            .arg(1000.0 * report.maxLockWait, 0, 'f', 3);
+    text += tr("Max voices: %1\n").arg(report.maxVoices);
+    text += tr("Events processed: %1\n").arg((qulonglong)report.events);
+
+    text += tr("\nCallback duration over buffer period:\n");
+    for(int i=0; i<REAudioEngineStats::HistogramBinCount; ++i)
+    {
+        double lowerLoad = (i > 0 ? REAudioEngineStats::LoadOfHistogramBin(i - 1) : 0.0);
+        QString range = (i == REAudioEngineStats::HistogramBinCount - 1 ?
+                         QString(">= %1%").arg(100.0 * lowerLoad, 0, 'f', 0) :
+                         QString("%1-%2%").arg(100.0 * lowerLoad, 0, 'f', 0).arg(100.0 * REAudioEngineStats::LoadOfHistogramBin(i), 0, 'f', 0));
+        double ratio = (report.callbacks ? (double)report.histogram[i] / report.callbacks : 0.0);
+        text += QString("%1  %2  %3\n")
+                .arg(range, 9)
+                .arg((qulonglong)report.histogram[i], 9)
+                .arg(QString(qRound(40.0 * ratio), QChar('#')));
+    }
+
+    ui->statsText->setPlainText(text);
+}
+
+void REAudioStatsDialog::ResetStats()
+{
+    _engine->Stats().Reset();
+    Refresh();
+}
+
+void REAudioStatsDialog::SaveStats()
+{
+    QString home = QDir::homePath();
+    QString filter = "JSON Files (*.json)";
+    QString path = QFileDialog::getSaveFileName(this, tr("Save Audio Statistics"), home, filter);
+    if(path.isEmpty()) return;
+
+    if(!_engine->Stats().WriteToFile(QFile::encodeName(path).toStdString())) {
+        QMessageBox::warning(this, tr("Save Audio Statistics"), tr("Failed to write %1").arg(path));
+    }
+}
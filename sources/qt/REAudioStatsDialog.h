@@ -0,0 +1,36 @@
+#ifndef REAUDIOSTATSDIALOG_H
+#define REAUDIOSTATSDIALOG_H
+
+#include <QDialog>
+
+class REAudioEngine;
+
+namespace Ui {
+class REAudioStatsDialog;
+}
+
+/** REAudioStatsDialog class.
+ *  Shows the render callback statistics of the audio engine while it plays, refreshed a few times per second.
+ */
+class REAudioStatsDialog : public QDialog
+{
+    Q_OBJECT
+    
+public:
+    explicit REAudioStatsDialog(REAudioEngine* engine, QWidget *parent = 0);
+    ~REAudioStatsDialog();
+
+public slots:
+    void Refresh();
+    void ResetStats();
+    void SaveStats();
+
+protected:
+    void timerEvent(QTimerEvent *);
+
+private:
+    Ui::REAudioStatsDialog *ui;
+    REAudioEngine* _engine;
+};
+
+#endif // REAUDIOSTATSDIALOG_H
@@ -52,3 +52,12 @@ void REBezierPath::Close()
     _qpath.closeSubpath();
 }
 
+RERect REBezierPath::BoundingBox() const
+{
+    return RERect(_qpath.boundingRect());
+}
+
+bool REBezierPath::operator==(const REBezierPath& rhs) const
+{
+    return _qpath == rhs._qpath;
+}
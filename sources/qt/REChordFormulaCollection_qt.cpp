@@ -0,0 +1,50 @@
+#include "REChordFormulaCollection.h"
+#include "REInputStream.h"
+#include "REOutputStream.h"
+#include "REFunctions.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+REChordFormulaCollection* REChordFormulaCollection::_builtinCollection = NULL;
+
+REChordFormulaCollection* REChordFormulaCollection::BuiltinCollection()
+{
+    if(_builtinCollection == NULL)
+    {
+        _builtinCollection = new REChordFormulaCollection;
+
+        QFile xmlFile(":/chords.xml");
+        if(!xmlFile.open(QIODevice::ReadOnly)) {
+            printf("[Reflow] Error: Chord formulas were not found\n");
+            return _builtinCollection;
+        }
+        QByteArray xml = xmlFile.readAll();
+        uint64_t checksum = Reflow::Checksum64(xml.constData(), xml.length());
+
+        // The parsed collection is cached next to the other application caches, and rebuilt
+        // whenever the bundled XML changes
+        QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        QFile cacheFile(QDir(cacheDir).filePath("chords.bin"));
+        if(cacheFile.open(QIODevice::ReadOnly))
+        {
+            QByteArray data = cacheFile.readAll();
+            REConstBufferInputStream decoder(data.constData(), data.length());
+            if(_builtinCollection->ReadCache(decoder, checksum)) {
+                return _builtinCollection;
+            }
+            cacheFile.close();
+        }
+
+        _builtinCollection->Clear();
+        _builtinCollection->LoadChordsXML(xml.constData(), xml.length());
+
+        REBufferOutputStream coder;
+        _builtinCollection->WriteCache(coder, checksum);
+        if(QDir().mkpath(cacheDir) && cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            cacheFile.write(coder.Data(), coder.Size());
+        }
+    }
+    return _builtinCollection;
+}
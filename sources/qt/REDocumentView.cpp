@@ -28,6 +28,7 @@
 #include <REPage.h>
 #include <REPainter.h>
 #include <REBend.h>
+#include <REChordFormulaCollection.h>
 
 #include "REPropertiesDialog.h"
 #include "RERehearsalDialog.h"
@@ -51,6 +52,7 @@
 #include <QMimeData>
 #include <QSettings>
 #include <QPdfWriter>
+#include <QMetaMethod>
 
 using std::bind;
 
@@ -58,11 +60,15 @@ static float _zoomFactors[] = {0.25, 0.50, 0.75, 0.90, 1.00, 1.10, 1.25, 1.50, 1
 
 REDocumentView::REDocumentView(QWidget *parent) :
     QWidget(parent),
-    _song(NULL), _songController(NULL), _scoreController(NULL), _scoreView(NULL), _scene(NULL), _viewport(NULL), _undoStack(NULL), _viewportUpdateTimer(NULL), _trackingEnabled(false), _zoomIndex(4)
+    _song(NULL), _songController(NULL), _scoreController(NULL), _scoreView(NULL), _scene(NULL), _viewport(NULL), _undoStack(NULL), _viewportUpdateTimer(NULL), _chordAnalysisTimer(NULL), _chordAnalyzer(NULL), _trackingEnabled(false), _zoomIndex(4)
 {
 	_undoStack = new QUndoStack(this);
     _viewportUpdateTimer = new QTimer(this);
     QObject::connect(_viewportUpdateTimer, SIGNAL(timeout()), this, SLOT(UpdateViewport()));
+
+    // Chord suggestions are refreshed by slices while the event loop is idle
+    _chordAnalysisTimer = new QTimer(this);
+    QObject::connect(_chordAnalysisTimer, SIGNAL(timeout()), this, SLOT(AnalyseChords()));
 }
 
 void REDocumentView::Save()
@@ -124,14 +130,8 @@ void REDocumentView::InitializeWithFile(const QString& filename)
 
 void REDocumentView::LoadGP(RESong& song, QString filename)
 {
-    QFile file(filename);
-    file.open(QFile::ReadOnly);
-    QByteArray bytes = file.readAll();
-    file.close();
-    REBufferInputStream decoder(bytes.data(), bytes.size());
-    decoder.SetVersion(REFLOW_IO_VERSION);
     REGuitarProParser parser;
-    parser.Parse(&decoder, &song);
+    parser.ParseFile(QFile::encodeName(filename).toStdString(), &song);
 
     for(unsigned int i=0; i<song.TrackCount(); ++i) {
         song.CreatePart(i);
@@ -142,6 +142,19 @@ bool REDocumentView::LoadFLOW(RESong& song, QString filename)
 {
 	QFile file(filename);
     file.open(QFile::ReadOnly);
+
+    // Chunked files are read from a mapping, and their table is kept for incremental saves
+    QByteArray header = file.peek(16);
+    if(REChunkedArchive::IsChunkedArchive(header.data(), header.size()))
+    {
+        file.close();
+        if(!_archive.Read(QFile::encodeName(filename).toStdString(), song)) {
+            REPrintf("Reflow File Loading Error: %s", _archive.Error().c_str());
+            return false;
+        }
+        return true;
+    }
+
     QByteArray bytes = file.readAll();
     file.close();
     REBufferInputStream decoder(bytes.data(), bytes.size());
@@ -182,22 +195,11 @@ bool REDocumentView::LoadFLOW(RESong& song, QString filename)
 
 bool REDocumentView::WriteFLOW(QString filename)
 {
-    QFile file(filename);
-    if(!file.open(QFile::WriteOnly)) {
+    // Only chunks that changed since the last save are written when saving to the same file
+    if(!_archive.Write(*_song, QFile::encodeName(filename).toStdString())) {
         QMessageBox::critical(this, tr("Reflow Error"), tr("Failed to write file"));
         return false;
     }
-
-    REBufferOutputStream buffer;
-    buffer.SetVersion(REFLOW_IO_VERSION);
-    buffer.SetSubType(REFLOW_IO_REFLOW2);
-
-    buffer.Write("FLOW", 4);
-    buffer.WriteUInt32(REFLOW_IO_VERSION);
-    _song->EncodeTo(buffer);
-
-    file.write(buffer.Data(), buffer.Size());
-    file.close();
     return true;
 }
 
@@ -278,8 +280,7 @@ bool REDocumentView::WriteMIDI(QString filename) const
     RESequencer sequencer;
     sequencer.Build(_song, nullptr);
 
-    sequencer.ExportMidiToFile(filename.toStdString());
-    return true;
+    return sequencer.ExportMidiToFile(QFile::encodeName(filename).toStdString());
 }
 
 void REDocumentView::ExportGP5()
@@ -312,6 +313,7 @@ void REDocumentView::CreateControllers()
     _scoreView = new REScoreSceneView(_scene, 0);
     _scoreView->setStyleSheet( "QGraphicsView { border-style: none; }" );
     _scoreView->setFocusPolicy(Qt::ClickFocus);
+    QObject::connect(_scoreView, SIGNAL(VisibleRectChanged()), this, SLOT(UpdateVisibleViews()));
     QVBoxLayout* layout = new QVBoxLayout;
     layout->setMargin(0);
     layout->addWidget(_scoreView);
@@ -333,12 +335,17 @@ void REDocumentView::CreateControllers()
 
     // Select first score
     _scoreController->SetScoreIndex(0);
+
+    // Suggest chord names if something already consumes them
+    ScheduleChordAnalysis();
 }
 
 void REDocumentView::DestroyControllers()
 {
     StopPlayback();
 
+    _chordAnalysisTimer->stop();
+    delete _chordAnalyzer; _chordAnalyzer = nullptr;
     delete _scoreController; _scoreController = nullptr;
     delete _songController; _songController = nullptr;
 }
@@ -382,6 +389,43 @@ void REDocumentView::StopPlayback()
     UpdateViewport();
     emit PlaybackStopped();
 }
+
+void REDocumentView::ScheduleChordAnalysis()
+{
+    if(_songController == NULL || receivers(SIGNAL(ChordSuggestionsChanged())) == 0) return;
+
+    // The chord formulas are only loaded once something consumes the suggestions
+    if(_chordAnalyzer == NULL) {
+        _chordAnalyzer = new REChordAnalyzer(REChordFormulaCollection::BuiltinCollection());
+    }
+    _chordAnalysisTimer->start(0);
+}
+
+void REDocumentView::connectNotify(const QMetaMethod& signal)
+{
+    QWidget::connectNotify(signal);
+
+    // Bars changed while nobody listened are caught up on the first connection
+    if(signal == QMetaMethod::fromSignal(&REDocumentView::ChordSuggestionsChanged)) {
+        ScheduleChordAnalysis();
+    }
+}
+
+void REDocumentView::AnalyseChords()
+{
+    if(_chordAnalyzer == NULL || receivers(SIGNAL(ChordSuggestionsChanged())) == 0) {
+        _chordAnalysisTimer->stop();
+        return;
+    }
+
+    REIntVector changedBars;
+    if(_chordAnalyzer->Update(_song, 32, &changedBars)) {
+        _chordAnalysisTimer->stop();
+    }
+    if(!changedBars.empty()) {
+        emit ChordSuggestionsChanged();
+    }
+}
 void REDocumentView::TogglePlayback()
 {
 	if(IsPlaybackRunning()) {
@@ -413,6 +457,7 @@ void REDocumentView::SetZoomIndex(int zi)
     _zoomIndex = zi;
     float t = ZoomFactor();
     _scoreView->setTransform(QTransform::fromScale(t,t));
+    UpdateVisibleViews();
 }
 
 float REDocumentView::ZoomFactor() const
@@ -430,6 +475,13 @@ void REDocumentView::UpdateViewport()
     }
 }
 
+void REDocumentView::UpdateVisibleViews()
+{
+    if(_scoreController == NULL || _viewport == NULL) return;
+
+    _viewport->UpdateVisibleViews();
+}
+
 void REDocumentView::PlaySelectedChordOnMonitoringDevice()
 {
     QSettings settings;
@@ -1124,10 +1176,13 @@ void REDocumentView::SongControllerDidModifySong(const RESongController* control
     _trackListModel->endResetModel();
     _partListModel->endResetModel();
     _sectionListModel->endResetModel();
+
+    ScheduleChordAnalysis();
 }
 
 void REDocumentView::SongControllerDidModifyPhrase(const RESongController* controller, const REPhrase* phrase, bool successfully)
 {
+    ScheduleChordAnalysis();
 }
 
 void REDocumentView::SongControllerWantsToBackup(const RESongController* controller, const RESong* song)
@@ -9,6 +9,8 @@
 #include <RESongController.h>
 #include <REScoreController.h>
 #include <RESequencer.h>
+#include <REChunkedArchive.h>
+#include <REChordAnalyzer.h>
 
 class REScoreScene;
 class REScoreSceneView;
@@ -37,6 +39,8 @@ public:
     const RESong* Song() const {return _song;}
     RESong* Song() {return _song;}
 
+    const REChordAnalyzer* ChordAnalyzer() const {return _chordAnalyzer;}
+
     RESequencer* Sequencer() {return _songController->Sequencer();}
 
     bool IsTrackingEnabled() const {return _trackingEnabled;}
@@ -177,6 +181,8 @@ public slots:
 
 protected slots:
     void UpdateViewport();
+    void AnalyseChords();
+    void UpdateVisibleViews();
     void ClickedOnPart(QModelIndex idx);
 
 signals:
@@ -185,6 +191,7 @@ signals:
     void FileStatusChanged();
     void CursorOrSelectionChanged();
     void DataChanged();
+    void ChordSuggestionsChanged();
 
 public:
 	bool IsPlaybackRunning() const;
@@ -222,6 +229,10 @@ protected:
 
     void PlaySelectedChordOnMonitoringDevice();
 
+    /** Chord suggestions are only worked out while something listens to ChordSuggestionsChanged */
+    void ScheduleChordAnalysis();
+    virtual void connectNotify(const QMetaMethod& signal);
+
 protected:
     RESong* _song;
     RESongController* _songController;
@@ -230,8 +241,11 @@ protected:
     REScoreSceneView* _scoreView;
     REQtViewport* _viewport;
     QString _filename;
+    REChunkedArchive _archive;
 	QUndoStack* _undoStack;
     QTimer* _viewportUpdateTimer;
+    QTimer* _chordAnalysisTimer;
+    REChordAnalyzer* _chordAnalyzer;
     REPartListModel* _partListModel;
     RETrackListModel* _trackListModel;
     RESectionListModel* _sectionListModel;
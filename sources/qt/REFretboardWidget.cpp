@@ -21,6 +21,7 @@
 
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 
 #include <QPainter>
 #include <QMouseEvent>
@@ -239,8 +240,8 @@ void REFretboardWidget::paintEvent(QPaintEvent *)
 
     const RETrack* track = staff->Track();
 
-    std::set<REStringFretPair> pitchesInChord;
-    std::set<REStringFretPair> pitchesInBar;
+    RENoteStateTable::FretSet fretsInChord;
+    RENoteStateTable::FretSet fretsInBar;
 
     if(!track->IsTablature())
     {
@@ -290,32 +291,15 @@ void REFretboardWidget::paintEvent(QPaintEvent *)
     {
         RESequencer* sequencer = _documentView->Sequencer();
         int barIndex = sequencer->BarIndexThatsCurrentlyPlaying();
-        int tick = sequencer->TickInBarPlaying();
+        unsigned long tick = sequencer->TickInBarPlaying();
 
-        for(int voiceIndex = 0; voiceIndex < track->VoiceCount(); ++voiceIndex)
+        const RENoteStateTable* noteStates = sequencer->TrackNoteStates(track->Index(), barIndex);
+        if(noteStates)
         {
-            const REVoice* voice = track->Voice(voiceIndex);
-            const REPhrase* phrase = voice->Phrase(barIndex);
-            if(phrase)
-            {
-                const REChord* currentChord = NULL;
-                const REChord* chordAfter = NULL;
-                phrase->ChordsSurroundingTick(tick, &currentChord, &chordAfter);
-
-                for(int chordIndex=0; chordIndex<phrase->ChordCount(); ++chordIndex)
-                {
-                    const REChord* chord = phrase->Chord(chordIndex);
-                    for(int i=0; i<chord->NoteCount(); ++i)
-                    {
-                        const RENote* note = chord->Note(i);
-                        REStringFretPair stringFret(note->String(), note->Fret());
-                        pitchesInBar.insert(stringFret);
-                        if(chord == currentChord) {
-                            pitchesInChord.insert(stringFret);
-                        }
-                    }
-                }
-
+            const RENoteStateTable::State* state = noteStates->StateAtTick(tick);
+            fretsInBar = noteStates->FretsInBar();
+            if(state) {
+                fretsInChord = state->frets;
             }
         }
     }
@@ -337,10 +321,12 @@ void REFretboardWidget::paintEvent(QPaintEvent *)
                 for(int i=0; i<chord->NoteCount(); ++i)
                 {
                     const RENote* note = chord->Note(i);
-                    REStringFretPair stringFret(note->String(), note->Fret());
-                    pitchesInBar.insert(stringFret);
+                    int bit = RENoteStateTable::FretBit(note->String(), note->Fret());
+                    if(bit == -1) continue;
+
+                    fretsInBar.set(bit);
                     if(chord == currentChord) {
-                        pitchesInChord.insert(stringFret);
+                        fretsInChord.set(bit);
                     }
                 }
             }
@@ -353,27 +339,20 @@ void REFretboardWidget::paintEvent(QPaintEvent *)
     qpainter.setPen(notePen);
     qpainter.setBrush(noteBrush);
 
-    // Notes in current Chord
-    std::set<REStringFretPair>::const_iterator pitchesInChordIterator = pitchesInChord.begin();
-    for(; pitchesInChordIterator != pitchesInChord.end(); ++pitchesInChordIterator)
+    // Notes in current Chord, then in current Bar
+    int stringCount = std::min<int>(_stringCount, REFLOW_MAX_STRINGS);
+    for(int string=0; string<stringCount; ++string)
     {
-        REStringFretPair stringFret = *pitchesInChordIterator;
-        float x = xOffsetOfCenterOfFret(stringFret.fret + capo);
-        float y = yOffsetOfString(stringFret.string);
-
-        qpainter.drawEllipse(QRectF(x-2.5, y-2.5, 5.0, 5.0));
-    }
-
-    // Notes in current Bar
-    std::set<REStringFretPair>::const_iterator pitchesInBarIterator = pitchesInBar.begin();
-    for(; pitchesInBarIterator != pitchesInBar.end(); ++pitchesInBarIterator)
-    {
-        REStringFretPair stringFret = *pitchesInBarIterator;
-        float x = xOffsetOfCenterOfFret(stringFret.fret + capo);
-        float y = yOffsetOfString(stringFret.string);
+        float y = yOffsetOfString(string);
+        for(int fret=0; fret<RENoteStateTable::FretCount; ++fret)
+        {
+            int bit = RENoteStateTable::FretBit(string, fret);
+            if(!fretsInBar.test(bit)) continue;
 
-        qpainter.setBrush(QBrush());
-        qpainter.drawEllipse(QRectF(x-2.5, y-2.5, 5.0, 5.0));
+            float x = xOffsetOfCenterOfFret(fret + capo);
+            qpainter.setBrush(fretsInChord.test(bit) ? noteBrush : QBrush());
+            qpainter.drawEllipse(QRectF(x-2.5, y-2.5, 5.0, 5.0));
+        }
     }
 
 }
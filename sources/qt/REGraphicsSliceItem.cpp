@@ -17,6 +17,13 @@ QRectF REGraphicsSliceItem::boundingRect() const
     return QRectF(0, 0, _slice->Width(), system->Height());
 }
 
+void REGraphicsSliceItem::SetSlice(const RESlice* slice)
+{
+    prepareGeometryChange();
+    _slice = slice;
+    update();
+}
+
 void REGraphicsSliceItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option,
            QWidget *widget)
  {
@@ -16,6 +16,9 @@ public:
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                 QWidget *widget);
 
+    const RESlice* Slice() const {return _slice;}
+    void SetSlice(const RESlice* slice);
+
 protected:
     const RESlice* _slice;
 };
@@ -5,13 +5,21 @@
 
 #include <RESystem.h>
 #include <REPainter.h>
+#include <RERecordingPainter.h>
+#include <REDisplayList.h>
 #include <REScoreController.h>
 
 REGraphicsSystemItem::REGraphicsSystemItem(const REScoreController* scoreController, const RESystem* system, QGraphicsItem* parentItem)
-    : QGraphicsItem(parentItem), _scoreController(scoreController), _system(system)
+    : QGraphicsItem(parentItem), _scoreController(scoreController), _system(system),
+      _displayList(new REDisplayList), _displayListValid(false), _displayListVoiceIndex(0), _displayListGrayOut(false)
 {
 }
 
+REGraphicsSystemItem::~REGraphicsSystemItem()
+{
+    delete _displayList;
+}
+
 QRectF REGraphicsSystemItem::boundingRect() const
  {
     return QRectF(0, 0, _system->Width(), _system->Height());
@@ -21,6 +29,17 @@ QRectF REGraphicsSystemItem::boundingRect() const
             QWidget *widget)
  {
      QSettings settings;
+     bool grayOut = settings.value("edit/grayOutInactiveVoice", QVariant(false)).toBool();
+     int activeVoiceIndex = (_scoreController ? (_scoreController->IsEditingLowVoice() ? 1 : 0) : 0);
+
+     if(!_displayListValid || activeVoiceIndex != _displayListVoiceIndex || grayOut != _displayListGrayOut)
+     {
+         _displayList->Clear();
+         RecordDisplayList(_displayList, activeVoiceIndex, grayOut);
+         _displayListValid = true;
+         _displayListVoiceIndex = activeVoiceIndex;
+         _displayListGrayOut = grayOut;
+     }
 
      REPainter painter(p);
      p->setRenderHint(QPainter::Antialiasing, true);
@@ -28,10 +47,46 @@ QRectF REGraphicsSystemItem::boundingRect() const
 
      painter.SetDrawingToScreen(true);
      painter.SetForcedToBlack(false);
-     painter.SetGrayOutInactiveVoice(settings.value("edit/grayOutInactiveVoice", QVariant(false)).toBool());
-     painter.SetActiveVoiceIndex(_scoreController ? (_scoreController->IsEditingLowVoice() ? 1 : 0) : 0);
-     painter.SetFillColor(REColor(0, 0, 0));
-     painter.SetStrokeColor(REColor(0, 0, 0));
+     painter.SetGrayOutInactiveVoice(grayOut);
+     painter.SetActiveVoiceIndex(activeVoiceIndex);
 
-     _system->Draw(painter);
+     _displayList->Replay(painter);
  }
+
+void REGraphicsSystemItem::RecordDisplayList(REDisplayList* displayList, int activeVoiceIndex, bool grayOutInactiveVoice) const
+{
+    RERecordingPainter painter(displayList);
+    painter.SetDrawingToScreen(true);
+    painter.SetForcedToBlack(false);
+    painter.SetGrayOutInactiveVoice(grayOutInactiveVoice);
+    painter.SetActiveVoiceIndex(activeVoiceIndex);
+    painter.SetFillColor(REColor(0, 0, 0));
+    painter.SetStrokeColor(REColor(0, 0, 0));
+
+    _system->Draw(painter);
+}
+
+void REGraphicsSystemItem::InvalidateContents()
+{
+    if(!_displayListValid) {
+        update();
+        return;
+    }
+
+    // Record again and only repaint the area where the new drawing differs from the cached one
+    REDisplayList* displayList = new REDisplayList;
+    RecordDisplayList(displayList, _displayListVoiceIndex, _displayListGrayOut);
+    RERect dirtyRect = _displayList->DifferenceRect(*displayList);
+    delete _displayList;
+    _displayList = displayList;
+
+    if(dirtyRect.Width() > 0.0 || dirtyRect.Height() > 0.0) {
+        update(dirtyRect.ToQRectF().adjusted(-1.0, -1.0, 1.0, 1.0));
+    }
+}
+
+void REGraphicsSystemItem::InvalidateAll()
+{
+    _displayListValid = false;
+    update();
+}
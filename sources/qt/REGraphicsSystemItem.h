@@ -9,16 +9,28 @@ class REGraphicsSystemItem : public QGraphicsItem
 {
 public:
     REGraphicsSystemItem(const REScoreController* scoreController, const RESystem* system, QGraphicsItem* parentItem=0);
-    virtual ~REGraphicsSystemItem(){}
+    virtual ~REGraphicsSystemItem();
 
 public:
     QRectF boundingRect() const;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                 QWidget *widget);
 
+    void InvalidateContents();
+    void InvalidateAll();
+
+protected:
+    void RecordDisplayList(REDisplayList* displayList, int activeVoiceIndex, bool grayOutInactiveVoice) const;
+
 protected:
     const RESystem* _system;
     const REScoreController* _scoreController;
+
+    // Draw commands of the system, replayed on expose and re-recorded when the system asks for display
+    REDisplayList* _displayList;
+    bool _displayListValid;
+    int _displayListVoiceIndex;
+    bool _displayListGrayOut;
 };
 
 #endif // REGRAPHICSSYSTEMITEM_H
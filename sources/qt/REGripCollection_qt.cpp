@@ -0,0 +1,49 @@
+#include "REGripCollection.h"
+#include "REInputStream.h"
+#include "REOutputStream.h"
+#include "REFunctions.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+REGripCollection* REGripCollection::_builtinCollection = NULL;
+
+REGripCollection* REGripCollection::BuiltinCollection()
+{
+    if(_builtinCollection == NULL)
+    {
+        _builtinCollection = new REGripCollection;
+
+        QFile xmlFile(":/grips.xml");
+        if(!xmlFile.open(QIODevice::ReadOnly)) {
+            printf("[Reflow] Error: Chord grips were not found\n");
+            return _builtinCollection;
+        }
+        QByteArray xml = xmlFile.readAll();
+        uint64_t checksum = Reflow::Checksum64(xml.constData(), xml.length());
+
+        // Same binary cache as the chord formulas
+        QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        QFile cacheFile(QDir(cacheDir).filePath("grips.bin"));
+        if(cacheFile.open(QIODevice::ReadOnly))
+        {
+            QByteArray data = cacheFile.readAll();
+            REConstBufferInputStream decoder(data.constData(), data.length());
+            if(_builtinCollection->ReadCache(decoder, checksum)) {
+                return _builtinCollection;
+            }
+            cacheFile.close();
+        }
+
+        _builtinCollection->Clear();
+        _builtinCollection->LoadGripsXML(xml.constData(), xml.length());
+
+        REBufferOutputStream coder;
+        _builtinCollection->WriteCache(coder, checksum);
+        if(QDir().mkpath(cacheDir) && cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            cacheFile.write(coder.Data(), coder.Size());
+        }
+    }
+    return _builtinCollection;
+}
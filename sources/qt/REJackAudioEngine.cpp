@@ -2,6 +2,8 @@
 #include "REMusicRack.h"
 #include "REMusicDevice.h"
 
+#include <chrono>
+
 REJackAudioEngine* REJackAudioEngine::Instance()
 {
     if(!_instance) {
@@ -32,11 +34,13 @@ void REJackAudioEngine::Initialize(const REAudioSettings& settings)
     }
 
     jack_set_process_callback(_jack, &REJackAudioEngine::_JackProcessCallback, this);
+    jack_set_xrun_callback(_jack, &REJackAudioEngine::_JackXrunCallback, this);
 
     _outputPorts[0] = jack_port_register (_jack, "out.L", JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
     _outputPorts[1] = jack_port_register (_jack, "out.R", JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
 
     _sampleRate = jack_get_sample_rate (_jack);
+    _maxBufferSize = jack_get_buffer_size (_jack);
 }
 
 void REJackAudioEngine::Shutdown()
@@ -58,6 +62,9 @@ void REJackAudioEngine::StopRendering()
 
 int REJackAudioEngine::Process(jack_nframes_t nframes)
 {
+    std::chrono::steady_clock::time_point callbackStart = std::chrono::steady_clock::now();
+    REAudioEngineStats::Counters counters;
+
     float *workBufferL = (float*) jack_port_get_buffer (_outputPorts[0], nframes);
     float *workBufferR = (float*) jack_port_get_buffer (_outputPorts[1], nframes);
 
@@ -69,6 +76,9 @@ int REJackAudioEngine::Process(jack_nframes_t nframes)
     {
         REAudioEngine::MutexLocker lock_the_racks(_mtx);
 
+        std::chrono::duration<double> lockWait = std::chrono::steady_clock::now() - callbackStart;
+        counters.lockWait = lockWait.count();
+
         // Give Instant Midi packets to monitoring device
         while (_instantMidiPacketBuffer.PacketAvailable()) {
             REMidiInstantPacket packet = _instantMidiPacketBuffer.Pop();
@@ -89,9 +99,14 @@ int REJackAudioEngine::Process(jack_nframes_t nframes)
                 rack->Render(nframes, workBufferL, workBufferR);
             }
         }
+
+        _CollectRackCounters(&counters);
     }
     // ~CRITICAL
 
+    std::chrono::duration<double> callbackTime = std::chrono::steady_clock::now() - callbackStart;
+    _stats.RecordCallback(nframes, _sampleRate, callbackTime.count(), counters);
+
     return 0;
 }
 
@@ -100,3 +115,9 @@ int REJackAudioEngine::_JackProcessCallback (jack_nframes_t nframes, void *arg)
     return static_cast<REJackAudioEngine*>(arg)->Process(nframes);
 }
 
+int REJackAudioEngine::_JackXrunCallback (void *arg)
+{
+    static_cast<REJackAudioEngine*>(arg)->_stats.RecordXrun();
+    return 0;
+}
+
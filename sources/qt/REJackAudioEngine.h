@@ -36,6 +36,7 @@ private:
 
 public:
     static int _JackProcessCallback (jack_nframes_t nframes, void *arg);
+    static int _JackXrunCallback (void *arg);
 };
 
 #endif // REJACKAUDIOENGINE_H
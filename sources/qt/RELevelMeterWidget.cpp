@@ -0,0 +1,87 @@
+#include "RELevelMeterWidget.h"
+
+#include <QPainter>
+
+#include <cmath>
+
+namespace {
+
+// Levels below this are drawn empty
+const float MeterFloorDecibels = -60.0f;
+const int ClipIndicatorWidth = 4;
+
+float Decibels(float level)
+{
+    return (level > 0.0f ? 20.0f * std::log10(level) : -1000.0f);
+}
+
+}
+
+RELevelMeterWidget::RELevelMeterWidget(QWidget *parent) :
+    QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void RELevelMeterWidget::SetLevels(const REAudioMeter::Levels& levels)
+{
+    if(levels.peakL == _levels.peakL && levels.peakR == _levels.peakR &&
+       levels.rmsL == _levels.rmsL && levels.rmsR == _levels.rmsR &&
+       levels.load == _levels.load && levels.clipped == _levels.clipped) {
+        return;
+    }
+    _levels = levels;
+
+    float peak = std::max(levels.peakL, levels.peakR);
+    float rms = std::max(levels.rmsL, levels.rmsR);
+    setToolTip(QString("Peak %1 dB, RMS %2 dB, CPU %3%")
+               .arg(std::max(MeterFloorDecibels, Decibels(peak)), 0, 'f', 1)
+               .arg(std::max(MeterFloorDecibels, Decibels(rms)), 0, 'f', 1)
+               .arg(100.0f * levels.load, 0, 'f', 1));
+    update();
+}
+
+float RELevelMeterWidget::XOfLevel(float level, float width) const
+{
+    float db = Decibels(level);
+    if(db <= MeterFloorDecibels) return 0.0f;
+    if(db >= 0.0f) return width;
+    return width * (1.0f - db / MeterFloorDecibels);
+}
+
+void RELevelMeterWidget::paintEvent(QPaintEvent *)
+{
+    QPainter p(this);
+
+    QRect rc = rect();
+    p.fillRect(rc, QColor::fromRgb(40, 40, 40));
+
+    float width = rc.width() - ClipIndicatorWidth - 1;
+    int channelHeight = rc.height() / 2;
+    const float peaks[2] = {_levels.peakL, _levels.peakR};
+    const float rms[2] = {_levels.rmsL, _levels.rmsR};
+
+    for(int channel=0; channel<2; ++channel)
+    {
+        int y = channel * channelHeight;
+
+        float rmsX = XOfLevel(rms[channel], width);
+        p.fillRect(QRectF(0, y, rmsX, channelHeight - 1), QColor::fromRgb(80, 190, 80));
+
+        float peakX = XOfLevel(peaks[channel], width);
+        if(peakX > 0.0f) {
+            QColor peakColor = (peaks[channel] >= 1.0f ? QColor::fromRgb(230, 60, 50) : QColor::fromRgb(220, 220, 120));
+            p.fillRect(QRectF(std::max(0.0f, peakX - 1.0f), y, 1.0f, channelHeight - 1), peakColor);
+        }
+    }
+
+    QColor clipColor = (_levels.clipped ? QColor::fromRgb(230, 60, 50) : QColor::fromRgb(70, 70, 70));
+    p.fillRect(QRect(rc.width() - ClipIndicatorWidth, 0, ClipIndicatorWidth, rc.height()), clipColor);
+}
+
+void RELevelMeterWidget::mousePressEvent(QMouseEvent *)
+{
+    if(_levels.clipped) {
+        emit ClipResetRequested();
+    }
+}
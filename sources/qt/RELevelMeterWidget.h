@@ -0,0 +1,35 @@
+#ifndef RELEVELMETERWIDGET_H
+#define RELEVELMETERWIDGET_H
+
+#include "RETypes.h"
+#include "REAudioMeter.h"
+
+#include <QWidget>
+
+/** RELevelMeterWidget class.
+ *  Horizontal stereo meter: RMS as a bar, peak as a tick, and a clip indicator at the right end that stays lit
+ *  until clicked.
+ */
+class RELevelMeterWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit RELevelMeterWidget(QWidget *parent = 0);
+
+    void SetLevels(const REAudioMeter::Levels& levels);
+
+signals:
+    void ClipResetRequested();
+
+protected:
+    void paintEvent(QPaintEvent *);
+    void mousePressEvent(QMouseEvent *);
+
+private:
+    float XOfLevel(float level, float width) const;
+
+private:
+    REAudioMeter::Levels _levels;
+};
+
+#endif // RELEVELMETERWIDGET_H
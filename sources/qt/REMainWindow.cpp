@@ -11,9 +11,11 @@
 #include "REPianoWidget.h"
 #include "REFretboardWidget.h"
 #include "REPreferencesDialog.h"
+#include "REAudioStatsDialog.h"
 
 #include <RESong.h>
 #include <RESongController.h>
+#include <REAudioEngine.h>
 
 #include <QGraphicsTextItem>
 #include <QFileDialog>
@@ -189,6 +191,46 @@ void REMainWindow::on_actionPreferences_triggered()
     dlg.exec();
 }
 
+void REMainWindow::on_actionAudioStatistics_triggered()
+{
+    REAudioStatsDialog dlg(REAudioEngine::Instance(), this);
+    dlg.exec();
+}
+
+void REMainWindow::on_actionFindOccurrences_triggered()
+{
+    if(_currentDocument == NULL) return;
+
+    unsigned long flags = 0;
+    if(ui->actionMatchRhythm->isChecked()) flags |= REPatternIndex::MatchRhythm;
+    if(ui->actionMatchFingering->isChecked()) flags |= REPatternIndex::MatchShape;
+
+    ShowOccurrenceStatus(_currentDocument->ScoreController()->FindOccurrencesOfSelection(flags));
+}
+
+void REMainWindow::on_actionFindNext_triggered()
+{
+    if(_currentDocument == NULL) return;
+    ShowOccurrenceStatus(_currentDocument->ScoreController()->SelectNextOccurrence(false));
+}
+
+void REMainWindow::on_actionFindPrevious_triggered()
+{
+    if(_currentDocument == NULL) return;
+    ShowOccurrenceStatus(_currentDocument->ScoreController()->SelectNextOccurrence(true));
+}
+
+void REMainWindow::ShowOccurrenceStatus(bool found)
+{
+    int count = _currentDocument->ScoreController()->OccurrenceCount();
+    if(found) {
+        ui->statusBar->showMessage(tr("%1 occurrence(s)").arg(count), 3000);
+    }
+    else {
+        ui->statusBar->showMessage(tr("No occurrence found"), 3000);
+    }
+}
+
 void REMainWindow::ActionNew()
 {
     QTabWidget* tab = qobject_cast<QTabWidget*>(centralWidget());
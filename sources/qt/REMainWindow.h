@@ -51,12 +51,17 @@ protected slots:
     void CheckUpdateFinished(QNetworkReply*);
 
     void on_actionPreferences_triggered();
+    void on_actionAudioStatistics_triggered();
+    void on_actionFindOccurrences_triggered();
+    void on_actionFindNext_triggered();
+    void on_actionFindPrevious_triggered();
 
 protected:
     void ConnectToDocument();
     void DisconnectFromDocument();
 
     void UpdateWindowTitleFromCurrentDocument();
+    void ShowOccurrenceStatus(bool found);
 
 protected:
     virtual void closeEvent(QCloseEvent *);
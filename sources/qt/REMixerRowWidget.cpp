@@ -8,10 +8,16 @@
 #include "RESong.h"
 #include "REScore.h"
 #include "RESequencer.h"
+#include "RELevelMeterWidget.h"
+#include "RESoundFontManager.h"
 
 #include "ui_REMixerRowWidget.h"
 
 #include <QMouseEvent>
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QFileInfo>
+#include <QDir>
 
 REMixerRowWidget::REMixerRowWidget(REMixerWidget* parent, int trackIndex)
     : QWidget(parent),
@@ -20,6 +26,11 @@ REMixerRowWidget::REMixerRowWidget(REMixerWidget* parent, int trackIndex)
 {
     ui->setupUi(this);
 
+    // Under the track name
+    _levelMeter = new RELevelMeterWidget(this);
+    _levelMeter->setGeometry(30, 24, 100, 4);
+    connect(_levelMeter, SIGNAL(ClipResetRequested()), this, SLOT(ResetClip()));
+
     REDocumentView* doc = DocumentView();
     const REScore* score = doc->ScoreController()->Score();
     const RESong* song = doc->Song();
@@ -87,6 +98,26 @@ REDocumentView* REMixerRowWidget::DocumentView()
     return mix->DocumentView();
 }
 
+void REMixerRowWidget::UpdateLevels()
+{
+    RESequencer* sequencer = DocumentView()->Sequencer();
+
+    REAudioMeter::Levels levels;
+    if(sequencer == nullptr || !sequencer->TrackLevels(_trackIndex, &levels)) {
+        levels = REAudioMeter::Levels();
+    }
+    _levelMeter->SetLevels(levels);
+}
+
+void REMixerRowWidget::ResetClip()
+{
+    RESequencer* sequencer = DocumentView()->Sequencer();
+    if(sequencer) {
+        sequencer->ResetTrackClip(_trackIndex);
+    }
+    UpdateLevels();
+}
+
 void REMixerRowWidget::on_viewButton_toggled(bool present)
 {
     REDocumentView* doc = DocumentView();
@@ -180,3 +211,45 @@ void REMixerRowWidget::mouseDoubleClickEvent(QMouseEvent *)
 {
     DocumentView()->ShowTracksAndPartsDialogSelectingTrack(_trackIndex);
 }
+
+void REMixerRowWidget::contextMenuEvent(QContextMenuEvent* event)
+{
+    RESequencer* sequencer = DocumentView()->Sequencer();
+    if(sequencer == nullptr) return;
+
+    std::string currentPath = sequencer->TrackSoundFontPath(_trackIndex);
+
+    QMenu menu(this);
+    QAction* defaultAction = menu.addAction(tr("Default SoundFont"));
+    defaultAction->setCheckable(true);
+    defaultAction->setChecked(currentPath.empty());
+    menu.addSeparator();
+
+    // SoundFonts next to the default one. A file is only loaded once a track picks it,
+    // and files still loading can be picked: the track plays the default bank until they are ready
+    const RESoundFontManager& manager = RESoundFontManager::Instance();
+    QDir soundFontDir = QFileInfo(QString::fromStdString(manager.DefaultSoundFontPath())).dir();
+    for(const QString& fileName : soundFontDir.entryList(QStringList() << "*.sf2", QDir::Files, QDir::Name))
+    {
+        // Same form as the default path, so that picking the default file reuses its bank
+        QString filePath = soundFontDir.filePath(fileName);
+        std::string path = filePath.toStdString();
+        const RESoundFontManager::Entry* entry = manager.FindSoundFontEntry(path);
+
+        QString name = fileName;
+        if(entry && entry->LoadState() == RESoundFontManager::Entry::Loading) {
+            name = tr("%1 (loading)").arg(name);
+        }
+
+        QAction* action = menu.addAction(name);
+        action->setData(filePath);
+        action->setCheckable(true);
+        action->setChecked(path == currentPath);
+        action->setEnabled(entry == NULL || entry->LoadState() != RESoundFontManager::Entry::Failed);
+    }
+
+    QAction* chosen = menu.exec(event->globalPos());
+    if(chosen == nullptr) return;
+
+    sequencer->SetTrackSoundFont(_trackIndex, chosen == defaultAction ? std::string() : chosen->data().toString().toStdString());
+}
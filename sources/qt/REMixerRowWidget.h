@@ -5,6 +5,7 @@
 
 class REMixerWidget;
 class REDocumentView;
+class RELevelMeterWidget;
 
 namespace Ui {
 class REMixerRowWidget;
@@ -19,6 +20,7 @@ public:
     ~REMixerRowWidget();
 
     REDocumentView* DocumentView();
+    void UpdateLevels();
 
 protected slots:
     void on_viewButton_toggled(bool);
@@ -26,12 +28,15 @@ protected slots:
     void on_muteButton_toggled(bool);
     void on_volumeSlider_valueChanged(int);
     void on_panSlider_valueChanged(int);
+    void ResetClip();
     
 protected:
     void mouseDoubleClickEvent(QMouseEvent *);
+    void contextMenuEvent(QContextMenuEvent *);
 
 private:
     Ui::REMixerRowWidget *ui;
+    RELevelMeterWidget* _levelMeter;
     int _trackIndex;
 };
 
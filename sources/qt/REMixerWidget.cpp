@@ -14,6 +14,8 @@
 REMixerWidget::REMixerWidget(QWidget *parent) :
     QWidget(parent), _documentView(nullptr), _rowHeight(30.0)
 {
+    // Level meters are polled at display rate, the audio thread never waits on them
+    startTimer(33);
 }
 
 void REMixerWidget::SetDocumentView(REDocumentView *doc)
@@ -46,3 +48,14 @@ void REMixerWidget::Refresh()
         row->move(0, rowY);
     }
 }
+
+void REMixerWidget::timerEvent(QTimerEvent *)
+{
+    if(_documentView == nullptr || !isVisible()) return;
+
+    for(QObject* child : children())
+    {
+        REMixerRowWidget* row = qobject_cast<REMixerRowWidget*>(child);
+        if(row) row->UpdateLevels();
+    }
+}
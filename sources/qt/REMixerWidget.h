@@ -19,6 +19,9 @@ public:
 
     inline REDocumentView* DocumentView() {return _documentView;}
 
+protected:
+    void timerEvent(QTimerEvent *);
+
 private:
     REDocumentView* _documentView;
     float _rowHeight;
@@ -7,10 +7,6 @@
 #include "RESong.h"
 #include "RETrack.h"
 #include "REBar.h"
-#include "REVoice.h"
-#include "REPhrase.h"
-#include "REChord.h"
-#include "RENote.h"
 #include "RESystem.h"
 #include "REStaff.h"
 
@@ -18,6 +14,8 @@
 #include <QGraphicsSceneMouseEvent>
 
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 
 RENavigatorScene::RENavigatorScene(QObject *parent) :
     QGraphicsScene(parent), _documentView(nullptr), _headerHeight(32.0), _rowHeight(30.0)
@@ -26,6 +24,9 @@ RENavigatorScene::RENavigatorScene(QObject *parent) :
 
 void RENavigatorScene::SetDocumentView(REDocumentView* doc)
 {
+    if(doc != _documentView) {
+        _ClearStrips();
+    }
     _documentView = doc;
 
     Refresh();
@@ -43,14 +44,11 @@ void RENavigatorScene::drawBackground(QPainter * painter, const QRectF & rect)
     const REScore* score = (scoreController ? scoreController->Score() : nullptr);
     const RESong* song = (score ? score->Song() : nullptr);
 
-    int firstTrackIndex = 0;
-    int lastTrackIndex = song->TrackCount()-1;
-
+    int firstTrackIndex = std::max(0, TrackIndexAtY(rect.top()));
+    int lastTrackIndex = std::min((int)song->TrackCount()-1, TrackIndexAtY(rect.bottom()));
 
     for(int trackIndex=firstTrackIndex; trackIndex<=lastTrackIndex; ++trackIndex)
     {
-        const RETrack* track = song->Track(trackIndex);
-        bool presentInScore = (score->ContainsTrack(track));
         float rowY = trackIndex * _rowHeight;
 
         QLinearGradient linearGrad(QPointF(0, rowY), QPointF(0, rowY+_rowHeight));
@@ -214,109 +212,232 @@ void RENavigatorScene::TapAtPoint(const REPoint& pt, bool extending)
 
 void RENavigatorScene::Refresh()
 {
-    clear();
-
-    if(_documentView == nullptr) return;
+    if(_documentView == nullptr) {
+        _ClearStrips();
+        return;
+    }
 
-    REScoreController* scoreController = _documentView->ScoreController();
-    const REScore* score = (scoreController ? scoreController->Score() : nullptr);
-    const RESong* song = (score ? score->Song() : nullptr);
+    const RESong* song = _documentView->Song();
     int nbBars = song->BarCount();
+    int nbTracks = song->TrackCount();
+    if(nbBars == 0) {
+        _ClearStrips();
+        return;
+    }
 
-    int firstBarIndex = 0;
-    int lastBarIndex = song->BarCount()-1;
+    // Strips are laid out on bar positions: any change there (bar count, time signatures) invalidates all of them
+    std::vector<float> barX(nbBars + 1);
+    for(int barIndex=0; barIndex < nbBars; ++barIndex) {
+        barX[barIndex] = XOfTick(song->Bar(barIndex)->OffsetInTicks());
+    }
+    barX[nbBars] = TotalWidth();
 
-    int firstTrackIndex = 0;
-    int lastTrackIndex = song->TrackCount()-1;
+    if(barX != _barX || nbTracks != (int)_strips.size())
+    {
+        _ClearStrips();
+        _barX = barX;
+        _strips.resize(nbTracks);
+    }
 
-    for(int trackIndex=firstTrackIndex; trackIndex<=lastTrackIndex; ++trackIndex)
+    for(int trackIndex=0; trackIndex < nbTracks; ++trackIndex) {
+        _RefreshTrackStrip(trackIndex);
+    }
+}
+
+void RENavigatorScene::DrawStripOfTrack(int trackIndex, const QRectF& sceneRect, float offsetX, QPainter* painter) const
+{
+    if(trackIndex < 0 || trackIndex >= (int)_strips.size()) return;
+
+    const TrackStrip& strip = _strips[trackIndex];
+    if(strip.tiles.empty()) return;
+
+    // First tile crossing the rect, then every following one until past its right edge
+    int nbBars = (int)_barX.size() - 1;
+    int firstBarIndex = (int)(std::upper_bound(_barX.begin(), _barX.end(), (float)sceneRect.left()) - _barX.begin()) - 1;
+    int tileIndex = std::max(0, firstBarIndex) / TileBarCount;
+
+    for(; tileIndex < (int)strip.tiles.size(); ++tileIndex)
     {
-        const RETrack* track = song->Track(trackIndex);
+        float x0 = _barX[tileIndex * TileBarCount];
+        float x1 = _barX[std::min(nbBars, (tileIndex + 1) * TileBarCount)];
+        if(x0 >= sceneRect.right()) break;
+
+        QRectF source = sceneRect.intersected(QRectF(x0, sceneRect.top(), x1 - x0, sceneRect.height()));
+        if(source.isEmpty()) continue;
+
+        painter->drawPixmap(source.translated(offsetX, 0.0), strip.tiles[tileIndex], source.translated(-x0, 0.0));
+    }
+}
+
+void RENavigatorScene::_ClearStrips()
+{
+    clear();
+    _strips.clear();
+    _barX.clear();
+}
 
-        // Retrieve Min and Max Pitch
-        int minPitch = 127;
-        int maxPitch = 0;
-        for(unsigned int voiceIndex=0; voiceIndex < track->VoiceCount(); ++voiceIndex)
+void RENavigatorScene::_RefreshTrackStrip(int trackIndex)
+{
+    const RESong* song = _documentView->Song();
+    const RETrack* track = song->Track(trackIndex);
+    TrackStrip& strip = _strips[trackIndex];
+    int nbBars = (int)_barX.size() - 1;
+
+    // Gather bar summaries, already computed by each phrase on refresh
+    std::vector<REPitchSummary> bars(nbBars);
+    std::vector<bool> occupied(nbBars);
+    int minPitch = 127;
+    int maxPitch = 0;
+    int maxNoteCount = 0;
+    for(int barIndex=0; barIndex < nbBars; ++barIndex)
+    {
+        const REPitchSummary& summary = (bars[barIndex] = track->PitchSummaryOfBar(barIndex));
+        occupied[barIndex] = !track->IsBarEmptyOrRest(barIndex);
+        if(!summary.IsEmpty())
         {
-            const REVoice* voice = track->Voice(voiceIndex);
-            for(int barIndex=0; barIndex < nbBars; ++barIndex)
-            {
-                const REPhrase* phrase = voice->Phrase(barIndex);
-                unsigned int nbChords = phrase->ChordCount();
-                for(unsigned int chordIndex = 0; chordIndex < nbChords; ++chordIndex)
-                {
-                    const REChord* chord = phrase->Chord(chordIndex);
-                    unsigned int nbNotes = chord->NoteCount();
-                    for(unsigned int noteIndex = 0; noteIndex < nbNotes; ++noteIndex)
-                    {
-                        const RENote* note = chord->Note(noteIndex);
-                        const RENotePitch& pitch = note->Pitch();
-                        if(pitch.midi > maxPitch) maxPitch = pitch.midi;
-                        if(pitch.midi < minPitch) minPitch = pitch.midi;
-                    }
-                }
-            }
+            if(summary.minPitch < minPitch) minPitch = summary.minPitch;
+            if(summary.maxPitch > maxPitch) maxPitch = summary.maxPitch;
+            if(summary.noteCount > maxNoteCount) maxNoteCount = summary.noteCount;
         }
+    }
 
-        bool presentInScore = (score->ContainsTrack(track));
-        float rowY = trackIndex * _rowHeight;
+    // A change of the track pitch range or peak density rescales every cell
+    bool fullRender = strip.tiles.empty() || strip.bars.size() != bars.size() ||
+            minPitch != strip.minPitch || maxPitch != strip.maxPitch || maxNoteCount != strip.maxNoteCount;
+    bool occupancyChanged = (occupied != strip.occupied);
 
-        bool buildingBar = false;
-        float x0 = 0;
-        float x1 = 0;
-        int rowBarIndex = 0;
-        int rowBarCount = 0;
+    REIntVector dirtyBars;
+    for(int barIndex=0; barIndex < nbBars; ++barIndex)
+    {
+        if(fullRender || bars[barIndex] != strip.bars[barIndex] || occupied[barIndex] != strip.occupied[barIndex]) {
+            dirtyBars.push_back(barIndex);
+        }
+    }
 
-        // Bar Background and Notes
-        for(int barIndex=firstBarIndex; barIndex <= lastBarIndex; ++barIndex)
+    strip.bars.swap(bars);
+    strip.occupied.swap(occupied);
+    strip.minPitch = minPitch;
+    strip.maxPitch = maxPitch;
+    strip.maxNoteCount = maxNoteCount;
+
+    if(strip.tiles.empty())
+    {
+        int nbTiles = (nbBars + TileBarCount - 1) / TileBarCount;
+        for(int tileIndex=0; tileIndex < nbTiles; ++tileIndex)
         {
-            const REBar* bar = song->Bar(barIndex);
-            bool occupied = !track->IsBarEmptyOrRest(barIndex);
-            unsigned long tick = bar->OffsetInTicks();
-            float barX = XOfTick(tick);
-            float barLen = XOfTick(bar->TheoricDurationInTicks());
-
-            if(buildingBar)
-            {
-                if(occupied) {
-                    x1 = barX + barLen;
-                    ++rowBarCount;
-                }
-                else {
-                    RENavigatorRowItem* item = new RENavigatorRowItem(RERange(rowBarIndex, rowBarCount), trackIndex);
-                    item->setPos(QPointF(x0, rowY));
-                    item->SetMinPitch(minPitch);
-                    item->SetMaxPitch(maxPitch);
-                    item->CalculateBounds(this);
-                    addItem(item);
-                    //QGraphicsRectItem* rect  = addRect(QRectF(x0, rowY+1.0, x1-x0, _rowHeight-1.0), QPen(Qt::gray), QBrush(Qt::white));
-                    buildingBar = false;
-                }
-            }
-            else
-            {
-                if(occupied)
-                {
-                    buildingBar = true;
-                    x0 = barX;
-                    x1 = barX + barLen;
-                    rowBarIndex = barIndex;
-                    rowBarCount = 1;
-                }
-            }
+            float x0 = _barX[tileIndex * TileBarCount];
+            float x1 = _barX[std::min(nbBars, (tileIndex + 1) * TileBarCount)];
+            QPixmap tile((int)ceilf(x1 - x0) + 1, (int)ceilf(_rowHeight));
+            tile.fill(Qt::transparent);
+            strip.tiles.push_back(tile);
         }
+    }
 
-        if(buildingBar) {
-            RENavigatorRowItem* item = new RENavigatorRowItem(RERange(rowBarIndex, rowBarCount), trackIndex);
-            item->setPos(QPointF(x0, rowY));
-            item->SetMinPitch(minPitch);
-            item->SetMaxPitch(maxPitch);
-            item->CalculateBounds(this);
-            addItem(item);
+    // Dirty bars are sorted, so each tile is painted in one go
+    QPainter painter;
+    int paintedTileIndex = -1;
+    for(int barIndex : dirtyBars)
+    {
+        int tileIndex = barIndex / TileBarCount;
+        if(tileIndex != paintedTileIndex)
+        {
+            if(painter.isActive()) painter.end();
+            painter.begin(&strip.tiles[tileIndex]);
+            painter.translate(-_barX[tileIndex * TileBarCount], 0.0);
+            paintedTileIndex = tileIndex;
+        }
+        _RenderBarInStrip(trackIndex, barIndex, painter);
+    }
+    if(painter.isActive()) painter.end();
 
-            //QGraphicsRectItem* rect  = addRect(QRectF(x0, rowY+1.0, x1-x0, _rowHeight-1.0), QPen(Qt::gray), QBrush(Qt::white));
-            buildingBar = false;
+    if(occupancyChanged) {
+        _RebuildRowItems(trackIndex);
+    }
+    else if(!dirtyBars.empty()) {
+        for(RENavigatorRowItem* item : strip.items) {
+            item->update();
         }
     }
 }
 
+void RENavigatorScene::_RenderBarInStrip(int trackIndex, int barIndex, QPainter& painter)
+{
+    const RESong* song = _documentView->Song();
+    const REBar* bar = song->Bar(barIndex);
+    const TrackStrip& strip = _strips[trackIndex];
+
+    float h = _rowHeight;
+    float barX = _barX[barIndex];
+    float barLen = XOfTick(bar->TheoricDurationInTicks());
+    QRectF cell(barX, 0, barLen, h);
+
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(cell, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+    if(!strip.occupied[barIndex]) return;
+
+    painter.fillRect(cell, QBrush(QColor::fromRgbF(0.95, 0.95, 0.95)));
+
+    // Pitch band of the bar, shaded by its note count relative to the busiest bar of the track
+    const REPitchSummary& summary = strip.bars[barIndex];
+    if(!summary.IsEmpty())
+    {
+        float y0 = h - 4.0;
+        float y1 = 4.0;
+        float deltaPitch = (strip.maxPitch != strip.minPitch ? 1.0 / (float)(strip.maxPitch - strip.minPitch) : 0.5);
+        float tLow = (float)(summary.minPitch - strip.minPitch) * deltaPitch;
+        float tHigh = (float)(summary.maxPitch - strip.minPitch) * deltaPitch;
+        float yLow = Reflow::Roundf((1.0 - tLow) * y0 + tLow * y1) + 0.5;
+        float yHigh = Reflow::Roundf((1.0 - tHigh) * y0 + tHigh * y1) + 0.5;
+        float density = (float)summary.noteCount / (float)strip.maxNoteCount;
+
+        painter.fillRect(QRectF(barX + 1.0, yHigh, barLen - 2.0, std::max(1.0f, yLow - yHigh)),
+                         QColor::fromRgbF(0.35, 0.35, 0.35, 0.25 + 0.65 * density));
+        painter.setPen(QPen(Qt::gray));
+        painter.drawLine(QPointF(barX + 1.0, yHigh), QPointF(barX + barLen - 1.0, yHigh));
+        painter.drawLine(QPointF(barX + 1.0, yLow), QPointF(barX + barLen - 1.0, yLow));
+    }
+
+    painter.setPen(QPen(Qt::black));
+    QPointF p0 = QPointF(barX, 0);
+    QPointF p1 = QPointF(p0.x() + barLen, p0.y());
+    QPointF p2 = QPointF(p0.x(), p0.y() + h);
+    QPointF p3 = QPointF(p1.x(), p1.y() + h);
+    painter.drawLine(p0, p1);
+    painter.drawLine(p2, p3);
+}
+
+void RENavigatorScene::_RebuildRowItems(int trackIndex)
+{
+    TrackStrip& strip = _strips[trackIndex];
+    for(RENavigatorRowItem* item : strip.items) {
+        removeItem(item);
+        delete item;
+    }
+    strip.items.clear();
+
+    float rowY = trackIndex * _rowHeight;
+    int nbBars = (int)strip.occupied.size();
+
+    // One item per run of occupied bars
+    int barIndex = 0;
+    while(barIndex < nbBars)
+    {
+        if(!strip.occupied[barIndex]) {
+            ++barIndex;
+            continue;
+        }
+
+        int rowBarIndex = barIndex;
+        while(barIndex < nbBars && strip.occupied[barIndex]) {
+            ++barIndex;
+        }
+
+        RENavigatorRowItem* item = new RENavigatorRowItem(RERange(rowBarIndex, barIndex - rowBarIndex), trackIndex);
+        item->setPos(QPointF(_barX[rowBarIndex], rowY));
+        item->CalculateBounds(this);
+        addItem(item);
+        strip.items.push_back(item);
+    }
+}
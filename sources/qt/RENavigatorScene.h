@@ -4,8 +4,10 @@
 #include "RETypes.h"
 
 #include <QGraphicsScene>
+#include <QPixmap>
 
 class REDocumentView;
+class RENavigatorRowItem;
 
 class RENavigatorScene : public QGraphicsScene
 {
@@ -30,15 +32,47 @@ public:
 
     void Refresh();
 
+    /** Draws the part of a track strip within sceneRect, shifted horizontally by offsetX */
+    void DrawStripOfTrack(int trackIndex, const QRectF& sceneRect, float offsetX, QPainter* painter) const;
+
 protected:
     void drawBackground(QPainter * painter, const QRectF & rect);
     void drawForeground(QPainter *painter, const QRectF &rect);
     void mousePressEvent(QGraphicsSceneMouseEvent *event);
 
+private:
+    enum {
+        TileBarCount = 16           // Bars per strip tile, keeps pixmaps well under the QPixmap size limit
+    };
+
+    /** Per-track overview: one pitch summary per bar, rendered once into pixmap tiles of TileBarCount bars
+     *  that row items blit from. Only bars whose summary changed are re-rendered on refresh.
+     */
+    struct TrackStrip
+    {
+        std::vector<REPitchSummary> bars;
+        std::vector<bool> occupied;
+        int minPitch;
+        int maxPitch;
+        int maxNoteCount;
+        std::vector<QPixmap> tiles;
+        std::vector<RENavigatorRowItem*> items;
+
+        TrackStrip() : minPitch(127), maxPitch(0), maxNoteCount(0) {}
+    };
+
+    void _ClearStrips();
+    void _RefreshTrackStrip(int trackIndex);
+    void _RebuildRowItems(int trackIndex);
+    void _RenderBarInStrip(int trackIndex, int barIndex, QPainter& painter);
+
 private:
     REDocumentView* _documentView;
     float _headerHeight;
     float _rowHeight;
+
+    std::vector<TrackStrip> _strips;
+    std::vector<float> _barX;
 };
 
 #endif // RENAVIGATORSCENE_H
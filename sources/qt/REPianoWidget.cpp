@@ -83,41 +83,19 @@ void REPianoWidget::paintEvent(QPaintEvent *)
 
     const RETrack* track = staff->Track();
 
-    REIntSet pitchesInChord;
-    REIntSet pitchesInBar;
+    RENoteStateTable::KeySet keysInChord;
 
     QColor color;
 
     if(sequencer && sequencer->IsRunning())
     {
         int barIndex = sequencer->BarIndexThatsCurrentlyPlaying();
-        int tick = sequencer->TickInBarPlaying();
+        unsigned long tick = sequencer->TickInBarPlaying();
 
-        for(int voiceIndex = 0; voiceIndex < track->VoiceCount(); ++voiceIndex)
-        {
-            const REVoice* voice = track->Voice(voiceIndex);
-            const REPhrase* phrase = voice->Phrase(barIndex);
-            if(phrase)
-            {
-                const REChord* currentChord = NULL;
-                const REChord* chordAfter = NULL;
-                phrase->ChordsSurroundingTick(tick, &currentChord, &chordAfter);
-
-                for(int chordIndex=0; chordIndex<phrase->ChordCount(); ++chordIndex)
-                {
-                    const REChord* chord = phrase->Chord(chordIndex);
-                    for(int i=0; i<chord->NoteCount(); ++i)
-                    {
-                        const RENote* note = chord->Note(i);
-                        int pitch = note->Pitch().midi;
-                        pitchesInBar.insert(pitch);
-                        if(chord == currentChord) {
-                            pitchesInChord.insert(pitch);
-                        }
-                    }
-                }
-
-            }
+        const RENoteStateTable* noteStates = sequencer->TrackNoteStates(track->Index(), barIndex);
+        const RENoteStateTable::State* state = (noteStates ? noteStates->StateAtTick(tick) : NULL);
+        if(state) {
+            keysInChord = state->keys;
         }
 
         color = QColor::fromRgb(217, 102, 39, 200);
@@ -139,9 +117,8 @@ void REPianoWidget::paintEvent(QPaintEvent *)
                 {
                     const RENote* note = chord->Note(i);
                     int pitch = note->Pitch().midi;
-                    pitchesInBar.insert(pitch);
-                    if(chord == currentChord) {
-                        pitchesInChord.insert(pitch);
+                    if(chord == currentChord && pitch >= 0 && pitch < RENoteStateTable::KeyCount) {
+                        keysInChord.set(pitch);
                     }
                 }
             }
@@ -151,10 +128,9 @@ void REPianoWidget::paintEvent(QPaintEvent *)
     }
 
     // Draw pressed keys
-    REIntSet::const_iterator pitchesInChordIterator = pitchesInChord.begin();
-    for(; pitchesInChordIterator != pitchesInChord.end(); ++pitchesInChordIterator)
+    for(int pitch=0; pitch<RENoteStateTable::KeyCount; ++pitch)
     {
-        int pitch = *pitchesInChordIterator;
+        if(!keysInChord.test(pitch)) continue;
 
         int chromatic = pitch % 12;
         bool sharp = isSharped[chromatic];
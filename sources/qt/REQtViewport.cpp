@@ -160,8 +160,9 @@ RESize REQtViewport::ViewportSize() const
 // ------------------------------------------------------------------------------------------------------------------
 RERect REQtViewport::ViewportVisibleRect() const
 {
-    // TODO: Change this to return the actual visible rect instead of the whole scene
-    return RERect(ScoreScene()->sceneRect());
+    const REScoreSceneView* view = ScoreSceneView();
+    QRectF rc = view->mapToScene(view->viewport()->rect()).boundingRect();
+    return RERect(rc.intersected(ScoreScene()->sceneRect()));
 }
 
 // ------------------------------------------------------------------------------------------------------------------
@@ -335,12 +336,12 @@ void REQtViewportSystemItem::AttachToViewport(bool vis)
 
 void REQtViewportSystemItem::SetNeedsDisplay()
 {
-    if(_systemItem) _systemItem->update();
+    if(_systemItem) _systemItem->InvalidateContents();
 }
 
 void REQtViewportSystemItem::UpdateFrame()
 {
-    if(_systemItem) _systemItem->update();
+    if(_systemItem) _systemItem->InvalidateAll();
 }
 
 
@@ -375,6 +376,16 @@ void REQtViewportSliceItem::UpdateFrame()
     if(_sliceItem) _sliceItem->update();
 }
 
+void REQtViewportSliceItem::SetSlice(const RESlice* slice)
+{
+    REViewportSliceItem::SetSlice(slice);
+
+    if(_sliceItem) {
+        _sliceItem->SetSlice(slice);
+        _sliceItem->setPos(slice->Frame().origin.ToQPointF());
+    }
+}
+
 // ------------------------------------------------------------------------------------------------------------------
 //  REQtViewportFrameItem
 // ------------------------------------------------------------------------------------------------------------------
@@ -136,6 +136,7 @@ public:
     virtual void AttachToViewport(bool vis);
     virtual void SetNeedsDisplay();
     virtual void UpdateFrame();
+    virtual void SetSlice(const RESlice* slice);
     
 protected:
     REGraphicsSliceItem* _sliceItem;
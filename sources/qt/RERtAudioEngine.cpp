@@ -8,6 +8,7 @@
 #include "RESF2Generator.h"
 
 #include <thread>
+#include <chrono>
 
 RERtAudioEngine* RERtAudioEngine::Instance()
 {
@@ -95,11 +96,22 @@ void RERtAudioEngine::StopRendering()
 int RERtAudioEngine::RenderCallback( void *outputBuffer, void *inputBuffer, unsigned int nBufferFrames,
                     double streamTime, RtAudioStreamStatus status, void *userData )
 {
+    std::chrono::steady_clock::time_point callbackStart = std::chrono::steady_clock::now();
+    REAudioEngineStats::Counters counters;
+
+    // The previous buffer was not delivered in time
+    if(status & RTAUDIO_OUTPUT_UNDERFLOW) {
+        _stats.RecordXrun();
+    }
+
     // CRITICAL: Process Racks
     //           - This vector can be concurrently modified by Main Thread (AddRack, RemoveRack)
     {
         REAudioEngine::MutexLocker lock_the_racks(_mtx);
 
+        std::chrono::duration<double> lockWait = std::chrono::steady_clock::now() - callbackStart;
+        counters.lockWait = lockWait.count();
+
         // Give Instant Midi packets to monitoring device
         while (_instantMidiPacketBuffer.PacketAvailable()) {
             REMidiInstantPacket packet = _instantMidiPacketBuffer.Pop();
@@ -168,16 +180,22 @@ int RERtAudioEngine::RenderCallback( void *outputBuffer, void *inputBuffer, unsi
             remainingFrames -= framesToRender;
         }
 
+        _CollectRackCounters(&counters);
     }
     // ~CRITICAL
 
+    std::chrono::duration<double> callbackTime = std::chrono::steady_clock::now() - callbackStart;
+    _stats.RecordCallback(nBufferFrames, _sampleRate, callbackTime.count(), counters);
+
     // Dump
     _dumpFrameCounter += nBufferFrames;
     if(_dumpFrameCounter >= _sampleRate)
     {
         _dumpFrameCounter %= (unsigned long)_sampleRate;
-        REPrintf("Rendering %d frames @%1.2fHz (timestamp: %1.2f frames)\n",
-                 (int)nBufferFrames, (float)_sampleRate, (float)streamTime);
+        REAudioEngineStats::Report report = _stats.Snapshot();
+        REPrintf("Rendering %d frames @%1.2fHz (timestamp: %1.2f frames, load: %1.1f%% avg %1.1f%% max, xruns: %d)\n",
+                 (int)nBufferFrames, (float)_sampleRate, (float)streamTime,
+                 100.0f * (float)report.averageLoad, 100.0f * (float)report.maxLoad, (int)report.xruns);
     }
     return 0;
 }
@@ -5,3 +5,15 @@ REScoreSceneView::REScoreSceneView(REScoreScene* scene, QWidget *parent)
     : QGraphicsView(scene, parent)
 {
 }
+
+void REScoreSceneView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    emit VisibleRectChanged();
+}
+
+void REScoreSceneView::resizeEvent(QResizeEvent* event)
+{
+    QGraphicsView::resizeEvent(event);
+    emit VisibleRectChanged();
+}
@@ -12,9 +12,13 @@ public:
     explicit REScoreSceneView(REScoreScene* scene, QWidget *parent = 0);
     
 signals:
+    void VisibleRectChanged();
     
 public slots:
     
+protected:
+    virtual void scrollContentsBy(int dx, int dy);
+    virtual void resizeEvent(QResizeEvent* event);
 };
 
 #endif // RESCORESCENEVIEW_H
@@ -96,10 +96,12 @@ void RESequencerWidget::RefreshDisplay()
 
 void RESequencerWidget::Refresh()
 {
-    REDocumentView* v = _documentView;
+    // Keep the navigator scene attached so its track strips are only updated where the song changed
+    _navigatorHeader->SetDocumentView(_documentView);
+    _navigatorScene->Refresh();
+    _mixerWidget->Refresh();
 
-    DisconnectFromDocument();
-    ConnectToDocument(v);
+    updateLayout();
 }
 
 void RESequencerWidget::ConnectToDocument(REDocumentView* doc)
@@ -126,5 +126,9 @@ int main(int argc, char *argv[])
 
     QObject::connect(&splash, SIGNAL(accepted()), &w, SLOT(CheckUpdatesInBackground()));
 
-    return a.exec();
+    int result = a.exec();
+
+    // Join the SoundFont loader before static objects go away
+    RESoundFontManager::Instance().Shutdown();
+    return result;
 }